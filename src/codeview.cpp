@@ -10,6 +10,7 @@
 
 #include "codeview.h"
 
+#include "config.h"
 #include "core.h"
 #include "log.h"
 #include "syntaxhighlighter.h"
@@ -24,6 +25,8 @@
 CodeView::CodeView()
   : m_highlighter(0)
   , m_cfg(0)
+  , m_codeType(CODE_CXX)
+  , m_lazyHighlighter(this)
   , m_infoWindow(&m_font)
 {
   m_font = QFont("Monospace", 8);
@@ -38,12 +41,15 @@ CodeView::CodeView()
 
   m_incSearchStartPosRow = -1;
   m_incSearchStartPosColumn = 0;
+
+  m_lazyHighlighter.start();
 }
 
 CodeView::~CodeView()
 {
   delete m_fontInfo;
   delete m_highlighter;
+  clearBlocks();
 }
 
 /**
@@ -85,91 +91,150 @@ void CodeView::onTimerTimeout()
   }
 
   // Hover mouse over a text row?
-  TextField* foundField = NULL;
+  QString foundText;
   int rowHeight = getRowHeight();
   int rowIdx = mousePos.y() / rowHeight;
-  if (rowIdx >= 0 && rowIdx < (int) m_highlighter->getRowCount())
+  if (rowIdx >= 0 && rowIdx < m_lineStarts.size())
   {
     // Get the words in the line
-    QVector<TextField*> cols = m_highlighter->getRow(rowIdx);
+    TextRow row = getRow(rowIdx);
 
-    // Find the word under the cursor
+    // Find the word under the cursor (the text refers to the highlighter to avoid a copy of each field)
     int x = getBorderWidth() + 10;
     int foundPos = -1;
     int j;
-    for (j = 0; j < cols.size() && foundPos == -1; j++)
+    QString text;
+    for (j = 0; j < row.getFieldCount() && foundPos == -1; j++)
     {
-      TextField* field = cols[j];
-      int w = m_fontInfo->width(field->m_text);
+      text.setRawData(row.getText(j).unicode(), row.getLength(j));
+      int w = m_fontInfo->width(text);
       if (x <= mousePos.x() && mousePos.x() <= x + w)
       {
-        foundField = field;
+        // Skip if it is not a variable
+        if (row.getType(j) == TextRun::WORD && isLegalExpression(text))
+          foundText = row.getText(j).toString();
         foundPos = j;
       }
       x += w;
     }
   }
 
-  // Skip if it is not a variable
-  if (foundField)
-  {
-    if (foundField->m_type != TextField::WORD)
-      foundField = NULL;
-    else
-    {
-      QString text = foundField->m_text;
-      if (text.isEmpty())
-        foundField = NULL;
-      // Variable?
-      else if (!isLegalExpression(text))
-      {
-        foundField = NULL;
-      }
-    }
-  }
-  if (foundField)
+  if (!foundText.isEmpty())
   {
     setFocus();
     int windowY = mousePos.y() - (mousePos.y() % rowHeight) + rowHeight;
     QPoint menuPos = mapToGlobal(QPoint(mousePos.x() + 15, windowY));
     m_infoWindow.move(menuPos);
 
-    m_infoWindow.show(foundField->m_text);
+    m_infoWindow.show(foundText);
   }
   else
     m_infoWindow.hide();
 }
 
+/**
+ * @brief Creates a highlighter for a language.
+ */
+SyntaxHighlighter* CodeView::createHighlighter(CodeType type)
+{
+  if (type == CODE_BASIC)
+    return new SyntaxHighlighterBasic();
+  else if (type == CODE_FORTRAN)
+    return new SyntaxHighlighterFortran();
+  else if (type == CODE_RUST)
+    return new SyntaxHighlighterRust();
+  else if (type == CODE_ADA)
+    return new SyntaxHighlighterAda();
+  else if (type == CODE_GOLANG)
+    return new SyntaxHighlighterGo();
+  return new SyntaxHighlighterCxx();
+}
+
+/**
+ * @brief Shows a new text.
+ * The rows are shown as plain text until they have been colorized by the background thread.
+ */
 void CodeView::setPlainText(QString text, CodeType type)
 {
   text.replace("\r", "");
 
   m_text = text;
+  m_codeType = type;
 
   delete m_highlighter;
-  if (type == CODE_BASIC)
-    m_highlighter = new SyntaxHighlighterBasic();
-  else if (type == CODE_FORTRAN)
-    m_highlighter = new SyntaxHighlighterFortran();
-  else if (type == CODE_RUST)
-    m_highlighter = new SyntaxHighlighterRust();
-  else if (type == CODE_ADA)
-    m_highlighter = new SyntaxHighlighterAda();
-  else if (type == CODE_GOLANG)
-    m_highlighter = new SyntaxHighlighterGo();
-  else
-    m_highlighter = new SyntaxHighlighterCxx();
-  m_highlighter->setConfig(m_cfg);
+  m_highlighter = createHighlighter(type);
 
-  m_highlighter->colorize(text);
+  m_lineStarts.clear();
+  m_lineStarts.append(0);
+  for (int i = 0; i < text.size(); i++)
+  {
+    if (text[i] == '\n')
+      m_lineStarts.append(i + 1);
+  }
 
-  //    m_rows = text.split("\n");
+  clearBlocks();
+  m_blocks.fill(NULL, (m_lineStarts.size() + HIGHLIGHT_BLOCK_SIZE - 1) / HIGHLIGHT_BLOCK_SIZE);
+  m_lazyHighlighter.setText(m_text, m_lineStarts, m_codeType);
 
-  setMinimumSize(4000, getRowHeight() * m_highlighter->getRowCount());
+  setMinimumSize(4000, getRowHeight() * m_lineStarts.size());
 
   update();
 }
 
+/**
+ * @brief Deletes all colorized blocks.
+ */
+void CodeView::clearBlocks()
+{
+  for (int i = 0; i < m_blocks.size(); i++)
+    delete m_blocks[i];
+  m_blocks.clear();
+}
+
+/**
+ * @brief Installs the blocks colorized by the background thread.
+ */
+void CodeView::onHighlightDone()
+{
+  QList<HighlightedBlock> blockList;
+  m_lazyHighlighter.takeResults(&blockList);
+
+  for (int i = 0; i < blockList.size(); i++)
+  {
+    HighlightedBlock& block = blockList[i];
+    if (block.m_blockIdx >= m_blocks.size())
+    {
+      delete block.m_highlighter;
+      continue;
+    }
+
+    delete m_blocks[block.m_blockIdx];
+    m_blocks[block.m_blockIdx] = block.m_highlighter;
+  }
+
+  if (!blockList.isEmpty())
+    update();
+}
+
+/**
+ * @brief Returns the words in a row.
+ * A row that has not been colorized yet is returned as a single field with the plain text.
+ */
+TextRow CodeView::getRow(int rowIdx)
+{
+  SyntaxHighlighter* block = m_blocks[rowIdx / HIGHLIGHT_BLOCK_SIZE];
+  if (block)
+    return block->getRow(rowIdx % HIGHLIGHT_BLOCK_SIZE);
+
+  int startPos = m_lineStarts[rowIdx];
+  int endPos = rowIdx + 1 < m_lineStarts.size() ? m_lineStarts[rowIdx + 1] - 1 : m_text.size();
+  m_plainText = m_text.mid(startPos, endPos - startPos);
+  m_plainRun.m_start = 0;
+  m_plainRun.m_length = m_plainText.size();
+  m_plainRun.m_type = TextRun::PLAIN;
+  return TextRow(&m_plainText, &m_plainRun, 1);
+}
+
 /**
  * @brief Returns the height of a text row in pixels.
  */
@@ -213,9 +278,10 @@ void CodeView::paintEvent(QPaintEvent* event)
 
   // Draw content
   painter.setFont(m_font);
-  int maxLineDigits = QString::number(m_highlighter->getRowCount()).length();
+  int maxLineDigits = QString::number(m_lineStarts.size()).length();
   int startRowIdx = std::max(0, (paintRect.top() / rowHeight) - 1);
-  size_t endRowIdx = (size_t) std::min((int) m_highlighter->getRowCount(), (int) (paintRect.bottom() / rowHeight) + 1);
+  size_t endRowIdx = (size_t) std::min(m_lineStarts.size(), (int) (paintRect.bottom() / rowHeight) + 1);
+  m_lazyHighlighter.setVisibleRows(startRowIdx, (int) endRowIdx);
   for (size_t rowIdx = startRowIdx; rowIdx < endRowIdx; rowIdx++)
   {
     // int x = BORDER_WIDTH+10;
@@ -250,34 +316,30 @@ void CodeView::paintEvent(QPaintEvent* event)
     }
 
     // Draw line text
-    QVector<TextField*> cols = m_highlighter->getRow(rowIdx);
+    TextRow row = getRow(rowIdx);
 
     int x = getBorderWidth() + 10;
 
     // Draw search selection
     if (m_incSearchStartPosRow == (int) rowIdx)
     {
-      QString fullRowText;
-      for (int j = 0; j < cols.size(); j++)
-      {
-        TextField* field = cols[j];
-        fullRowText += field->m_text;
-      }
+      QString fullRowText = row.getText();
       int selPosX = x + m_fontInfo->width(fullRowText.left(m_incSearchStartPosColumn));
       int selPosWidth = m_fontInfo->width(fullRowText.mid(m_incSearchStartPosColumn, m_incSearchText.length()));
       QRect rect2(selPosX, y, selPosWidth, rowHeight);
       painter.fillRect(rect2, m_cfg->m_clrSelection);
     }
 
-    // Draw text
-    for (int j = 0; j < cols.size(); j++)
+    // Draw text (the text refers to the highlighter to avoid a copy of each field)
+    QString text;
+    for (int j = 0; j < row.getFieldCount(); j++)
     {
-      TextField* field = cols[j];
+      text.setRawData(row.getText(j).unicode(), row.getLength(j));
 
-      painter.setPen(field->m_color);
-      painter.drawText(x, fontY, field->m_text);
+      painter.setPen(m_palette[row.getType(j)]);
+      painter.drawText(x, fontY, text);
 
-      x += m_fontInfo->width(field->m_text);
+      x += m_fontInfo->width(text);
     }
   }
 }
@@ -324,18 +386,17 @@ void CodeView::mousePressEvent(QMouseEvent* event)
     int rowHeight = getRowHeight();
     int rowIdx = event->pos().y() / rowHeight;
     int lineNo = rowIdx + 1;
-    if (rowIdx >= 0 && rowIdx < (int) m_highlighter->getRowCount())
+    if (rowIdx >= 0 && rowIdx < m_lineStarts.size())
     {
       // Get the words in the line
-      QVector<TextField*> cols = m_highlighter->getRow(rowIdx);
+      TextRow row = getRow(rowIdx);
 
       // Find the word under the cursor
       int x = getBorderWidth() + 10;
       int foundPos = -1;
-      for (j = 0; j < cols.size() && foundPos == -1; j++)
+      for (j = 0; j < row.getFieldCount() && foundPos == -1; j++)
       {
-        TextField* field = cols[j];
-        int w = m_fontInfo->width(field->m_text);
+        int w = m_fontInfo->width(row.getText(j).toString());
         if (x <= event->pos().x() && event->pos().x() <= x + w)
         {
           foundPos = j;
@@ -349,7 +410,7 @@ void CodeView::mousePressEvent(QMouseEvent* event)
 
         while (foundPos >= 0)
         {
-          if (cols[foundPos]->isSpaces() || m_highlighter->isKeyword(cols[foundPos]->m_text) || m_highlighter->isSpecialChar(cols[foundPos]))
+          if (row.isSpaces(foundPos) || m_highlighter->isKeyword(row.getText(foundPos).toString()) || m_highlighter->isSpecialField(row.getText(foundPos).toString()))
           {
             foundPos--;
           }
@@ -366,23 +427,23 @@ void CodeView::mousePressEvent(QMouseEvent* event)
       if (foundPos != -1)
       {
         // Found a include file?
-        if (cols[foundPos]->m_type == TextField::INC_STRING)
+        if (row.getType(foundPos) == TextRun::INC_STRING)
         {
-          incFile = cols[foundPos]->m_text.trimmed();
+          incFile = row.getText(foundPos).toString().trimmed();
           if (incFile.length() > 2)
             incFile = incFile.mid(1, incFile.length() - 2);
           else
             incFile = "";
         }
         // or a variable?
-        else if (cols[foundPos]->m_type == TextField::WORD)
+        else if (row.getType(foundPos) == TextRun::WORD)
         {
-          QStringList partList = cols[foundPos]->m_text.split('.');
+          QStringList partList = row.getText(foundPos).toString().split('.');
 
           // Remove the last word if it is a function
-          if (foundPos + 1 < cols.size())
+          if (foundPos + 1 < row.getFieldCount())
           {
-            if (cols[foundPos + 1]->m_text == "(" && partList.size() > 1)
+            if (row.getText(foundPos + 1) == "(" && partList.size() > 1)
               partList.removeLast();
           }
 
@@ -393,15 +454,15 @@ void CodeView::mousePressEvent(QMouseEvent* event)
           }
 
           // A '[...]' section to the right of the variable?
-          if (foundPos + 1 < cols.size())
+          if (foundPos + 1 < row.getFieldCount())
           {
-            if (cols[foundPos + 1]->m_text == "[")
+            if (row.getText(foundPos + 1) == "[")
             {
               // Add the entire '[...]' section to the variable name
               QString extraString = "[";
-              for (int j = foundPos + 2; foundPos < cols.size() && cols[j]->m_text != "]"; j++)
+              for (int j = foundPos + 2; j < row.getFieldCount() && row.getText(j) != "]"; j++)
               {
-                extraString += cols[j]->m_text;
+                extraString += row.getText(j);
               }
               extraString += ']';
               list += partList.join(".") + extraString;
@@ -474,16 +535,17 @@ void CodeView::setConfig(Settings* cfg)
 {
   m_cfg = cfg;
 
-  if (m_highlighter)
-  {
-
-    m_highlighter->setConfig(cfg);
-
-    m_highlighter->colorize(m_text);
-  }
-
   assert(cfg != NULL);
 
+  // The color of each type of text
+  m_palette.fill(cfg->m_clrForeground, TextRun::TYPE_COUNT);
+  m_palette[TextRun::COMMENT] = cfg->m_clrComment;
+  m_palette[TextRun::NUMBER] = cfg->m_clrNumber;
+  m_palette[TextRun::KEYWORD] = cfg->m_clrKeyword;
+  m_palette[TextRun::CPP_KEYWORD] = cfg->m_clrCppKeyword;
+  m_palette[TextRun::INC_STRING] = cfg->m_clrIncString;
+  m_palette[TextRun::STRING] = cfg->m_clrString;
+
   m_font = QFont(m_cfg->m_fontFamily, m_cfg->m_fontSize);
   delete m_fontInfo;
   m_fontInfo = new QFontMetrics(m_font);
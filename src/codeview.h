@@ -9,6 +9,7 @@
 #ifndef FILE__CODEVIEW_H
 #define FILE__CODEVIEW_H
 
+#include "lazyhighlighter.h"
 #include "settings.h"
 #include "syntaxhighlighterada.h"
 #include "syntaxhighlighterbasic.h"
@@ -50,6 +51,8 @@ public:
     CODE_ADA
   } CodeType;
 
+  static SyntaxHighlighter* createHighlighter(CodeType type);
+
   void setPlainText(QString content, CodeType type);
 
   void setConfig(Settings* cfg);
@@ -76,10 +79,15 @@ private:
   void idxToRowColumn(int idx, int* rowIdx, int* colIdx);
   int doIncSearch(QString pattern, int startPos, bool searchForward);
   void hideInfoWindow();
+  void clearBlocks();
+  TextRow getRow(int rowIdx);
 
 public slots:
   void onTimerTimeout();
 
+private slots:
+  void onHighlightDone();
+
 private:
   int getBorderWidth();
   void mouseReleaseEvent(QMouseEvent* event);
@@ -94,9 +102,16 @@ public:
   int m_cursorY;
   ICodeView* m_inf;
   QVector<int> m_breakpointList;
-  SyntaxHighlighter* m_highlighter;
+  SyntaxHighlighter* m_highlighter; //!< Only used to look up keywords (the rows are in m_blocks).
   Settings* m_cfg;
   QString m_text;
+  CodeType m_codeType;
+  QVector<int> m_lineStarts; //!< The index in m_text of the first character of each line.
+  QVector<SyntaxHighlighter*> m_blocks; //!< The colorized blocks of HIGHLIGHT_BLOCK_SIZE lines (NULL if not done yet).
+  LazyHighlighter m_lazyHighlighter;
+  QString m_plainText; //!< Used to show a row that has not been colorized yet.
+  TextRun m_plainRun;
+  QVector<QColor> m_palette; //!< The color of each type of text (see TextRun::Type).
   QTimer m_timer;
   VariableInfoWindow m_infoWindow;
 
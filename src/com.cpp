@@ -15,8 +15,12 @@
 
 #include <QByteArray>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QTime>
 #include <QDebug>
 #include <assert.h>
+#include <ctype.h>
+#include <string.h>
 
 const char* GdbCom::asyncClassToString(GdbComListener::AsyncClass ac)
 {
@@ -71,13 +75,6 @@ const char* GdbCom::asyncClassToString(GdbComListener::AsyncClass ac)
   return "?";
 }
 
-const char* Token::toString()
-{
-  strcpy(m_tmpBuff, (const char*) stringToCStr(m_text));
-
-  return m_tmpBuff;
-}
-
 const char* Token::typeToString(Type type)
 {
   const char* str = "?";
@@ -138,52 +135,455 @@ const char* Token::typeToString(Type type)
   return str;
 }
 
+/**
+ * @brief Maps the first character of a token to the type of the token (if it is a single character token).
+ */
+static const Token::Type* createKeyTokenTable()
+{
+  static Token::Type table[256];
+  for (int i = 0; i < 256; i++)
+    table[i] = Token::UNKNOWN;
+  table['='] = Token::KEY_EQUAL;
+  table['{'] = Token::KEY_LEFT_BRACE;
+  table['}'] = Token::KEY_RIGHT_BRACE;
+  table['['] = Token::KEY_LEFT_BAR;
+  table[']'] = Token::KEY_RIGHT_BAR;
+  table[','] = Token::KEY_COMMA;
+  table['^'] = Token::KEY_UP;
+  table['+'] = Token::KEY_PLUS;
+  table['~'] = Token::KEY_TILDE;
+  table['@'] = Token::KEY_SNABEL;
+  table['&'] = Token::KEY_AND;
+  table['*'] = Token::KEY_STAR;
+  return table;
+}
+static const Token::Type* g_keyTokenTypes = createKeyTokenTable();
+
 bool Resp::isResult()
 {
   return (m_type == RESULT) ? true : false;
 }
 
-GdbCom::GdbCom()
-  : m_listener(NULL)
-  , m_logFile(GDB_LOG_FILE)
-  , m_busy(0)
-  , m_enableLog(false)
+GdbReader::GdbReader()
+  : m_process(NULL)
+  , m_respRing(GDB_RESP_RING_SIZE)
+  , m_consumerWaiting(0)
+  , m_producerWaiting(0)
+  , m_quit(0)
+  , m_respReadyPending(0)
+  , m_running(0)
+  , m_enableLog(0)
+  , m_rowStart(0)
+  , m_scanPos(0)
+  , m_rowType(ROW_UNKNOWN)
+  , m_tokenIdx(0)
 {
-  /*
-      QByteArray array = m_process.readAllStandardOutput();
-      qDebug() << "--->>";
-      qDebug() << QString(array);
-      qDebug() << "---<<";
-  */
+  // The process is a child so that it is moved to the reader thread together with the reader
+  m_process = new QProcess(this);
 
-  connect(&m_process, SIGNAL(readyReadStandardError()), this, SLOT(onReadyReadStandardError()));
+  connect(m_process, SIGNAL(readyReadStandardError()), this, SLOT(onReadyReadStandardError()));
 
-  connect(&m_process, SIGNAL(readyReadStandardOutput()), this, SLOT(onReadyReadStandardOutput()));
+  connect(m_process, SIGNAL(readyReadStandardOutput()), this, SLOT(onReadyReadStandardOutput()));
 
-  connect(&m_process, SIGNAL(stateChanged(QProcess::ProcessState)), this, SLOT(onGdbStateChanged(QProcess::ProcessState)));
+  connect(m_process, SIGNAL(stateChanged(QProcess::ProcessState)), this, SLOT(onStateChanged(QProcess::ProcessState)));
 }
 
-GdbCom::~GdbCom()
+GdbReader::~GdbReader()
 {
-  disconnect(&m_process, SIGNAL(stateChanged(QProcess::ProcessState)), this, SLOT(onGdbStateChanged(QProcess::ProcessState)));
+  // Free the responses never taken
+  Resp* resp;
+  while (m_respRing.pop(&resp))
+    delete resp;
+}
 
-  // Send the command to gdb to exit cleanly
-  QString text = "-gdb-exit\n";
-  m_process.write((const char*) text.toLatin1());
+/**
+ * @brief Starts the GDB process (called in the reader thread).
+ * @return 0 on success.
+ */
+int GdbReader::start(QString commandLine, QString captureFilename)
+{
+  if (!captureFilename.isEmpty())
+  {
+    m_captureFile.setFileName(captureFilename);
+    if (m_captureFile.open(QIODevice::Truncate | QIODevice::WriteOnly))
+    {
+      infoMsg("Created %s", stringToCStr(captureFilename));
+      m_captureFile.write(GDB_CAPTURE_HEADER "\n");
+      m_captureTimer.start();
+    }
+    else
+      critMsg("Failed to create capture file %s", stringToCStr(captureFilename));
+  }
 
-  if (!m_process.waitForFinished(1000))
+  m_process->start(commandLine);
+  m_process->waitForStarted(6000);
+
+  if (m_process->state() == QProcess::NotRunning)
   {
-    m_process.terminate();
+    return 1;
+  }
+  m_running.storeRelease(1);
 
-    m_process.waitForFinished();
+  return 0;
+}
+
+/**
+ * @brief Writes data to the stdin of GDB (called in the reader thread).
+ */
+void GdbReader::write(QByteArray data)
+{
+  if (m_process)
+    m_process->write(data);
+}
+
+/**
+ * @brief Asks GDB to exit and waits for it (called in the reader thread).
+ */
+void GdbReader::stop()
+{
+  if (m_process == NULL)
+    return;
+
+  disconnect(m_process, SIGNAL(stateChanged(QProcess::ProcessState)), this, SLOT(onStateChanged(QProcess::ProcessState)));
+
+  if (m_process->state() != QProcess::NotRunning)
+  {
+    // Send the command to gdb to exit cleanly
+    m_process->write("-gdb-exit\n");
+
+    if (!m_process->waitForFinished(1000))
+    {
+      m_process->terminate();
+
+      m_process->waitForFinished();
+    }
   }
+  m_running.storeRelease(0);
+
+  if (m_captureFile.isOpen())
+    m_captureFile.close();
+
+  // Must be deleted in the thread that it lives in
+  delete m_process;
+  m_process = NULL;
+}
 
-  // Free tokens
-  while (!m_freeTokens.isEmpty())
+/**
+ * @brief Makes pushResp() drop the responses instead of waiting for a free slot (called by the consumer before it stops popping).
+ */
+void GdbReader::quit()
+{
+  m_quit.storeRelease(1);
+
+  QMutexLocker locker(&m_waitMutex);
+  m_respTaken.wakeAll();
+}
+
+/**
+ * @brief Hands over a parsed response to the consumer.
+ */
+void GdbReader::pushResp(Resp* resp)
+{
+  // Full? Then wait for the consumer to catch up.
+  if (!m_respRing.push(resp))
+  {
+    QMutexLocker locker(&m_waitMutex);
+    m_producerWaiting.fetchAndStoreOrdered(1);
+    while (!m_respRing.push(resp))
+    {
+      // Nobody will take it?
+      if (m_quit.loadAcquire())
+      {
+        m_producerWaiting.fetchAndStoreOrdered(0);
+        delete resp;
+        return;
+      }
+      m_respTaken.wait(&m_waitMutex);
+    }
+    m_producerWaiting.fetchAndStoreOrdered(0);
+  }
+
+  // The flag is read with an ordered read-modify-write so that it can not be read before
+  // the push is visible (otherwise a consumer that just found the ring empty could miss the wakeup)
+  if (m_consumerWaiting.fetchAndAddOrdered(0) != 0)
+  {
+    QMutexLocker locker(&m_waitMutex);
+    m_respAdded.wakeAll();
+  }
+}
+
+/**
+ * @brief Takes the oldest response parsed (called by the consumer).
+ * @param timeoutMs   Max time to wait for a response.
+ * @return false if no response was available.
+ */
+bool GdbReader::popResp(Resp** respPtr, int timeoutMs)
+{
+  // Empty? Then wait for the producer.
+  if (!m_respRing.pop(respPtr))
+  {
+    if (timeoutMs <= 0)
+      return false;
+
+    QMutexLocker locker(&m_waitMutex);
+    QElapsedTimer timer;
+    timer.start();
+    m_consumerWaiting.fetchAndStoreOrdered(1);
+    bool isFound = m_respRing.pop(respPtr);
+    while (!isFound && timer.elapsed() < timeoutMs)
+    {
+      m_respAdded.wait(&m_waitMutex, (unsigned long) (timeoutMs - timer.elapsed()));
+      isFound = m_respRing.pop(respPtr);
+    }
+    m_consumerWaiting.fetchAndStoreOrdered(0);
+    if (!isFound)
+      return false;
+  }
+
+  // Wake up the producer if it waits for a free slot (see pushResp())
+  if (m_producerWaiting.fetchAndAddOrdered(0) != 0)
+  {
+    QMutexLocker locker(&m_waitMutex);
+    m_respTaken.wakeAll();
+  }
+  return true;
+}
+
+/**
+ * @brief Tells that the consumer has seen the respReady() signal.
+ * The signal is not emitted again until this has been called.
+ */
+void GdbReader::ackRespReady()
+{
+  m_respReadyPending.storeRelease(0);
+}
+
+void GdbReader::onReadyReadStandardError()
+{
+  // Dump all stderr content
+  QByteArray stderrBuffer = m_process->readAllStandardError();
+  if (!stderrBuffer.isEmpty())
   {
-    Token* token = m_freeTokens.takeFirst();
-    delete token;
+    QString respString = QString(stderrBuffer);
+    QStringList respList = respString.split("\n");
+    for (int r = 0; r < respList.size(); r++)
+    {
+      QString row = respList[r];
+      if (!row.isEmpty())
+        debugMsg("GDB|E>%s", stringToCStr(row));
+    }
   }
+}
+
+void GdbReader::onStateChanged(QProcess::ProcessState newState)
+{
+  if (newState == QProcess::NotRunning)
+    m_running.storeRelease(0);
+
+  emit stateChanged(newState);
+}
+
+/**
+ * @brief Appends a chunk of output to the capture file.
+ * Each chunk is stored as a "<microseconds> <length>" row followed by the raw bytes.
+ */
+void GdbReader::writeCapture(const QByteArray& data)
+{
+  QByteArray header = QByteArray::number(m_captureTimer.nsecsElapsed() / 1000) + " " + QByteArray::number(data.size()) + "\n";
+  m_captureFile.write(header);
+  m_captureFile.write(data);
+  m_captureFile.flush();
+}
+
+/**
+ * @brief Loads the chunks of output stored in a capture file.
+ * @return 0 on success.
+ */
+int GdbReader::loadCapture(QString filename, QVector<QByteArray>* chunkList)
+{
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    errorMsg("Failed to open '%s'", stringToCStr(filename));
+    return -1;
+  }
+  if (file.readLine().trimmed() != GDB_CAPTURE_HEADER)
+  {
+    errorMsg("'%s' is not a capture file", stringToCStr(filename));
+    return -1;
+  }
+
+  while (!file.atEnd())
+  {
+    QList<QByteArray> fields = file.readLine().trimmed().split(' ');
+    bool ok = false;
+    int len = fields.size() == 2 ? fields[1].toInt(&ok) : 0;
+    if (!ok || len < 0)
+    {
+      errorMsg("Invalid chunk header in '%s'", stringToCStr(filename));
+      return -1;
+    }
+    QByteArray chunk = file.read(len);
+    if (chunk.size() != len)
+    {
+      errorMsg("Truncated chunk in '%s'", stringToCStr(filename));
+      return -1;
+    }
+    chunkList->append(chunk);
+  }
+  return 0;
+}
+
+void GdbReader::onReadyReadStandardOutput()
+{
+  QByteArray data = m_process->readAllStandardOutput();
+
+  if (m_captureFile.isOpen())
+    writeCapture(data);
+
+  feedOutput(data);
+}
+
+/**
+ * @brief Scans output received from GDB.
+ * Rows are tokenized as the characters arrive and the scanning is resumed at the
+ * next call, so a partial row is never scanned again and reading never blocks.
+ */
+void GdbReader::feedOutput(const QByteArray& data)
+{
+  m_inputBuffer += data;
+
+  int endIdx = m_inputBuffer.size();
+  while (m_scanPos < endIdx)
+  {
+    const char* data = m_inputBuffer.constData();
+
+    // Find out if it is a MI record (skip any command token prefix)
+    if (m_rowType == ROW_UNKNOWN)
+    {
+      int firstCharIdx = m_rowStart;
+      while (firstCharIdx < endIdx && isdigit((unsigned char) data[firstCharIdx]))
+        firstCharIdx++;
+      if (firstCharIdx == endIdx)
+        break;
+      char firstChar = data[firstCharIdx];
+      if (firstChar == '(' || firstChar == '^' || firstChar == '*' || firstChar == '+' || firstChar == '~' || firstChar == '@' || firstChar == '&' || firstChar == '=')
+        m_rowType = ROW_MI;
+      else
+        m_rowType = ROW_TARGET_OUTPUT;
+    }
+
+    // Newline received?
+    const char* newline = (const char*) memchr(data + m_scanPos, '\n', endIdx - m_scanPos);
+    int chunkEnd = newline ? (int) (newline - data) : endIdx;
+
+    if (m_rowType == ROW_MI)
+      m_lexer.feed(data, m_scanPos, chunkEnd, &m_tokens);
+    m_scanPos = chunkEnd;
+
+    if (newline)
+    {
+      parseRow(chunkEnd);
+
+      m_rowStart = m_scanPos = chunkEnd + 1;
+      m_rowType = ROW_UNKNOWN;
+    }
+  }
+
+  // Drop the rows parsed
+  if (m_rowStart > 0)
+  {
+    m_inputBuffer.remove(0, m_rowStart);
+    for (int i = 0; i < m_tokens.size(); i++)
+      m_tokens[i].m_offset -= m_rowStart;
+    m_lexer.shift(-m_rowStart);
+    m_scanPos -= m_rowStart;
+    m_rowStart = 0;
+  }
+
+  // Wake up the consumer (unless it has not yet handled the last wakeup)
+  if (m_respReadyPending.testAndSetOrdered(0, 1))
+    emit respReady();
+}
+
+/**
+ * @brief Parses a complete row and hands over the response.
+ * @param rowEnd   Index of the newline that ended the row.
+ */
+void GdbReader::parseRow(int rowEnd)
+{
+  const char* data = m_inputBuffer.constData();
+  int rowStart = m_rowStart;
+
+  if (rowEnd > rowStart && data[rowEnd - 1] == '\r')
+    rowEnd--;
+  if (rowEnd == rowStart)
+  {
+    m_lexer.reset();
+    m_tokens.clear();
+    return;
+  }
+
+  debugMsg("row:%s", stringToCStr(QString::fromUtf8(data + rowStart, rowEnd - rowStart)));
+
+  if (m_enableLog.loadAcquire())
+    emit rowReceived(QString::fromUtf8(data + rowStart, rowEnd - rowStart));
+
+  Resp* resp = NULL;
+  if (m_rowType == ROW_MI)
+  {
+    m_lexer.finish(rowEnd, &m_tokens);
+    m_tokenIdx = 0;
+
+    resp = parseOutput();
+
+    m_tokens.clear();
+    m_tokenIdx = 0;
+  }
+  else
+  {
+    resp = new Resp;
+    resp->setType(Resp::TARGET_STREAM_OUTPUT);
+    resp->setString(QString::fromUtf8(data + rowStart, rowEnd - rowStart));
+  }
+
+  if (resp)
+    pushResp(resp);
+}
+
+GdbCom::GdbCom()
+  : m_reader(NULL)
+  , m_lastToken(0)
+  , m_listener(NULL)
+  , m_logFile(GDB_LOG_FILE)
+  , m_busy(0)
+  , m_enableLog(false)
+{
+  qRegisterMetaType<QProcess::ProcessState>("QProcess::ProcessState");
+
+  m_reader = new GdbReader;
+  m_reader->moveToThread(&m_readerThread);
+
+  connect(m_reader, SIGNAL(respReady()), this, SLOT(onRespReady()));
+
+  connect(m_reader, SIGNAL(rowReceived(QString)), this, SLOT(onRowReceived(QString)));
+
+  connect(m_reader, SIGNAL(stateChanged(QProcess::ProcessState)), this, SLOT(onGdbStateChanged(QProcess::ProcessState)));
+
+  m_readerThread.start();
+}
+
+GdbCom::~GdbCom()
+{
+  disconnect(m_reader, SIGNAL(stateChanged(QProcess::ProcessState)), this, SLOT(onGdbStateChanged(QProcess::ProcessState)));
+
+  // The responses are no longer popped so the reader must not wait for a free slot in the ring
+  m_reader->quit();
+  QMetaObject::invokeMethod(m_reader, "stop", Qt::BlockingQueuedConnection);
+
+  m_readerThread.quit();
+  m_readerThread.wait();
+  delete m_reader;
 
   enableLog(false);
   if (m_enableLog)
@@ -207,187 +607,277 @@ GdbResult GdbCom::commandF(Tree* resultData, const char* cmdFmt, ...)
   return res;
 }
 
+int GdbCom::commandAsyncF(const char* cmdFmt, ...)
+{
+  va_list ap;
+  char buffer[1024];
+
+  va_start(ap, cmdFmt);
+  vsnprintf(buffer, sizeof(buffer), cmdFmt, ap);
+
+  int token = commandAsync(buffer);
+  va_end(ap);
+
+  return token;
+}
+
+MiLexer::MiLexer()
+{
+  reset();
+}
+
 /**
- * @brief Creates tokens from a single GDB output row.
+ * @brief Prepares for a new row.
  */
-QList<Token*> GdbCom::tokenize(QString str)
+void MiLexer::reset()
 {
-  enum
-  {
-    IDLE,
-    END_CODE,
-    STRING,
-    VAR
-  } state
-    = IDLE;
-  QList<Token*> list;
-  Token* cur = NULL;
-  bool prevCharIsEscCode = false;
+  m_state = IDLE;
+  m_tok.m_type = Token::UNKNOWN;
+  m_tok.m_offset = 0;
+  m_tok.m_length = 0;
+  m_isFirst = true;
+  m_varEnd = 0;
+}
 
-  if (str.isEmpty())
-    return list;
+void MiLexer::emitToken(Token::Type type, int length, QVector<MiToken>* list)
+{
+  m_tok.m_type = type;
+  m_tok.m_length = length;
+  list->append(m_tok);
+  m_isFirst = false;
+  m_state = IDLE;
+}
 
-  for (int i = 0; i < str.size(); i++)
+/**
+ * @brief Scans the next part of a row.
+ * @param data       The raw output received from GDB.
+ * @param startIdx   Index of the first character to scan (the character after the last one fed).
+ * @param endIdx     Index of the character after the last character to scan.
+ * @param list       The tokens completed are appended to this list.
+ */
+void MiLexer::feed(const char* data, int startIdx, int endIdx, QVector<MiToken>* list)
+{
+  static const char* codeEndStr = "(gdb)";
+  int i = startIdx;
+
+  while (i < endIdx)
   {
-    QChar c = str[i];
-    bool isEscaped = false;
-    if (c == '\\' && prevCharIsEscCode)
-    {
-      prevCharIsEscCode = false;
-    }
-    else if (prevCharIsEscCode)
-    {
-      isEscaped = true;
-      prevCharIsEscCode = false;
-    }
-    else if (c == '\\')
-    {
-      prevCharIsEscCode = true;
-      continue;
-    }
+    char c = data[i];
 
-    switch (state)
+    switch (m_state)
     {
     case IDLE:
     {
-      if (c == '"')
+      m_tok.m_offset = i;
+      if (c == ' ' || c == '\r')
       {
-        cur = new Token(Token::C_STRING);
-        list.push_back(cur);
-        state = STRING;
+        i++;
       }
-      else if (c == '(')
+      else if (c == '"')
       {
-        cur = new Token(Token::END_CODE);
-        list.push_back(cur);
-        cur->m_text += c;
-        state = END_CODE;
+        m_tok.m_offset = ++i;
+        m_state = IN_STRING;
       }
-      else if (c == '=' || c == '{' || c == '}' || c == ',' || c == '[' || c == ']' || c == '+' || c == '^' || c == '~' || c == '@' || c == '&' || c == '*')
+      else if (c == '(')
       {
-        Token::Type type = Token::UNKNOWN;
-        if (c == '=')
-          type = Token::KEY_EQUAL;
-        if (c == '{')
-          type = Token::KEY_LEFT_BRACE;
-        if (c == '}')
-          type = Token::KEY_RIGHT_BRACE;
-        if (c == '[')
-          type = Token::KEY_LEFT_BAR;
-        if (c == ']')
-          type = Token::KEY_RIGHT_BAR;
-        if (c == ',')
-          type = Token::KEY_COMMA;
-        if (c == '^')
-          type = Token::KEY_UP;
-        if (c == '+')
-          type = Token::KEY_PLUS;
-        if (c == '~')
-          type = Token::KEY_TILDE;
-        if (c == '@')
-          type = Token::KEY_SNABEL;
-        if (c == '&')
-          type = Token::KEY_AND;
-        if (c == '*')
-          type = Token::KEY_STAR;
-        cur = new Token(type);
-        list.push_back(cur);
-        cur->m_text += c;
-        state = IDLE;
+        m_tok.m_length = 1;
+        m_state = IN_PAREN;
+        i++;
       }
-      else if (c != ' ')
+      else if (g_keyTokenTypes[(unsigned char) c] != Token::UNKNOWN)
       {
-        cur = new Token(Token::VAR);
-        list.push_back(cur);
-        cur->m_text = c;
-        state = VAR;
+        emitToken(g_keyTokenTypes[(unsigned char) c], 1, list);
+        i++;
       }
-    };
-    break;
-    case END_CODE:
-    {
-      QString codeEndStr = "(gdb)";
-      cur->m_text += c;
-
-      if (cur->m_text.length() == codeEndStr.length())
+      else if (m_isFirst && '0' <= c && c <= '9')
       {
-        state = IDLE;
+        m_state = IN_NUMBER;
+        i++;
       }
-      else if (cur->m_text.compare(codeEndStr.left(cur->m_text.length())) != 0)
+      else
       {
-        cur->setType(Token::VAR);
-        state = IDLE;
+        m_varEnd = i;
+        m_state = IN_VAR;
       }
     };
     break;
-    case STRING:
+    case IN_STRING:
     {
-      if (c == '"' && isEscaped == false)
+      // Find the end of the string (but don't unescape it)
+      const char* strEnd = data + i;
+      while (strEnd < data + endIdx && *strEnd != '"' && *strEnd != '\\')
+        strEnd++;
+      i = strEnd - data;
+      if (i < endIdx)
       {
-        state = IDLE;
-      }
-      else if (isEscaped)
-      {
-        if (c == 'n')
-          cur->m_text += '\n';
-        else if (c == 't')
-          cur->m_text += '\t';
+        if (*strEnd == '"')
+          emitToken(Token::C_STRING, i - m_tok.m_offset, list);
         else
-          cur->m_text += c;
+          m_state = IN_STRING_ESCAPE;
+        i++;
       }
+    };
+    break;
+    case IN_STRING_ESCAPE:
+    {
+      m_state = IN_STRING;
+      i++;
+    };
+    break;
+    case IN_NUMBER:
+    {
+      if ('0' <= c && c <= '9')
+        i++;
       else
-        cur->m_text += c;
+        emitToken(Token::VAR, i - m_tok.m_offset, list);
     };
     break;
-    case VAR:
+    case IN_PAREN:
+    {
+      int len = m_tok.m_length;
+      i++;
+      if (c != codeEndStr[len])
+        emitToken(Token::VAR, len + 1, list);
+      else if (len + 1 == 5)
+        emitToken(Token::END_CODE, 5, list);
+      else
+        m_tok.m_length = len + 1;
+    };
+    break;
+    case IN_VAR:
     {
       if (c == '=' || c == ',' || c == '{' || c == '}')
+        emitToken(Token::VAR, m_varEnd - m_tok.m_offset, list);
+      else
       {
-        i--;
-        cur->m_text = cur->m_text.trimmed();
-        state = IDLE;
+        i++;
+        if (!isspace((unsigned char) c))
+          m_varEnd = i;
       }
-      else
-        cur->m_text += c;
     };
     break;
     }
   }
-  if (cur)
+}
+
+/**
+ * @brief Completes the last token of the row.
+ * @param endIdx   Index of the character after the last character in the row.
+ */
+void MiLexer::finish(int endIdx, QVector<MiToken>* list)
+{
+  if (m_state == IN_STRING || m_state == IN_STRING_ESCAPE)
+    emitToken(Token::C_STRING, endIdx - m_tok.m_offset, list);
+  else if (m_state == IN_NUMBER)
+    emitToken(Token::VAR, endIdx - m_tok.m_offset, list);
+  else if (m_state == IN_PAREN)
+    emitToken(Token::VAR, m_tok.m_length, list);
+  else if (m_state == IN_VAR)
+    emitToken(Token::VAR, m_varEnd - m_tok.m_offset, list);
+  reset();
+}
+
+/**
+ * @brief Adjusts the position of the token being scanned after the input buffer has been moved.
+ */
+void MiLexer::shift(int delta)
+{
+  m_tok.m_offset += delta;
+  m_varEnd += delta;
+}
+
+/**
+ * @brief Creates tokens from GDB output rows.
+ * @param buffer     The raw output received from GDB.
+ * @param startIdx   Index of the first character to tokenize.
+ * @param endIdx     Index of the character after the last character to tokenize.
+ * @param list       The tokens found are appended to this list.
+ */
+void GdbReader::tokenize(const QByteArray& buffer, int startIdx, int endIdx, QVector<MiToken>* list)
+{
+  MiLexer lexer;
+  lexer.feed(buffer.constData(), startIdx, endIdx, list);
+  lexer.finish(endIdx, list);
+}
+
+/**
+ * @brief Returns the raw bytes of a token (C strings are unescaped).
+ * Unless the token had to be unescaped the returned array refers directly to the input buffer
+ * and is only valid until more data is read from GDB.
+ */
+QByteArray GdbReader::getTokenBytes(const MiToken* tok) const
+{
+  const char* text = m_inputBuffer.constData() + tok->m_offset;
+
+  if (tok->getType() != Token::C_STRING || memchr(text, '\\', tok->m_length) == NULL)
+    return QByteArray::fromRawData(text, tok->m_length);
+
+  QByteArray str;
+  str.reserve(tok->m_length);
+  for (int i = 0; i < tok->m_length; i++)
   {
-    if (cur->getType() == Token::VAR)
-      cur->m_text = cur->m_text.trimmed();
+    char c = text[i];
+    if (c == '\\' && i + 1 < tok->m_length)
+    {
+      c = text[++i];
+      if (c == 'n')
+        c = '\n';
+      else if (c == 't')
+        c = '\t';
+      else if (c == 'r')
+        c = '\r';
+      else if ('0' <= c && c <= '7')
+      {
+        // Octal code (Eg: "\303")
+        int val = 0;
+        int digitCount = 0;
+        for (; digitCount < 3 && i < tok->m_length && '0' <= text[i] && text[i] <= '7'; digitCount++)
+          val = val * 8 + (text[i++] - '0');
+        i--;
+        c = (char) val;
+      }
+    }
+    str += c;
   }
-  return list;
+  return str;
+}
+
+/**
+ * @brief Returns the text of a token (C strings are unescaped).
+ */
+QString GdbReader::getTokenString(const MiToken* tok) const
+{
+  return QString::fromUtf8(getTokenBytes(tok));
 }
 
-Token* GdbCom::pop_token()
+/**
+ * @brief Pops the next token.
+ * @return The token or NULL. The token is only valid until the next token is requested.
+ */
+const MiToken* GdbReader::pop_token()
 {
-  if (m_list.empty())
+  if (m_tokenIdx >= m_tokens.size())
     return NULL;
-  Token* tok = m_list.takeFirst();
-  m_freeTokens += tok;
-  // debugMsg(">%s", stringToCStr(tok->getString()));
+  const MiToken* tok = &m_tokens[m_tokenIdx++];
+  // debugMsg(">%s", stringToCStr(getTokenString(tok)));
   return tok;
 }
 
-Token* GdbCom::peek_token()
+const MiToken* GdbReader::peek_token()
 {
-  readTokens();
-
-  if (m_list.empty())
+  if (m_tokenIdx >= m_tokens.size())
     return NULL;
 
-  return m_list.first();
+  return &m_tokens[m_tokenIdx];
 }
 
 /**
  * @brief Parses 'ASYNC-OUTPUT'
  * @return 0 on success
  */
-int GdbCom::parseAsyncOutput(Resp* resp, GdbComListener::AsyncClass* ac)
+int GdbReader::parseAsyncOutput(Resp* resp, GdbComListener::AsyncClass* ac)
 {
-  Token* tokVar;
+  const MiToken* tokVar;
   int rc = 0;
 
   // Get the class
@@ -396,7 +886,7 @@ int GdbCom::parseAsyncOutput(Resp* resp, GdbComListener::AsyncClass* ac)
   {
     return -1;
   }
-  QString acString = tokVar->getString();
+  QString acString = getTokenString(tokVar);
 
   if (acString == "stopped")
   {
@@ -473,15 +963,10 @@ int GdbCom::parseAsyncOutput(Resp* resp, GdbComListener::AsyncClass* ac)
   return rc;
 }
 
-Resp* GdbCom::parseExecAsyncOutput()
+Resp* GdbReader::parseExecAsyncOutput()
 {
-  Token* tokVar;
   Resp* resp = NULL;
 
-  // Parse 'token'
-  tokVar = checkToken(Token::VAR);
-  if (tokVar) { }
-
   if (checkToken(Token::KEY_STAR) == NULL)
     return NULL;
 
@@ -493,14 +978,9 @@ Resp* GdbCom::parseExecAsyncOutput()
   return resp;
 }
 
-Resp* GdbCom::parseStatusAsyncOutput()
+Resp* GdbReader::parseStatusAsyncOutput()
 {
   Resp* resp = NULL;
-  Token* tokVar;
-
-  // Parse 'token'
-  tokVar = checkToken(Token::VAR);
-  if (tokVar) { }
 
   if (checkToken(Token::KEY_PLUS) == NULL)
     return NULL;
@@ -512,14 +992,9 @@ Resp* GdbCom::parseStatusAsyncOutput()
   return resp;
 }
 
-Resp* GdbCom::parseNotifyAsyncOutput()
+Resp* GdbReader::parseNotifyAsyncOutput()
 {
   Resp* resp = NULL;
-  Token* tokVar;
-
-  // Parse 'token'
-  tokVar = checkToken(Token::VAR);
-  if (tokVar) { }
 
   if (checkToken(Token::KEY_EQUAL) == NULL)
     return NULL;
@@ -531,7 +1006,7 @@ Resp* GdbCom::parseNotifyAsyncOutput()
   return resp;
 }
 
-Resp* GdbCom::parseAsyncRecord()
+Resp* GdbReader::parseAsyncRecord()
 {
   Resp* resp = NULL;
   if (isTokenPending() && resp == NULL)
@@ -543,17 +1018,17 @@ Resp* GdbCom::parseAsyncRecord()
   return resp;
 }
 
-Resp* GdbCom::parseStreamRecord()
+Resp* GdbReader::parseStreamRecord()
 {
   Resp* resp = NULL;
-  Token* tok;
+  const MiToken* tok;
   if (checkToken(Token::KEY_TILDE))
   {
     resp = new Resp;
     tok = eatToken(Token::C_STRING);
 
     resp->setType(Resp::CONSOLE_STREAM_OUTPUT);
-    resp->setString(tok->getString());
+    resp->setString(tok ? getTokenString(tok) : "");
   }
   else if (checkToken(Token::KEY_SNABEL))
   {
@@ -561,7 +1036,7 @@ Resp* GdbCom::parseStreamRecord()
     tok = eatToken(Token::C_STRING);
 
     resp->setType(Resp::TARGET_STREAM_OUTPUT);
-    resp->setString(tok->getString());
+    resp->setString(tok ? getTokenString(tok) : "");
   }
   else if (checkToken(Token::KEY_AND))
   {
@@ -569,24 +1044,18 @@ Resp* GdbCom::parseStreamRecord()
     tok = eatToken(Token::C_STRING);
 
     resp->setType(Resp::LOG_STREAM_OUTPUT);
-    resp->setString(tok->getString());
+    resp->setString(tok ? getTokenString(tok) : "");
   }
 
   return resp;
 }
 
-Token* GdbCom::eatToken(Token::Type type)
+const MiToken* GdbReader::eatToken(Token::Type type)
 {
-  Token* tok = peek_token();
-  while (tok == NULL)
-  {
-    m_process.waitForReadyRead(100);
-    readTokens();
-    tok = peek_token();
-  }
+  const MiToken* tok = peek_token();
   if (tok == NULL || tok->getType() != type)
   {
-    errorMsg("Expected '%s' but got '%s'", Token::typeToString(type), tok ? stringToCStr(tok->getString()) : "<NULL>");
+    errorMsg("Expected '%s' but got '%s'", Token::typeToString(type), tok ? stringToCStr(getTokenString(tok)) : "<NULL>");
     return NULL;
   }
   pop_token();
@@ -596,9 +1065,9 @@ Token* GdbCom::eatToken(Token::Type type)
 /**
  * @brief Checks if the read queue is empty.
  */
-bool GdbCom::isTokenPending()
+bool GdbReader::isTokenPending()
 {
-  Token* tok = peek_token();
+  const MiToken* tok = peek_token();
   if (tok == NULL)
   {
     return false;
@@ -611,11 +1080,9 @@ bool GdbCom::isTokenPending()
  * @brief Checks and pops a token if the kind is as expected.
  * @return The found token or NULL if no hit.
  */
-Token* GdbCom::checkToken(Token::Type type)
+const MiToken* GdbReader::checkToken(Token::Type type)
 {
-  Token* tok = peek_token();
-  if (tok == NULL)
-    readTokens();
+  const MiToken* tok = peek_token();
   if (tok == NULL || tok->getType() != type)
   {
     return NULL;
@@ -629,17 +1096,23 @@ Token* GdbCom::checkToken(Token::Type type)
  * @param item   The tree item to put the result of the parse in.
  * @return 0 on success.
  */
-int GdbCom::parseValue(TreeNode* item)
+int GdbReader::parseValue(TreeNode* item)
 {
-  Token* tok;
+  const MiToken* tok;
   int rc = 0;
 
   tok = pop_token();
+  if (tok == NULL)
+  {
+    errorMsg("Unexpected end of row");
+    return -1;
+  }
 
   // Const?
   if (tok->getType() == Token::C_STRING)
   {
-    item->setData(tok->getString());
+    QByteArray data = getTokenBytes(tok);
+    item->setData(data.constData(), data.size());
   }
   // Tuple?
   else if (tok->getType() == Token::KEY_LEFT_BRACE)
@@ -661,7 +1134,7 @@ int GdbCom::parseValue(TreeNode* item)
     }
 
     tok = peek_token();
-    if (tok->getType() == Token::VAR)
+    if (tok != NULL && tok->getType() == Token::VAR)
     {
       do
       {
@@ -673,13 +1146,10 @@ int GdbCom::parseValue(TreeNode* item)
     else
     {
       int idx = 1;
-      QString name;
 
       do
       {
-        name.sprintf("%d", idx++);
-        TreeNode* node = new TreeNode(name);
-        item->addChild(node);
+        TreeNode* node = item->addChild(TreeAtomTable::internIndex(idx++));
         rc = parseValue(node);
       } while (checkToken(Token::KEY_COMMA) != NULL);
     }
@@ -688,7 +1158,7 @@ int GdbCom::parseValue(TreeNode* item)
       return -1;
   }
   else
-    errorMsg("Unexpected token: '%s'", stringToCStr(tok->getString()));
+    errorMsg("Unexpected token: '%s'", stringToCStr(getTokenString(tok)));
   return rc;
 }
 
@@ -696,54 +1166,51 @@ int GdbCom::parseValue(TreeNode* item)
  * @brief Parses 'RESULT'
  * @return 0 on success.
  */
-int GdbCom::parseResult(TreeNode* parent)
+int GdbReader::parseResult(TreeNode* parent)
 {
-  QString name;
+  int nameAtom;
 
-  Token* tok = peek_token();
-  if (tok != NULL && tok->getType() == Token::KEY_LEFT_BRACE) { }
+  const MiToken* tok = peek_token();
+  if (tok != NULL && tok->getType() == Token::KEY_LEFT_BRACE)
+  {
+    nameAtom = TreeAtomTable::intern("", 0);
+  }
   else
   {
     //
-    Token* tokVar = eatToken(Token::VAR);
+    const MiToken* tokVar = eatToken(Token::VAR);
     if (tokVar == NULL)
       return -1;
-    name = tokVar->getString();
+    nameAtom = TreeAtomTable::intern(m_inputBuffer.constData() + tokVar->m_offset, tokVar->m_length);
 
     //
     if (eatToken(Token::KEY_EQUAL) == NULL)
       return -1;
   }
 
-  TreeNode* item = new TreeNode(name);
-  parent->addChild(item);
+  TreeNode* item = parent->addChild(nameAtom);
 
   parseValue(item);
 
   return 0;
 }
 
-Resp* GdbCom::parseResultRecord()
+Resp* GdbReader::parseResultRecord()
 {
-  Token* tokVar;
   Resp* resp = NULL;
   int rc = 0;
 
-  // Parse 'token'
-  tokVar = checkToken(Token::VAR);
-  if (tokVar) { }
-
   // Parse '^'
   if (checkToken(Token::KEY_UP) == NULL)
     return NULL;
 
   // Parse 'result class'
-  Token* tok = eatToken(Token::VAR);
+  const MiToken* tok = eatToken(Token::VAR);
   if (tok == NULL)
     return NULL;
 
   resp = new Resp;
-  QString resultClass = tok->getString();
+  QString resultClass = getTokenString(tok);
   GdbResult res;
   if (resultClass == "done")
     res = GDB_DONE;
@@ -768,19 +1235,12 @@ Resp* GdbCom::parseResultRecord()
     rc = parseResult(resp->tree.getRoot());
   }
 
-  if (!m_pending.isEmpty())
-  {
-    PendingCommand cmd = m_pending.takeFirst();
-
-    debugMsg("%s done", stringToCStr(cmd.m_cmdText));
-  }
-
   resp->setType(Resp::RESULT);
 
   return resp;
 }
 
-Resp* GdbCom::parseOutOfBandRecord()
+Resp* GdbReader::parseOutOfBandRecord()
 {
   Resp* resp = NULL;
 
@@ -792,9 +1252,15 @@ Resp* GdbCom::parseOutOfBandRecord()
   return resp;
 }
 
-Resp* GdbCom::parseOutput()
+Resp* GdbReader::parseOutput()
 {
   Resp* resp = NULL;
+  int token = -1;
+
+  // Parse 'token'
+  const MiToken* tokVar = checkToken(Token::VAR);
+  if (tokVar)
+    token = getTokenString(tokVar).toInt();
 
   if (isTokenPending())
     resp = parseOutOfBandRecord();
@@ -805,17 +1271,20 @@ Resp* GdbCom::parseOutput()
   if (isTokenPending() && resp == NULL)
   {
     resp = new Resp;
-    Token* token = checkToken(Token::END_CODE);
+    const MiToken* token = checkToken(Token::END_CODE);
     if (token)
     {
       resp->setType(Resp::TERMINATION);
     }
   }
 
+  if (resp)
+    resp->m_token = token;
+
   /*
       token = peek_token();
       if(token)
-          errorMsg("Unexpected token '%s'", stringToCStr(token->getString()));
+          errorMsg("Unexpected token '%s'", stringToCStr(getTokenString(token)));
   */
   return resp;
 }
@@ -824,13 +1293,7 @@ void GdbCom::writeLogEntry(QString logText)
 {
   assert(m_enableLog == true);
 
-  // TODO: mundak
-  // struct timeval tv;
-  // gettimeofday(&tv, NULL);
-  // QString timeStr;
-  // timeStr.sprintf("%02d.%03d", (int)(tv.tv_sec%100), (int)(tv.tv_usec/1000));
-  Q_ASSERT(false);
-  QString timeStr = "";
+  QString timeStr = QTime::currentTime().toString("ss.zzz");
 
   QString fullText = timeStr + "|" + logText;
 
@@ -839,171 +1302,114 @@ void GdbCom::writeLogEntry(QString logText)
 }
 
 /**
- * @brief Reads output from GDB.
- */
-void GdbCom::readTokens()
-{
-  m_inputBuffer += m_process.readAllStandardOutput();
-
-  // Any characters received?
-  while (m_inputBuffer.size() > 0)
-  {
-    // Newline received?
-    int subLen = m_inputBuffer.indexOf('\n');
-    if (subLen != -1)
-    {
-      QString row = QString(m_inputBuffer.left(subLen));
-      m_inputBuffer = m_inputBuffer.mid(subLen + 1);
-
-      if (!row.isEmpty())
-      {
-        debugMsg("row:%s", stringToCStr(row));
-
-        if (m_enableLog)
-        {
-          QString logText;
-          logText = ">> ";
-          logText += row;
-          logText += "\n";
-          writeLogEntry(logText);
-        }
-
-        QList<Token*> list;
-        char firstChar = row[0].toLatin1();
-        if (firstChar == '(' || firstChar == '^' || firstChar == '*' || firstChar == '+' || firstChar == '~' || firstChar == '@' || firstChar == '&' || firstChar == '=')
-        {
-          list = tokenize(row);
-          m_list += list;
-        }
-        else if (m_listener)
-        {
-          m_listener->onTargetStreamOutput(row);
-        }
-      }
-    }
-
-    // Half a line received?
-    if (m_inputBuffer.isEmpty() == false)
-    {
-      int timeout = 20;
-      // Wait for the complete line to be received
-      while (m_inputBuffer.indexOf('\n') == -1)
-      {
-        m_process.waitForReadyRead(100);
-        m_inputBuffer += m_process.readAllStandardOutput();
-        timeout--;
-        assert(timeout > 0);
-      }
-    }
-  }
-}
-
-/**
- * @brief Reads response from GDB
+ * @brief Takes one response parsed by the reader thread.
+ * @param respPtr     Set to the response read or NULL if none was available.
+ * @param timeoutMs   Max time to wait for a response.
  * @return 0 on success otherwise an errorcode.
  */
-int GdbCom::readFromGdb(GdbResult* m_result, Tree* m_resultData)
+int GdbCom::readFromGdb(Resp** respPtr, int timeoutMs)
 {
   int rc = 0;
-  // debugMsg("## '%s'",stringToCStr(row));
 
   Resp* resp = NULL;
-
-  if (m_result == NULL)
+  if (!m_reader->popResp(&resp, timeoutMs))
   {
-
-    // Parse any data received from GDB
-    resp = parseOutput();
-    if (resp == NULL)
-    {
-      if (!m_process.waitForReadyRead(100))
-      {
-        QProcess::ProcessState state = m_process.state();
-        if (state == QProcess::NotRunning)
-        {
-          rc = -1;
-        }
-      }
-    }
-
-    while (!m_freeTokens.isEmpty())
+    resp = NULL;
+    if (!m_reader->isRunning())
     {
-      Token* token = m_freeTokens.takeFirst();
-      delete token;
+      rc = -1;
     }
+  }
 
-    if (resp)
+  if (resp)
+  {
+    // Match the result with the command it belongs to
+    if (resp->getType() == Resp::RESULT && m_pending.contains(resp->m_token))
     {
-      m_respQueue.push_back(resp);
+      PendingCommand cmd = m_pending.take(resp->m_token);
 
-      if (resp->getType() == Resp::RESULT)
-      {
-        assert(m_resultData != NULL);
+      debugMsg("%s done", stringToCStr(cmd.m_cmdText));
 
-        m_resultData->copy(resp->tree);
-      }
+      resp->m_callback = cmd.m_callback;
     }
-  }
-  else
-  {
-    *m_result = GDB_DONE;
 
-    do
-    {
+    m_respQueue.push_back(resp);
+  }
 
-      // Parse any data received from GDB
-      do
-      {
-        resp = parseOutput();
-        if (resp == NULL)
-        {
-          if (!m_process.waitForReadyRead(100))
-          {
-            QProcess::ProcessState state = m_process.state();
-            if (state == QProcess::NotRunning)
-            {
-              assert(0);
-
-              rc = -1;
-            }
-          }
-        }
-      } while (resp == NULL && rc == 0);
-
-      while (!m_freeTokens.isEmpty())
-      {
-        Token* token = m_freeTokens.takeFirst();
-        delete token;
-      }
+  *respPtr = resp;
+  return rc;
+}
 
-      if (resp != NULL)
-        m_respQueue.push_back(resp);
+/**
+ * @brief Sends a command to GDB prefixed with a new token.
+ * @return The token assigned to the command.
+ */
+int GdbCom::writeCommand(QString text, GdbResultCallback callback)
+{
+  int token = ++m_lastToken;
 
-      if (resp != NULL && resp->getType() == Resp::RESULT)
-      {
-        assert(m_resultData != NULL);
+  debugMsg("# Cmd: %d'%s'", token, stringToCStr(text));
 
-        if (m_result)
-          *m_result = resp->m_result;
-        m_resultData->copy(resp->tree);
-      }
+  PendingCommand cmd;
+  cmd.m_token = token;
+  cmd.m_cmdText = text;
+  cmd.m_callback = callback;
+  m_pending[token] = cmd;
 
-    } while (m_result != NULL && resp != NULL && resp->getType() != Resp::TERMINATION);
+  // Send the command to gdb
+  text = QString::number(token) + text + "\n";
+  QByteArray wtext = text.toLatin1();
+  QMetaObject::invokeMethod(m_reader, "write", Qt::QueuedConnection, Q_ARG(QByteArray, wtext));
 
-    if (resp == NULL && m_result != NULL)
-      *m_result = GDB_ERROR;
+  if (m_enableLog)
+  {
+    //
+    QString logText;
+    writeLogEntry("\n");
+    logText = "<< ";
+    logText += text;
+    writeLogEntry(logText);
   }
 
-  //  debugMsg("# ---<< \n");
+  return token;
+}
 
-  // for(int i = 0;i < m_respQueue.size();i++)
+/**
+ * @brief Fails the commands that will never be answered (GDB has exited or a new session is started).
+ * The callbacks are called with GDB_ERROR and an empty result.
+ */
+void GdbCom::failPending()
+{
+  QMap<int, PendingCommand> pendingList;
+  pendingList.swap(m_pending);
+  for (QMap<int, PendingCommand>::iterator it = pendingList.begin(); it != pendingList.end(); ++it)
   {
-    //    debugMsg("%d > %s", i, stringToCStr(m_respQueue[i].getString()));
+    PendingCommand& cmd = it.value();
+
+    debugMsg("%s failed", stringToCStr(cmd.m_cmdText));
+
+    if (cmd.m_callback)
+    {
+      Tree resultData;
+      cmd.m_callback(GDB_ERROR, resultData);
+    }
   }
+}
 
-  return rc;
+/**
+ * @brief Sends a command to GDB without waiting for the result.
+ * @param callback   Called (if set) when the result of the command has been received.
+ * @return The token of the command.
+ */
+int GdbCom::commandAsync(QString text, GdbResultCallback callback)
+{
+  return writeCommand(text, callback);
 }
 
+/**
+ * @brief Sends a command to GDB and waits for the result.
+ * Responses to other (asynchronous) commands received meanwhile are dispatched afterwards.
+ */
 GdbResult GdbCom::command(Tree* resultData, QString text)
 {
   Tree resultDataNull;
@@ -1016,52 +1422,34 @@ GdbResult GdbCom::command(Tree* resultData, QString text)
   if (resultData == NULL)
     resultData = &resultDataNull;
 
-  debugMsg("# Cmd: '%s'", stringToCStr(text));
-
-  GdbResult result;
+  GdbResult result = GDB_ERROR;
 
   assert(resultData != NULL);
 
   resultData->removeAll();
 
-  //
-  PendingCommand cmd;
-  cmd.m_cmdText = text;
-  m_pending.push_back(cmd);
-
-  // Send the command to gdb
-  text += "\n";
-  QByteArray wtext = text.toLatin1();
-  m_process.write(wtext);
-
-  if (m_enableLog)
-  {
-    //
-    QString logText;
-    writeLogEntry("\n");
-    logText = "<< ";
-    logText += text;
-    writeLogEntry(logText);
-  }
+  int token = writeCommand(text, GdbResultCallback());
 
-  do
+  // Wait for the result record with our token
+  while (m_pending.contains(token) && rc == 0)
   {
-    if (readFromGdb(&result, resultData))
+    Resp* resp = NULL;
+    if (readFromGdb(&resp, 100))
     {
       rc = -1;
     }
-  } while (!m_pending.isEmpty() && rc == 0);
-
-  while (!m_list.isEmpty())
-  {
-    readFromGdb(NULL, resultData);
+    else if (resp != NULL && resp->isResult() && resp->m_token == token)
+    {
+      result = resp->m_result;
+      resultData->share(resp->tree);
+    }
   }
 
   m_busy--;
 
   dispatchResp();
 
-  onReadyReadStandardOutput();
+  onRespReady();
 
   if (rc)
     return GDB_ERROR;
@@ -1078,6 +1466,9 @@ int GdbCom::init(QString gdbPath, bool enableDebugLog)
 
   enableLog(enableDebugLog);
 
+  // Commands of a previous session
+  failPending();
+
   commandLine.sprintf("%s --interpreter=mi2", stringToCStr(gdbPath));
 
   if (m_enableLog)
@@ -1087,15 +1478,15 @@ int GdbCom::init(QString gdbPath, bool enableDebugLog)
     writeLogEntry(logStr);
   }
 
-  m_process.start(commandLine);
-  m_process.waitForStarted(6000);
+  // Make a byte exact copy of the output from GDB together with the log
+  QString captureFilename;
+  if (m_enableLog)
+    captureFilename = GDB_CAPTURE_FILE;
 
-  if (m_process.state() == QProcess::NotRunning)
-  {
-    return 1;
-  }
+  int rc = 0;
+  QMetaObject::invokeMethod(m_reader, "start", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, rc), Q_ARG(QString, commandLine), Q_ARG(QString, captureFilename));
 
-  return 0;
+  return rc;
 }
 
 int GdbCom::getPid()
@@ -1112,69 +1503,88 @@ GdbCom& GdbCom::getInstance()
   return core;
 }
 
-void GdbCom::onReadyReadStandardError()
-{
-  // Dump all stderr content
-  QByteArray stderrBuffer = m_process.readAllStandardError();
-  if (!stderrBuffer.isEmpty())
-  {
-    QString respString = QString(stderrBuffer);
-    QStringList respList = respString.split("\n");
-    for (int r = 0; r < respList.size(); r++)
-    {
-      QString row = respList[r];
-      if (!row.isEmpty())
-        debugMsg("GDB|E>%s", stringToCStr(row));
-    }
-  }
-}
-
-void GdbCom::onReadyReadStandardOutput()
+/**
+ * @brief Dispatches the responses parsed by the reader thread.
+ * At most GDB_DISPATCH_BATCH_SIZE responses are dispatched at a time so that a flood
+ * of output from GDB does not stop the GUI from being repainted.
+ */
+void GdbCom::onRespReady()
 {
   if (m_busy != 0)
     return;
 
-  while (m_process.bytesAvailable() || m_list.isEmpty() == false)
-  {
-    Tree resultDataNull;
-    readFromGdb(NULL, &resultDataNull);
+  m_reader->ackRespReady();
 
-    assert(m_pending.isEmpty() == true);
-  }
+  int rc = 0;
+  int respCount = 0;
+  Resp* resp = NULL;
+  while (respCount < GDB_DISPATCH_BATCH_SIZE && (rc = readFromGdb(&resp, 0)) == 0 && resp != NULL)
+    respCount++;
 
   dispatchResp();
+
+  // GDB has exited and all its responses has been dispatched?
+  if (rc != 0)
+    failPending();
+
+  // More to dispatch? Then continue after any pending events has been handled.
+  if (respCount == GDB_DISPATCH_BATCH_SIZE)
+    QMetaObject::invokeMethod(this, "onRespReady", Qt::QueuedConnection);
 }
 
-void GdbCom::dispatchResp()
+/**
+ * @brief Called for each row received from GDB when the log is enabled.
+ */
+void GdbCom::onRowReceived(QString row)
 {
+  if (m_enableLog)
+  {
+    QString logText;
+    logText = ">> ";
+    logText += row;
+    logText += "\n";
+    writeLogEntry(logText);
+  }
+}
 
+void GdbCom::dispatchResp()
+{
   // Dispatch the response
   while (!m_respQueue.isEmpty())
   {
     Resp* resp = m_respQueue.takeFirst();
     assert(resp != NULL);
-    // Dispatch the response
-    if (m_listener)
-    {
-      if (resp->getType() == Resp::EXEC_ASYNC_OUTPUT)
-        m_listener->onExecAsyncOut(resp->tree, resp->reason);
-      if (resp->getType() == Resp::STATUS_ASYNC_OUTPUT)
-        m_listener->onStatusAsyncOut(resp->tree, resp->reason);
-      if (resp->getType() == Resp::NOTIFY_ASYNC_OUTPUT)
-        m_listener->onNotifyAsyncOut(resp->tree, resp->reason);
-      if (resp->getType() == Resp::LOG_STREAM_OUTPUT)
-        m_listener->onLogStreamOutput(resp->getString());
-      if (resp->getType() == Resp::TARGET_STREAM_OUTPUT)
-        m_listener->onTargetStreamOutput(resp->getString());
-      if (resp->getType() == Resp::CONSOLE_STREAM_OUTPUT)
-        m_listener->onConsoleStreamOutput(resp->getString());
-      if (resp->getType() == Resp::RESULT)
-        m_listener->onResult(resp->tree);
-    }
+    dispatchResp(m_listener, resp);
     delete resp;
   }
 }
 
+/**
+ * @brief Passes a response to a listener and to the callback of the command (if any).
+ */
+void GdbCom::dispatchResp(GdbComListener* listener, Resp* resp)
+{
+  if (listener)
+  {
+    if (resp->getType() == Resp::EXEC_ASYNC_OUTPUT)
+      listener->onExecAsyncOut(resp->tree, resp->reason);
+    if (resp->getType() == Resp::STATUS_ASYNC_OUTPUT)
+      listener->onStatusAsyncOut(resp->tree, resp->reason);
+    if (resp->getType() == Resp::NOTIFY_ASYNC_OUTPUT)
+      listener->onNotifyAsyncOut(resp->tree, resp->reason);
+    if (resp->getType() == Resp::LOG_STREAM_OUTPUT)
+      listener->onLogStreamOutput(resp->getString());
+    if (resp->getType() == Resp::TARGET_STREAM_OUTPUT)
+      listener->onTargetStreamOutput(resp->getString());
+    if (resp->getType() == Resp::CONSOLE_STREAM_OUTPUT)
+      listener->onConsoleStreamOutput(resp->getString());
+    if (resp->getType() == Resp::RESULT)
+      listener->onResult(resp->tree);
+  }
+  if (resp->getType() == Resp::RESULT && resp->m_callback)
+    resp->m_callback(resp->m_result, resp->tree);
+}
+
 void GdbCom::enableLog(bool enable)
 {
   if (m_enableLog == enable)
@@ -1190,6 +1600,7 @@ void GdbCom::enableLog(bool enable)
     m_logFile.close();
   }
   m_enableLog = false;
+  m_reader->enableLog(false);
 
   if (enable)
   {
@@ -1198,6 +1609,7 @@ void GdbCom::enableLog(bool enable)
       infoMsg("Created %s", (const char*) GDB_LOG_FILE);
 
       m_enableLog = true;
+      m_reader->enableLog(true);
 
       QString logStr;
       QDateTime now = QDateTime::currentDateTime();
@@ -1243,5 +1655,8 @@ void GdbCom::onGdbStateChanged(QProcess::ProcessState newState)
   if (newState == QProcess::NotRunning)
   {
     critMsg("GDB unexpected terminated");
+
+    // Dispatch what was received and fail the commands that are not answered
+    onRespReady();
   }
 }
@@ -10,12 +10,21 @@
 #define FILE__COM_H
 
 #include "config.h"
+#include "spscring.h"
 #include "tree.h"
 
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QList>
+#include <QMap>
+#include <QMutex>
 #include <QProcess>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
 #include <assert.h>
+#include <functional>
 
 class Token
 {
@@ -59,16 +68,66 @@ public:
     return m_text;
   };
 
-  const char* toString();
-
 private:
   Type m_type;
-  char m_tmpBuff[128];
 
 public:
   QString m_text;
 };
 
+/**
+ * @brief A token in the output from GDB.
+ * Refers to a span of the raw input buffer instead of holding a copy of the text.
+ */
+class MiToken
+{
+public:
+  Token::Type getType() const
+  {
+    return m_type;
+  };
+
+public:
+  Token::Type m_type;
+  int m_offset; //!< Index of the first character in the input buffer.
+  int m_length; //!< Number of characters.
+};
+
+/**
+ * @brief Splits a row of GDB output into tokens.
+ * The row can be fed in pieces as it is received. The state of a partial token is kept
+ * between the calls so that no character is scanned more than once.
+ */
+class MiLexer
+{
+public:
+  MiLexer();
+
+  void reset();
+  void feed(const char* data, int startIdx, int endIdx, QVector<MiToken>* list);
+  void finish(int endIdx, QVector<MiToken>* list);
+  void shift(int delta);
+
+private:
+  enum State
+  {
+    IDLE,
+    IN_STRING, // Inside "..."
+    IN_STRING_ESCAPE, // After a '\' inside "..."
+    IN_NUMBER, // Command token prefix (Eg: "12^done")
+    IN_PAREN, // "(gdb)"
+    IN_VAR
+  };
+
+  void emitToken(Token::Type type, int length, QVector<MiToken>* list);
+
+private:
+  State m_state;
+  MiToken m_tok; //!< The token being scanned.
+  bool m_isFirst; //!< True if no token has been found yet in the row.
+  int m_varEnd; //!< Index after the last non-whitespace character of a VAR token.
+};
+
 class GdbComListener : public QObject
 {
 
@@ -113,19 +172,28 @@ enum GdbResult
   GDB_EXIT
 };
 
+/**
+ * @brief Called when the result record of an asynchronous command has been received.
+ */
+typedef std::function<void(GdbResult result, Tree& resultData)> GdbResultCallback;
+
 class PendingCommand
 {
 public:
-  PendingCommand(){};
+  PendingCommand()
+    : m_token(0){};
 
+  int m_token; //!< The numeric MI token the command was prefixed with.
   QString m_cmdText;
+  GdbResultCallback m_callback;
 };
 
 class Resp
 {
 public:
   Resp()
-    : m_type(UNKNOWN){};
+    : m_type(UNKNOWN)
+    , m_token(-1){};
 
   typedef enum
   {
@@ -178,6 +246,107 @@ public:
   Tree tree;
   GdbComListener::AsyncClass reason;
   GdbResult m_result;
+  int m_token; //!< The token of the command this is a response to (or -1).
+  GdbResultCallback m_callback;
+};
+
+/**
+ * @brief Owns the GDB process and parses its output in a thread of its own.
+ * The finished responses are handed over to GdbCom through a single-producer/single-consumer ring.
+ * Pushing and popping are lock-free. A lock is only taken when the ring is empty or full and a thread has to wait.
+ */
+class GdbReader : public QObject
+{
+private:
+  Q_OBJECT
+
+public:
+  GdbReader();
+  ~GdbReader();
+
+  static void tokenize(const QByteArray& buffer, int startIdx, int endIdx, QVector<MiToken>* list);
+  static int loadCapture(QString filename, QVector<QByteArray>* chunkList);
+
+  void feedOutput(const QByteArray& data);
+  bool popResp(Resp** respPtr, int timeoutMs);
+  void ackRespReady();
+  void quit();
+  bool isRunning() const
+  {
+    return m_running.loadAcquire() != 0;
+  };
+  void enableLog(bool enable)
+  {
+    m_enableLog.storeRelease(enable ? 1 : 0);
+  };
+
+public slots:
+  int start(QString commandLine, QString captureFilename);
+  void write(QByteArray data);
+  void stop();
+
+signals:
+  void respReady();
+  void rowReceived(QString row);
+  void stateChanged(QProcess::ProcessState newState);
+
+private slots:
+  void onReadyReadStandardOutput();
+  void onReadyReadStandardError();
+  void onStateChanged(QProcess::ProcessState newState);
+
+private:
+  enum RowType
+  {
+    ROW_UNKNOWN, // Not enough characters received yet
+    ROW_MI, // A MI record
+    ROW_TARGET_OUTPUT // Output from the target
+  };
+
+  void parseRow(int rowEnd);
+  void writeCapture(const QByteArray& data);
+  int parseAsyncOutput(Resp* resp, GdbComListener::AsyncClass* ac);
+  Resp* parseAsyncRecord();
+  Resp* parseExecAsyncOutput();
+  Resp* parseNotifyAsyncOutput();
+  Resp* parseOutOfBandRecord();
+  Resp* parseOutput();
+  int parseResult(TreeNode* parent);
+  Resp* parseResultRecord();
+  Resp* parseStatusAsyncOutput();
+  Resp* parseStreamRecord();
+  int parseValue(TreeNode* item);
+
+  const MiToken* pop_token();
+  const MiToken* peek_token();
+  const MiToken* checkToken(Token::Type type);
+  const MiToken* eatToken(Token::Type type);
+  QByteArray getTokenBytes(const MiToken* tok) const;
+  QString getTokenString(const MiToken* tok) const;
+  bool isTokenPending();
+  void pushResp(Resp* resp);
+
+private:
+  QProcess* m_process;
+  SpscRing<Resp*> m_respRing; //!< Responses parsed but not yet taken by GdbCom.
+  QMutex m_waitMutex; //!< Only taken when one of the threads has to wait for the other.
+  QWaitCondition m_respAdded;
+  QWaitCondition m_respTaken;
+  QAtomicInt m_consumerWaiting; //!< 1 while the consumer waits for a response.
+  QAtomicInt m_producerWaiting; //!< 1 while the producer waits for a free slot in m_respRing.
+  QAtomicInt m_quit; //!< 1 when the consumer no longer pops (see quit()).
+  QAtomicInt m_respReadyPending; //!< 1 if respReady() has been emitted but not yet acknowledged.
+  QAtomicInt m_running; //!< 1 while the GDB process is running.
+  QAtomicInt m_enableLog; //!< 1 if rowReceived() should be emitted for each row.
+  QFile m_captureFile; //!< Raw copy of all output received from GDB (if open).
+  QElapsedTimer m_captureTimer;
+  QByteArray m_inputBuffer; //!< List of raw characters received from the GDB process.
+  int m_rowStart; //!< Index in m_inputBuffer of the row being received.
+  int m_scanPos; //!< Index in m_inputBuffer of the first character not yet scanned.
+  RowType m_rowType; //!< The type of the row being received.
+  MiLexer m_lexer;
+  QVector<MiToken> m_tokens; //!< Tokens of the row being received.
+  int m_tokenIdx; //!< Index of the next token in m_tokens to parse.
 };
 
 class GdbCom : public QObject
@@ -204,50 +373,47 @@ public:
   GdbResult commandF(Tree* resultData, const char* cmd, ...);
   GdbResult command(Tree* resultData, QString cmd);
 
-  static QList<Token*> tokenize(QString str);
+  int commandAsyncF(const char* cmdFmt, ...);
+  int commandAsync(QString cmd, GdbResultCallback callback = GdbResultCallback());
+
+  /**
+   * @brief Returns the number of commands sent to GDB that has not been answered yet.
+   */
+  int getPendingCount() const
+  {
+    return m_pending.size();
+  };
+
+  static void tokenize(const QByteArray& buffer, int startIdx, int endIdx, QVector<MiToken>* list)
+  {
+    GdbReader::tokenize(buffer, startIdx, endIdx, list);
+  };
 
   void enableLog(bool enable);
 
-private:
-  int parseAsyncOutput(Resp* resp, GdbComListener::AsyncClass* ac);
-  Resp* parseAsyncRecord();
-  Resp* parseExecAsyncOutput();
-  Resp* parseNotifyAsyncOutput();
-  Resp* parseOutOfBandRecord();
-  Resp* parseOutput();
-  int parseResult(TreeNode* parent);
-  Resp* parseResultRecord();
-  Resp* parseStatusAsyncOutput();
-  Resp* parseStreamRecord();
-  int parseValue(TreeNode* item);
+  static void dispatchResp(GdbComListener* listener, Resp* resp);
 
 public slots:
-  void onReadyReadStandardOutput();
-  void onReadyReadStandardError();
+  void onRespReady();
+  void onRowReceived(QString row);
   void onGdbStateChanged(QProcess::ProcessState newState);
 
 private:
-  int readFromGdb(GdbResult* m_result, Tree* m_resultData);
-  void decodeGdbResponse();
-  Token* pop_token();
-  Token* peek_token();
-  Token* checkToken(Token::Type type);
-  Token* eatToken(Token::Type type);
+  int readFromGdb(Resp** respPtr, int timeoutMs);
+  int writeCommand(QString cmd, GdbResultCallback callback);
+  void failPending();
   void dispatchResp();
-  bool isTokenPending();
-  void readTokens();
   void writeLogEntry(QString logText);
 
 private:
-  QProcess m_process;
+  QThread m_readerThread;
+  GdbReader* m_reader; //!< Lives in m_readerThread.
   QList<Resp*> m_respQueue; //!< List of responses received from GDB
-  QList<PendingCommand> m_pending;
+  QMap<int, PendingCommand> m_pending; //!< Commands sent to GDB (indexed by token).
+  int m_lastToken; //!< The last token used for a command.
   GdbComListener* m_listener;
 
-  QList<Token*> m_freeTokens; //!< List of tokens allocated but not in use.
-  QList<Token*> m_list;
   QFile m_logFile;
-  QByteArray m_inputBuffer; //!< List of raw characters received from the GDB process.
   int m_busy;
   bool m_enableLog;
 };
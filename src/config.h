@@ -19,6 +19,16 @@
 
 #define GDB_LOG_FILE "gede_gdb_log.txt"
 
+// Byte exact capture of the output from GDB (written when the GDB log is enabled)
+#define GDB_CAPTURE_FILE "gede_gdb_capture.bin"
+#define GDB_CAPTURE_HEADER "# Gede GDB capture v1"
+
+// Max number of parsed GDB responses waiting to be handled by the GUI (must be a power of two)
+#define GDB_RESP_RING_SIZE 4096
+
+// Max number of GDB responses handled by the GUI before repainting is allowed
+#define GDB_DISPATCH_BATCH_SIZE 256
+
 // etags command and argument to use to get list of tags
 #define ETAGS_CMD1 "ctags" // Used on Linux
 #define ETAGS_CMD2 "exctags" // Used on freebsd
@@ -27,9 +37,18 @@
 // Max number of recently used goto locations to save
 #define MAX_GOTO_RUI_COUNT 10
 
+// Max number of suggestions in the GoTo dialog.
+#define GOTO_MAX_TAGS 2000
+
+// Max number of fuzzy matches shown in the GoTo dialog.
+#define GOTO_MAX_FUZZY_RESULTS 100
+
 // Width of items in the GoTo list widget.
 #define GOTO_LISTWIDGET_ITEM_WIDTH 240
 
+// Number of lines colorized at a time by the code view (the highlighter state is kept between the blocks).
+#define HIGHLIGHT_BLOCK_SIZE 512
+
 // Expand all classes if the total number of members is below this number
 #define CLASS_LIST_AUTO_EXPAND_COUNT 40
 
@@ -42,7 +61,26 @@
 // Which fileextension does ada use?
 #define ADA_FILE_EXTENSION ".adb"
 
+// Which fileextensions does C and C++ use?
+#define CXX_FILE_EXTENSIONS ".c .cc .cpp .cxx .c++ .h .hh .hpp .hxx .h++ .inl"
+
 // Max number of last used programs
 #define MAX_LAST_USED_PROGRAMS 10
 
+// The file (in the same directory as the project config file) with the tags of the source files
+#define TAG_INDEX_FILENAME "gede2_tags.idx"
+#define TAG_INDEX_VERSION 2
+
+// The size of the pages read from GDB and cached by the memory dialog (must be a power of two)
+#define MEMORY_CACHE_PAGE_SIZE 4096
+
+// Max number of bytes read from the target with a single -data-read-memory-bytes command
+#define MEMORY_READ_CHUNK_SIZE (1024 * 1024)
+
+// Max number of changed memory areas listed in the memory dialog
+#define MEMORY_MAX_CHANGED_REGIONS 1000
+
+// Max number of bytes that can be copied as text from the memory dialog (larger selections are saved to a file)
+#define MEMORY_MAX_COPY_SIZE (64 * 1024)
+
 #endif // FILE__CONFIG_H
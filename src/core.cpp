@@ -225,6 +225,9 @@ Core::Core()
   , m_isRemote(false)
   , m_ptsFd(0)
   , m_scanSources(false)
+  , m_refreshFlags(0)
+  , m_visiblePanels(REFRESH_ALL)
+  , m_refreshInFlight(0)
   , m_ptsListener(NULL)
   , m_memDepth(32)
 {
@@ -232,6 +235,10 @@ Core::Core()
   GdbCom& com = GdbCom::getInstance();
   com.setListener(this);
 
+  m_refreshTimer.setSingleShot(true);
+  m_refreshTimer.setInterval(0);
+  connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(onRefreshTimeout()));
+
   // TODO mundak: program output is not supported right now
   // m_ptsFd = openPseudoTerminal();
   // infoMsg("Using: %s", ptsname(m_ptsFd));
@@ -241,11 +248,9 @@ Core::~Core()
 {
   m_localVars.clear();
 
-  for (int i = 0; i < m_watchList.size(); i++)
-  {
-    VarWatch* watch = m_watchList[i];
-    delete watch;
-  }
+  qDeleteAll(m_watchIndex);
+  m_watchIndex.clear();
+  m_watchChildren.clear();
 
   delete m_ptsListener;
   m_ptsListener = NULL;
@@ -555,38 +560,115 @@ void Core::onGdbOutput(int socketFd)
 
 /**
  * @brief Reads a memory area.
+ * Large areas are read with several commands (of MEMORY_READ_CHUNK_SIZE bytes) which are decoded directly into data.
  * @return 0 on success.
  */
 int Core::gdbGetMemory(quint64 addr, size_t count, QByteArray* data)
 {
-  GdbCom& com = GdbCom::getInstance();
-  Tree resultData;
-
   int rc = 0;
-  QString cmdStr;
-  cmdStr.sprintf("-data-read-memory-bytes 0x%llx %u", (long long) addr, (unsigned int) count);
 
-  rc = com.command(&resultData, cmdStr);
+  data->resize((int) count);
 
-  QString dataStr = resultData.getString("/memory/1/contents");
-  if (!dataStr.isEmpty())
+  size_t doneCount = 0;
+  while (doneCount < count)
   {
-    data->clear();
-
-    QByteArray dataByteArray = dataStr.toLocal8Bit();
-    const char* dataCStr = dataByteArray.constData();
-    int dataCStrLen = strlen(dataCStr);
-    for (int i = 0; i + 1 < dataCStrLen; i += 2)
+    int chunkSize = (int) qMin((size_t) MEMORY_READ_CHUNK_SIZE, count - doneCount);
+    int readCount = priv_gdbGetMemoryChunk(addr + doneCount, data->data() + doneCount, chunkSize);
+    if (readCount <= 0)
     {
-      unsigned char dataByte = hexStringToU8(dataCStr + i);
-
-      data->push_back(dataByte);
+      rc = -1;
+      break;
     }
+    doneCount += readCount;
+
+    // Only the beginning of the chunk was readable?
+    if (readCount < chunkSize)
+      break;
   }
+  data->resize((int) doneCount);
 
   return rc;
 }
 
+/**
+ * @brief Reads a memory area in chunks of MEMORY_READ_CHUNK_SIZE bytes.
+ * @param sink   Called with each chunk when it has been read. Returns false to abort the read.
+ * @return 0 on success or -1 if the memory could not be read or the read was aborted.
+ */
+int Core::gdbStreamMemory(quint64 addr, quint64 count, MemorySink sink)
+{
+  QByteArray chunk;
+  chunk.resize(MEMORY_READ_CHUNK_SIZE);
+
+  quint64 doneCount = 0;
+  while (doneCount < count)
+  {
+    int chunkSize = (int) qMin((quint64) MEMORY_READ_CHUNK_SIZE, count - doneCount);
+    int readCount = priv_gdbGetMemoryChunk(addr + doneCount, chunk.data(), chunkSize);
+    if (readCount != chunkSize)
+      return -1;
+
+    if (!sink(addr + doneCount, chunk.constData(), readCount))
+      return -1;
+    doneCount += readCount;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Reads a memory area of at most MEMORY_READ_CHUNK_SIZE bytes.
+ * @return The number of bytes read or -1 on error.
+ */
+int Core::priv_gdbGetMemoryChunk(quint64 addr, char* data, int count)
+{
+  GdbCom& com = GdbCom::getInstance();
+  Tree resultData;
+
+  if (com.commandF(&resultData, "-data-read-memory-bytes 0x%llx %d", (unsigned long long) addr, count) != GDB_DONE)
+    return -1;
+
+  return decodeMemory(resultData, data, count);
+}
+
+/**
+ * @brief Reads a memory area without waiting for GDB to answer.
+ * @param callback   Called with the content when GDB has answered.
+ * @return The token of the command.
+ */
+int Core::gdbGetMemoryAsync(quint64 addr, size_t count, MemoryCallback callback)
+{
+  GdbCom& com = GdbCom::getInstance();
+
+  QString cmdStr;
+  cmdStr.sprintf("-data-read-memory-bytes 0x%llx %u", (long long) addr, (unsigned int) count);
+
+  return com.commandAsync(cmdStr, [callback, count](GdbResult res, Tree& resultData) {
+    QByteArray data;
+    data.resize((int) count);
+    int readCount = (res == GDB_DONE) ? decodeMemory(resultData, data.data(), (int) count) : -1;
+    data.resize(qMax(readCount, 0));
+    callback(readCount > 0 ? 0 : -1, data);
+  });
+}
+
+/**
+ * @brief Decodes the result of a -data-read-memory-bytes command.
+ * @param data   Receives at most maxCount bytes.
+ * @return The number of bytes decoded or -1 on error.
+ */
+int Core::decodeMemory(Tree& resultData, char* data, int maxCount)
+{
+  static const TreePath pathContents("memory/1/contents");
+
+  TreeNode* node = resultData.findChild(pathContents);
+  if (!node)
+    return -1;
+
+  int hexLen = qMin(node->getDataLength(), maxCount * 2);
+  return hexDecode(node->getDataPtr(), hexLen, (quint8*) data);
+}
+
 /**
  * @brief Asks GDB for a list of source files.
  * @return true if any files was added or removed.
@@ -595,11 +677,21 @@ bool Core::gdbGetFiles()
 {
   GdbCom& com = GdbCom::getInstance();
   Tree resultData;
-  QMap<QString, bool> fileLookup;
-  bool modified = false;
 
   com.command(&resultData, "-file-list-exec-source-files");
 
+  return updateSourceFiles(resultData);
+}
+
+/**
+ * @brief Rebuilds the list of source files from a "-file-list-exec-source-files" result.
+ * @return true if any files was added or removed.
+ */
+bool Core::updateSourceFiles(Tree& resultData)
+{
+  QMap<QString, bool> fileLookup;
+  bool modified = false;
+
   // Clear the old list
   for (int m = 0; m < m_sourceFiles.size(); m++)
   {
@@ -952,13 +1044,7 @@ VarWatch* Core::getVarWatchInfo(QString watchId)
 {
   assert(watchId != "");
   assert(watchId[0] == 'w');
-  for (int i = 0; i < m_watchList.size(); i++)
-  {
-    VarWatch* watch = m_watchList[i];
-    if (watch->getWatchId() == watchId)
-      return watch;
-  }
-  return NULL;
+  return m_watchIndex.value(watchId, NULL);
 }
 
 /**
@@ -966,14 +1052,7 @@ VarWatch* Core::getVarWatchInfo(QString watchId)
  */
 QList<VarWatch*> Core::getWatchChildren(VarWatch& parentWatch)
 {
-  QList<VarWatch*> list;
-  for (int i = 0; i < m_watchList.size(); i++)
-  {
-    VarWatch* otherWatch = m_watchList[i];
-    if (parentWatch.getWatchId() == otherWatch->m_parentWatchId)
-      list.push_back(otherWatch);
-  }
-  return list;
+  return m_watchChildren.value(parentWatch.getWatchId());
 }
 
 /**
@@ -1035,7 +1114,7 @@ int Core::gdbAddVarWatch(QString varName, VarWatch** watchPtr)
   }
   else
   {
-    m_watchList.append(w);
+    m_watchIndex[watchId] = w;
   }
 
   *watchPtr = w;
@@ -1051,6 +1130,11 @@ int Core::gdbExpandVarWatchChildren(QString watchId)
   int res;
   Tree resultData;
   GdbCom& com = GdbCom::getInstance();
+  static const TreePath pathName("name");
+  static const TreePath pathExp("exp");
+  static const TreePath pathValue("value");
+  static const TreePath pathType("type");
+  static const TreePath pathNumChild("numchild");
 
   assert(getVarWatchInfo(watchId) != NULL);
 
@@ -1070,11 +1154,11 @@ int Core::gdbExpandVarWatchChildren(QString watchId)
     {
       // Get name and value
       TreeNode* child = root->getChild(i);
-      QString childWatchId = child->getChildDataString("name");
-      QString childExp = child->getChildDataString("exp");
-      QString childValue = child->getChildDataString("value");
-      QString childType = child->getChildDataString("type");
-      int numChild = child->getChildDataInt("numchild", 0);
+      QString childWatchId = child->getChildDataString(pathName);
+      QString childExp = child->getChildDataString(pathExp);
+      QString childValue = child->getChildDataString(pathValue);
+      QString childType = child->getChildDataString(pathType);
+      int numChild = child->getChildDataInt(pathNumChild, 0);
       bool hasChildren = false;
       if (numChild > 0)
         hasChildren = true;
@@ -1088,7 +1172,8 @@ int Core::gdbExpandVarWatchChildren(QString watchId)
         watch->m_varType = childType;
         watch->m_hasChildren = hasChildren;
         watch->m_parentWatchId = watchId;
-        m_watchList.append(watch);
+        m_watchIndex[childWatchId] = watch;
+        m_watchChildren[watchId].append(watch);
       }
 
       m_inf->ICore_onWatchVarChildAdded(*watch);
@@ -1124,33 +1209,132 @@ void Core::gdbRemoveVarWatch(QString watchId)
 
   ensureStopped();
 
-  assert(getVarWatchInfo(watchId) != NULL);
+  VarWatch* watch = getVarWatchInfo(watchId);
+  assert(watch != NULL);
+  if (watch == NULL)
+    return;
 
-  // Remove from the list
-  for (int i = 0; i < m_watchList.size(); i++)
+  // Remove it from the parent
+  if (!watch->m_parentWatchId.isEmpty())
   {
-    VarWatch* watch = m_watchList[i];
-    if (watch->getWatchId() == watchId)
-    {
-      m_watchList.removeAt(i--);
-      delete watch;
-    }
+    QHash<QString, QList<VarWatch*>>::iterator iter = m_watchChildren.find(watch->m_parentWatchId);
+    if (iter != m_watchChildren.end())
+      iter.value().removeOne(watch);
   }
 
-  // Remove children first
-  QStringList removeList;
-  for (int i = 0; i < m_watchList.size(); i++)
+  priv_forgetVarWatch(watch);
+
+  // Deletes the children in GDB as well
+  com.commandF(&resultData, "-var-delete %s", stringToCStr(watchId));
+}
+
+/**
+ * @brief Removes all children of a watch.
+ */
+void Core::priv_removeVarWatchChildren(VarWatch* watch)
+{
+  GdbCom& com = GdbCom::getInstance();
+
+  QList<VarWatch*> childList = m_watchChildren.take(watch->getWatchId());
+  if (childList.isEmpty())
+    return;
+  for (int i = 0; i < childList.size(); i++)
+    priv_forgetVarWatch(childList[i]);
+
+  com.commandF(NULL, "-var-delete -c %s", stringToCStr(watch->getWatchId()));
+}
+
+/**
+ * @brief Frees a watch and all its descendants (without telling GDB).
+ */
+void Core::priv_forgetVarWatch(VarWatch* watch)
+{
+  QList<VarWatch*> childList = m_watchChildren.take(watch->getWatchId());
+  for (int i = 0; i < childList.size(); i++)
+    priv_forgetVarWatch(childList[i]);
+
+  m_watchIndex.remove(watch->getWatchId());
+  delete watch;
+}
+
+/**
+ * @brief Tells which data (RefreshFlags) is shown by the GUI.
+ * Data that is not shown is not fetched when the target stops.
+ */
+void Core::setVisiblePanels(int refreshFlags)
+{
+  int shownFlags = refreshFlags & ~m_visiblePanels;
+  m_visiblePanels = refreshFlags;
+
+  // Fetch the data that was skipped while the panel was hidden
+  if (m_refreshFlags & shownFlags)
+    scheduleRefresh(0);
+}
+
+/**
+ * @brief Requests that data (RefreshFlags) is fetched from GDB.
+ * Only one refresh is in flight at a time. Requests that arrive meanwhile are
+ * merged and sent when the current refresh has completed.
+ */
+void Core::scheduleRefresh(int refreshFlags)
+{
+  m_refreshFlags |= refreshFlags;
+
+  if (m_refreshInFlight == 0)
+    m_refreshTimer.start();
+}
+
+void Core::onRefreshTimeout()
+{
+  GdbCom& com = GdbCom::getInstance();
+
+  // Resumed again? Then the next stop will refresh.
+  if (m_targetState != ICore::TARGET_STOPPED)
+    return;
+
+  int flags = m_refreshFlags & (m_visiblePanels | REFRESH_SOURCES);
+  m_refreshFlags &= ~flags;
+  if (flags == 0)
+    return;
+
+  // The queries are independent so they are sent pipelined (the results are handled in onResult())
+  GdbResultCallback onDone = [this](GdbResult, Tree&) { onRefreshDone(); };
+  QStringList cmdList;
+  if (m_pid == 0)
+    cmdList.append("-list-thread-groups");
+  if (flags & REFRESH_THREADS)
+    cmdList.append("-thread-info");
+  if (flags & REFRESH_WATCHES)
+    cmdList.append("-var-update --all-values *");
+  if (flags & REFRESH_LOCALS)
+    cmdList.append("-stack-list-variables --no-values");
+  for (int i = 0; i < cmdList.size(); i++)
   {
-    VarWatch* childWatch = m_watchList[i];
-    if (childWatch->m_parentWatchId == watchId)
-      removeList.push_back(childWatch->getWatchId());
+    m_refreshInFlight++;
+    com.commandAsync(cmdList[i], onDone);
   }
-  for (int i = 0; i < removeList.size(); i++)
+
+  if (flags & REFRESH_SOURCES)
   {
-    gdbRemoveVarWatch(removeList[i]);
+    m_refreshInFlight++;
+    com.commandAsync("-file-list-exec-source-files", [this](GdbResult res, Tree& resultData) {
+      if (res == GDB_DONE && updateSourceFiles(resultData) && m_inf)
+        m_inf->ICore_onSourceFileListChanged();
+      onRefreshDone();
+    });
   }
+}
 
-  com.commandF(&resultData, "-var-delete %s", stringToCStr(watchId));
+/**
+ * @brief Called when GDB has answered one of the refresh queries (or failed it because GDB has exited).
+ */
+void Core::onRefreshDone()
+{
+  m_refreshInFlight--;
+
+  // Did the target stop again while the queries were in flight? Then fetch the state of the last stop (once).
+  if (m_refreshInFlight == 0 && (m_refreshFlags & (m_visiblePanels | REFRESH_SOURCES)))
+    m_refreshTimer.start();
 }
 
 void Core::onNotifyAsyncOut(Tree& tree, AsyncClass ac)
@@ -1210,8 +1394,6 @@ ICore::StopReason Core::parseReasonString(QString reasonString)
 
 void Core::onExecAsyncOut(Tree& tree, AsyncClass ac)
 {
-  GdbCom& com = GdbCom::getInstance();
-
   debugMsg("ExecAsyncOut> %s", GdbCom::asyncClassToString(ac));
 
   // tree.dump();
@@ -1221,23 +1403,16 @@ void Core::onExecAsyncOut(Tree& tree, AsyncClass ac)
   {
     m_targetState = ICore::TARGET_STOPPED;
 
-    if (m_pid == 0)
-      com.command(NULL, "-list-thread-groups");
-
-    // Any new or destroyed thread?
-    com.commandF(NULL, "-thread-info");
-
-    com.commandF(NULL, "-var-update --all-values *");
-    com.commandF(NULL, "-stack-list-variables --no-values");
+    emit memoryChanged();
 
+    // Fetch the new state once the event loop is idle and the previous refresh is answered (consecutive stops are merged)
+    int refreshFlags = REFRESH_THREADS | REFRESH_WATCHES | REFRESH_LOCALS;
     if (m_scanSources)
     {
-      if (gdbGetFiles())
-      {
-        m_inf->ICore_onSourceFileListChanged();
-      }
+      refreshFlags |= REFRESH_SOURCES;
       m_scanSources = false;
     }
+    scheduleRefresh(refreshFlags);
 
     // Get the reason
     QString reasonString = tree.getString("reason");
@@ -1278,14 +1453,17 @@ void Core::onExecAsyncOut(Tree& tree, AsyncClass ac)
 
       m_inf->ICore_onFrameVarReset();
 
-      TreeNode* argsNode = tree.findChild("frame/args");
+      static const TreePath pathArgs("frame/args");
+      static const TreePath pathName("name");
+      static const TreePath pathValue("value");
+      TreeNode* argsNode = tree.findChild(pathArgs);
       if (argsNode)
       {
         for (int i = 0; i < argsNode->getChildCount(); i++)
         {
           TreeNode* child2 = argsNode->getChild(i);
-          QString varName = child2->getChildDataString("name");
-          QString varValue = child2->getChildDataString("value");
+          QString varName = child2->getChildDataString(pathName);
+          QString varValue = child2->getChildDataString(pathValue);
           if (m_inf)
             m_inf->ICore_onFrameVarChanged(varName, varValue);
         }
@@ -1300,6 +1478,11 @@ void Core::onExecAsyncOut(Tree& tree, AsyncClass ac)
   {
     m_targetState = ICore::TARGET_RUNNING;
 
+    // The state of the last stop is already stale
+    m_refreshTimer.stop();
+
+    emit memoryChanged();
+
     debugMsg("is running");
   }
 
@@ -1473,6 +1656,20 @@ void Core::dispatchBreakpointTree(Tree& tree)
 
 void Core::onResult(Tree& tree)
 {
+  static const TreePath pathName("name");
+  static const TreePath pathValue("value");
+  static const TreePath pathInScope("in_scope");
+  static const TreePath pathTypeChanged("type_changed");
+  static const TreePath pathNewType("new_type");
+  static const TreePath pathNewNumChildren("new_num_children");
+  static const TreePath pathId("id");
+  static const TreePath pathTargetId("target-id");
+  static const TreePath pathFrameFunc("frame/func");
+  static const TreePath pathFrameLine("frame/line");
+  static const TreePath pathDetails("details");
+  static const TreePath pathFunc("func");
+  static const TreePath pathLine("line");
+  static const TreePath pathFullname("fullname");
 
   debugMsg("Result>");
 
@@ -1486,13 +1683,13 @@ void Core::onResult(Tree& tree)
       for (int j = 0; j < rootNode->getChildCount(); j++)
       {
         TreeNode* child = rootNode->getChild(j);
-        QString watchId = child->getChildDataString("name");
+        QString watchId = child->getChildDataString(pathName);
         VarWatch* watch = getVarWatchInfo(watchId);
 
         bool typeChanged = false;
 
         // Watch no longer exist?
-        QString inscopeText = child->getChildDataString("in_scope");
+        QString inscopeText = child->getChildDataString(pathInScope);
         if (inscopeText == "invalid")
         {
           QString varName = watch->getName();
@@ -1506,7 +1703,7 @@ void Core::onResult(Tree& tree)
         else
         {
           // If the type has changed then all of the children must be removed.
-          QString typeChangeText = child->getChildDataString("type_changed");
+          QString typeChangeText = child->getChildDataString(pathTypeChanged);
           if (typeChangeText == "true")
             typeChanged = true;
           else if (watch != NULL && typeChanged)
@@ -1514,23 +1711,19 @@ void Core::onResult(Tree& tree)
             QString varName = watch->getName();
 
             // Remove children
-            QList<VarWatch*> removeList = getWatchChildren(*watch);
+            priv_removeVarWatchChildren(watch);
 
-            for (int cidx = 0; cidx < removeList.size(); cidx++)
-            {
-              gdbRemoveVarWatch(removeList[cidx]->getWatchId());
-            }
             watch->setValue("");
-            watch->m_varType = child->getChildDataString("new_type");
-            watch->m_hasChildren = child->getChildDataInt("new_num_children") > 0 ? true : false;
+            watch->m_varType = child->getChildDataString(pathNewType);
+            watch->m_hasChildren = child->getChildDataInt(pathNewNumChildren) > 0 ? true : false;
             m_inf->ICore_onWatchVarChanged(*watch);
           }
           // value changed?
           else if (watch)
           {
 
-            watch->setValue(child->getChildDataString("value"));
-            QString inScopeStr = child->getChildDataString("in_scope");
+            watch->setValue(child->getChildDataString(pathValue));
+            QString inScopeStr = child->getChildDataString(pathInScope);
             if (inScopeStr == "true" || inScopeStr.isEmpty())
               watch->m_inScope = true;
             else
@@ -1566,11 +1759,11 @@ void Core::onResult(Tree& tree)
       for (int cIdx = 0; cIdx < rootNode->getChildCount(); cIdx++)
       {
         TreeNode* child = rootNode->getChild(cIdx);
-        QString threadId = child->getChildDataString("id");
-        QString targetId = child->getChildDataString("target-id");
-        QString funcName = child->getChildDataString("frame/func");
-        QString lineNo = child->getChildDataString("frame/line");
-        QString details = child->getChildDataString("details");
+        QString threadId = child->getChildDataString(pathId);
+        QString targetId = child->getChildDataString(pathTargetId);
+        QString funcName = child->getChildDataString(pathFrameFunc);
+        QString lineNo = child->getChildDataString(pathFrameLine);
+        QString details = child->getChildDataString(pathDetails);
 
         if (details.isEmpty())
         {
@@ -1639,9 +1832,9 @@ void Core::onResult(Tree& tree)
         const TreeNode* child = rootNode->getChild(j);
 
         StackFrameEntry entry;
-        entry.m_functionName = child->getChildDataString("func");
-        entry.m_line = child->getChildDataInt("line");
-        entry.m_sourcePath = child->getChildDataString("fullname");
+        entry.m_functionName = child->getChildDataString(pathFunc);
+        entry.m_line = child->getChildDataInt(pathLine);
+        entry.m_sourcePath = child->getChildDataString(pathFullname);
         stackFrameList.push_front(entry);
       }
       if (m_inf)
@@ -1660,7 +1853,7 @@ void Core::onResult(Tree& tree)
       for (int j = 0; j < rootNode->getChildCount(); j++)
       {
         TreeNode* child = rootNode->getChild(j);
-        QString varName = child->getChildDataString("name");
+        QString varName = child->getChildDataString(pathName);
 
         m_localVars.push_back(varName);
       }
@@ -1838,6 +2031,7 @@ int Core::changeWatchVariable(QString watchId, QString newValue)
   gdbRes = com.commandF(&resultData, "-var-assign %s %s", stringToCStr(watchId), stringToCStr(dataStr));
   if (gdbRes == GDB_DONE)
   {
+    emit memoryChanged();
 
     com.commandF(&resultData, "-var-update --all-values *");
   }
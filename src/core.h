@@ -18,6 +18,7 @@
 #include <QMap>
 #include <QObject>
 #include <QSocketNotifier>
+#include <QTimer>
 #include <QVector>
 
 class Core;
@@ -245,6 +246,19 @@ public:
   virtual void ICore_onWatchVarChildAdded(VarWatch& watch) = 0;
 };
 
+/**
+ * @brief Called when an asynchronous memory read has finished.
+ * @param rc     0 on success.
+ * @param data   The content of the memory.
+ */
+typedef std::function<void(int rc, QByteArray data)> MemoryCallback;
+
+/**
+ * @brief Receives a chunk of a memory area being read.
+ * @return false to abort the read.
+ */
+typedef std::function<bool(quint64 addr, const char* data, int len)> MemorySink;
+
 class Core : public GdbComListener
 {
 private:
@@ -255,6 +269,18 @@ private:
   ~Core();
 
 public:
+  /**
+   * @brief The data that is fetched from GDB each time the target has stopped.
+   */
+  enum RefreshFlags
+  {
+    REFRESH_THREADS = 0x1, //!< The thread list (-thread-info).
+    REFRESH_WATCHES = 0x2, //!< The values of the variable objects (-var-update).
+    REFRESH_LOCALS = 0x4, //!< The local variables of the current frame.
+    REFRESH_SOURCES = 0x8, //!< The source file list (after a library was loaded).
+    REFRESH_ALL = 0xf
+  };
+
   static Core& getInstance();
   int initPid(Settings* cfg, QString gdbPath, QString programPath, int pid);
   int initLocal(Settings* cfg, QString gdbPath, QString programPath, QStringList argumentList);
@@ -266,6 +292,7 @@ public:
   {
     m_inf = inf;
   };
+  void setVisiblePanels(int refreshFlags);
 
 private:
   void onNotifyAsyncOut(Tree& tree, AsyncClass ac);
@@ -279,11 +306,18 @@ private:
   void dispatchBreakpointDeleted(int id);
   void dispatchBreakpointTree(Tree& tree);
   static ICore::StopReason parseReasonString(QString string);
+  static int decodeMemory(Tree& resultData, char* data, int maxCount);
+  int priv_gdbGetMemoryChunk(quint64 addr, char* data, int count);
   void detectMemoryDepth();
   static int openPseudoTerminal();
   void ensureStopped();
   int runInitCommands(Settings* cfg);
   int priv_gdbVarWatchCreate(QString varName, QString watchId, VarWatch* watch);
+  void priv_removeVarWatchChildren(VarWatch* watch);
+  void priv_forgetVarWatch(VarWatch* watch);
+  void scheduleRefresh(int refreshFlags);
+  void onRefreshDone();
+  bool updateSourceFiles(Tree& resultData);
 
 public:
   int gdbSetBreakpointAtFunc(QString func);
@@ -313,6 +347,8 @@ public:
   void stop();
   int gdbExpandVarWatchChildren(QString watchId);
   int gdbGetMemory(quint64 addr, size_t count, QByteArray* data);
+  int gdbStreamMemory(quint64 addr, quint64 count, MemorySink sink);
+  int gdbGetMemoryAsync(quint64 addr, size_t count, MemoryCallback callback);
 
   void selectThread(int threadId);
   void selectFrame(int selectedFrameIdx);
@@ -345,8 +381,15 @@ public:
 
   bool isRunning();
 
+signals:
+  /**
+   * @brief Emitted when the memory of the target may have been changed (the target has run or a variable was written).
+   */
+  void memoryChanged();
+
 private slots:
   void onGdbOutput(int socketNr);
+  void onRefreshTimeout();
 
 private:
   ICore* m_inf;
@@ -358,11 +401,16 @@ private:
   ICore::TargetState m_lastTargetState;
   int m_pid;
   int m_currentFrameIdx;
-  QList<VarWatch*> m_watchList;
+  QHash<QString, VarWatch*> m_watchIndex; //!< All watches (indexed by watchId).
+  QHash<QString, QList<VarWatch*>> m_watchChildren; //!< The children of the watches (indexed by the watchId of the parent).
   int m_varWatchLastId;
   bool m_isRemote; //!< True if "remote target" or false if it is a "local target".
   int m_ptsFd;
   bool m_scanSources; //!< True if the source filelist may have changed
+  QTimer m_refreshTimer; //!< Fires when the data after a stop should be fetched.
+  int m_refreshFlags; //!< The data (RefreshFlags) that needs to be fetched.
+  int m_visiblePanels; //!< The data (RefreshFlags) that is shown by the GUI.
+  int m_refreshInFlight; //!< Number of refresh queries that GDB has not answered yet (failed by GdbCom if GDB exits).
   QSocketNotifier* m_ptsListener;
 
   QStringList m_localVars;
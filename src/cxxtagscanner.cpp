@@ -0,0 +1,749 @@
+/*
+ * Copyright (C) 2018-2020 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+// #define ENABLE_DEBUGMSG
+
+#include "cxxtagscanner.h"
+
+#include "config.h"
+#include "log.h"
+#include "util.h"
+
+#include <QFile>
+#include <QStringList>
+#include <assert.h>
+#include <string.h>
+
+/**
+ * @brief Words that may be followed by a '(' but are not function names.
+ */
+static const char* const g_notFuncNames[] = { "if", "while", "for", "switch", "return", "sizeof", "alignof", "decltype", "noexcept", "throw", "__attribute__", "alignas",
+  "requires", "__declspec", "static_assert", "catch", "typeid", "defined", "__asm__", "asm", NULL };
+
+/**
+ * @brief Words that can not be the name of a variable.
+ */
+static const char* const g_notVarNames[] = { "int", "char", "short", "long", "float", "double", "void", "bool", "signed", "unsigned", "const", "volatile", "static", "auto",
+  "register", "inline", "mutable", "constexpr", "thread_local", "struct", "class", "union", "enum", "operator", NULL };
+
+static inline bool isWordStart(unsigned char c)
+{
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_' || c == '$' || c >= 0x80;
+}
+
+static inline bool isWordChar(unsigned char c)
+{
+  return isWordStart(c) || ('0' <= c && c <= '9');
+}
+
+CxxTagScanner::CxxTagScanner()
+{
+}
+
+CxxTagScanner::~CxxTagScanner()
+{
+}
+
+/**
+ * @brief Returns true if the file extension is one used for C or C++ files.
+ */
+bool CxxTagScanner::isCxxFile(QString filepath)
+{
+  QString extension = getExtensionPart(filepath).toLower();
+  if (extension.isEmpty())
+    return false;
+  QStringList extensionList = QString(CXX_FILE_EXTENSIONS).split(' ');
+  return extensionList.contains(extension);
+}
+
+int CxxTagScanner::scan(QString filepath, QList<Tag>* taglist)
+{
+  // Open file
+  QFile file(filepath);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    errorMsg("Failed to open '%s'", stringToCStr(filepath));
+    return -1;
+  }
+
+  return scanBuffer(filepath, file.readAll(), taglist);
+}
+
+/**
+ * @brief Scans the content of a file for tags.
+ * @param filepath   The file that the content was read from.
+ */
+int CxxTagScanner::scanBuffer(QString filepath, const QByteArray& content, QList<Tag>* taglist)
+{
+  m_filepath = filepath;
+  m_content = content;
+
+  tokenize();
+
+  parse(taglist);
+
+  m_tokens.clear();
+  m_scopes.clear();
+  m_content.clear();
+
+  return 0;
+}
+
+void CxxTagScanner::pushToken(Token::Type type, int start, int length, int lineNr)
+{
+  Token tok;
+  tok.m_type = type;
+  tok.m_start = start;
+  tok.m_length = length;
+  tok.m_lineNr = lineNr;
+  m_tokens.append(tok);
+}
+
+/**
+ * @brief Splits the file content into tokens.
+ * Comments, preprocessor directives and whitespace are dropped.
+ */
+void CxxTagScanner::tokenize()
+{
+  const unsigned char* text = (const unsigned char*) m_content.constData();
+  const int len = m_content.size();
+  int lineNr = 1;
+  bool isLineStart = true; //!< True if only whitespace has been found on the current line.
+
+  m_tokens.clear();
+  m_tokens.reserve(len / 4);
+
+  int i = 0;
+  while (i < len)
+  {
+    unsigned char c = text[i];
+    int start = i;
+
+    if (c == '\n')
+    {
+      lineNr++;
+      isLineStart = true;
+      i++;
+    }
+    else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v')
+      i++;
+    // Comment?
+    else if (c == '/' && i + 1 < len && text[i + 1] == '/')
+    {
+      while (i < len && text[i] != '\n')
+        i++;
+    }
+    else if (c == '/' && i + 1 < len && text[i + 1] == '*')
+    {
+      i += 2;
+      while (i < len && !(text[i] == '*' && i + 1 < len && text[i + 1] == '/'))
+      {
+        if (text[i] == '\n')
+          lineNr++;
+        i++;
+      }
+      i += 2;
+    }
+    // Preprocessor directive?
+    else if (c == '#' && isLineStart)
+    {
+      while (i < len && text[i] != '\n')
+      {
+        // Continues on the next line?
+        if (text[i] == '\\' && i + 1 < len && text[i + 1] == '\n')
+        {
+          lineNr++;
+          i++;
+        }
+        i++;
+      }
+    }
+    else if (c == '"' || c == '\'')
+    {
+      i++;
+      while (i < len && text[i] != c && text[i] != '\n')
+      {
+        if (text[i] == '\\' && i + 1 < len)
+          i++;
+        i++;
+      }
+      if (i < len && text[i] == c)
+        i++;
+      pushToken(Token::STRING, start, i - start, lineNr);
+      isLineStart = false;
+    }
+    else if (('0' <= c && c <= '9') || (c == '.' && i + 1 < len && '0' <= text[i + 1] && text[i + 1] <= '9'))
+    {
+      while (i < len && (isWordChar(text[i]) || text[i] == '.' || text[i] == '\''
+                          || ((text[i] == '+' || text[i] == '-') && (text[i - 1] == 'e' || text[i - 1] == 'E' || text[i - 1] == 'p' || text[i - 1] == 'P'))))
+        i++;
+      pushToken(Token::NUMBER, start, i - start, lineNr);
+      isLineStart = false;
+    }
+    else if (isWordStart(c))
+    {
+      while (i < len && isWordChar(text[i]))
+        i++;
+
+      // A string with a prefix (Eg: L"abc", u8"abc" or R"x(abc)x")?
+      if (i < len && (text[i] == '"' || text[i] == '\''))
+      {
+        bool isRaw = (text[i - 1] == 'R' && text[i] == '"' && i - start <= 3);
+        bool isPrefix = (i - start <= 3);
+        if (isRaw)
+        {
+          // Find the delimiter
+          int delimStart = i + 1;
+          int delimEnd = delimStart;
+          while (delimEnd < len && text[delimEnd] != '(' && text[delimEnd] != '\n' && delimEnd - delimStart < 16)
+            delimEnd++;
+          QByteArray endMark = ")" + m_content.mid(delimStart, delimEnd - delimStart) + "\"";
+          int endIdx = m_content.indexOf(endMark, delimEnd);
+          int stopIdx = (endIdx == -1) ? len : endIdx + endMark.size();
+          for (int j = i; j < stopIdx; j++)
+          {
+            if (text[j] == '\n')
+              lineNr++;
+          }
+          i = stopIdx;
+          pushToken(Token::STRING, start, i - start, lineNr);
+          isLineStart = false;
+          continue;
+        }
+        else if (isPrefix)
+        {
+          unsigned char quote = text[i];
+          i++;
+          while (i < len && text[i] != quote && text[i] != '\n')
+          {
+            if (text[i] == '\\' && i + 1 < len)
+              i++;
+            i++;
+          }
+          if (i < len && text[i] == quote)
+            i++;
+          pushToken(Token::STRING, start, i - start, lineNr);
+          isLineStart = false;
+          continue;
+        }
+      }
+      pushToken(Token::WORD, start, i - start, lineNr);
+      isLineStart = false;
+    }
+    else
+    {
+      // The two character tokens that matters when parsing
+      if ((c == ':' && i + 1 < len && text[i + 1] == ':') || (c == '-' && i + 1 < len && text[i + 1] == '>'))
+        i += 2;
+      else
+        i++;
+      pushToken(Token::PUNCT, start, i - start, lineNr);
+      isLineStart = false;
+    }
+  }
+}
+
+/**
+ * @brief Returns true if the token has a specific text.
+ */
+bool CxxTagScanner::isText(int tokIdx, const char* text) const
+{
+  if (tokIdx < 0 || tokIdx >= m_tokens.size())
+    return false;
+  const Token& tok = m_tokens[tokIdx];
+  return ((int) strlen(text) == tok.m_length && memcmp(m_content.constData() + tok.m_start, text, tok.m_length) == 0);
+}
+
+bool CxxTagScanner::isPunct(int tokIdx, char c) const
+{
+  if (tokIdx < 0 || tokIdx >= m_tokens.size())
+    return false;
+  const Token& tok = m_tokens[tokIdx];
+  return (tok.m_type == Token::PUNCT && tok.m_length == 1 && m_content[tok.m_start] == c);
+}
+
+QString CxxTagScanner::getText(int tokIdx) const
+{
+  const Token& tok = m_tokens[tokIdx];
+  return QString::fromUtf8(m_content.constData() + tok.m_start, tok.m_length);
+}
+
+/**
+ * @brief Skips a '(...)', '[...]' or '{...}' group.
+ * @return The index of the token after the group.
+ */
+int CxxTagScanner::skipGroup(int tokIdx) const
+{
+  int depth = 0;
+  for (; tokIdx < m_tokens.size(); tokIdx++)
+  {
+    if (isPunct(tokIdx, '(') || isPunct(tokIdx, '[') || isPunct(tokIdx, '{'))
+      depth++;
+    else if (isPunct(tokIdx, ')') || isPunct(tokIdx, ']') || isPunct(tokIdx, '}'))
+    {
+      if (--depth <= 0)
+        return tokIdx + 1;
+    }
+  }
+  return tokIdx;
+}
+
+/**
+ * @brief Skips a 'template <...>' prefix.
+ * @return The index of the token after the prefix (or tokIdx if there is no prefix).
+ */
+int CxxTagScanner::skipTemplateParams(int tokIdx) const
+{
+  while (isText(tokIdx, "template") && isPunct(tokIdx + 1, '<'))
+  {
+    int depth = 0;
+    tokIdx++;
+    while (tokIdx < m_tokens.size())
+    {
+      if (isPunct(tokIdx, '('))
+      {
+        tokIdx = skipGroup(tokIdx);
+        continue;
+      }
+      if (isPunct(tokIdx, '<'))
+        depth++;
+      else if (isPunct(tokIdx, '>') && --depth == 0)
+      {
+        tokIdx++;
+        break;
+      }
+      tokIdx++;
+    }
+  }
+  return tokIdx;
+}
+
+/**
+ * @brief Returns the name of the class that is currently being parsed (or an empty string).
+ */
+QString CxxTagScanner::getCurrentClassName() const
+{
+  if (!m_scopes.isEmpty() && m_scopes.last().m_type == Scope::CLASS)
+    return m_scopes.last().m_name;
+  return QString();
+}
+
+void CxxTagScanner::parse(QList<Tag>* taglist)
+{
+  const int tokenCount = m_tokens.size();
+  int stmtStart = 0; //!< The first token of the current statement.
+  int declEnd = -1; //!< The ':' starting a constructor initializer list in the current statement (or -1).
+  int depth = 0; //!< Number of open '(', '[' (and '{' inside those).
+
+  m_scopes.clear();
+
+  int i = 0;
+  while (i < tokenCount)
+  {
+    if (m_tokens[i].m_type != Token::PUNCT)
+    {
+      i++;
+      continue;
+    }
+
+    if (isPunct(i, '(') || isPunct(i, '['))
+      depth++;
+    else if (isPunct(i, ')') || isPunct(i, ']'))
+    {
+      if (depth > 0)
+        depth--;
+    }
+    else if (isPunct(i, '{'))
+    {
+      if (depth > 0)
+        depth++;
+      else
+      {
+        bool endsStatement = true;
+        i = parseBlock(stmtStart, declEnd == -1 ? i : declEnd, i, &endsStatement, taglist);
+        if (endsStatement)
+        {
+          stmtStart = i;
+          declEnd = -1;
+        }
+        continue;
+      }
+    }
+    else if (isPunct(i, '}'))
+    {
+      if (depth > 0)
+        depth--;
+      else
+      {
+        // End of a namespace or class
+        if (!m_scopes.isEmpty())
+          m_scopes.pop_back();
+        stmtStart = i + 1;
+        declEnd = -1;
+      }
+    }
+    else if (isPunct(i, ';') && depth == 0)
+    {
+      parseStatement(stmtStart, i, taglist);
+      stmtStart = i + 1;
+      declEnd = -1;
+    }
+    else if (isPunct(i, ':') && depth == 0 && i > stmtStart)
+    {
+      // Access specifier (Eg: "public:" or "public slots:")?
+      if (isText(i - 1, "public") || isText(i - 1, "private") || isText(i - 1, "protected") || isText(i - 1, "slots") || isText(i - 1, "signals")
+        || isText(i - 1, "Q_SLOTS") || isText(i - 1, "Q_SIGNALS"))
+      {
+        stmtStart = i + 1;
+      }
+      // Constructor initializer list (Eg: "Foo::Foo() : m_a(1), m_b{2} {")?
+      else if (isPunct(i - 1, ')') || isText(i - 1, "noexcept"))
+      {
+        declEnd = i;
+        i++;
+        while (i < tokenCount && !isPunct(i, ';'))
+        {
+          if (isPunct(i, '('))
+            i = skipGroup(i);
+          else if (isPunct(i, '{'))
+          {
+            // Brace initialization of a member or the body of the function?
+            if (m_tokens[i - 1].m_type == Token::WORD || isPunct(i - 1, '>'))
+              i = skipGroup(i);
+            else
+              break;
+          }
+          else
+            i++;
+        }
+        continue;
+      }
+    }
+    i++;
+  }
+}
+
+/**
+ * @brief Handles a statement ending with a '{' (a namespace, class, function or initializer).
+ * @param firstIdx         The first token of the statement.
+ * @param declEndIdx       The token after the declaration (the '{' or the ':' of an initializer list).
+ * @param braceIdx         The '{'.
+ * @param endsStatement    Set to false if the statement continues after the block (Eg: "int a[] = {1, 2};").
+ * @return The index of the next token to parse.
+ */
+int CxxTagScanner::parseBlock(int firstIdx, int declEndIdx, int braceIdx, bool* endsStatement, QList<Tag>* taglist)
+{
+  int declFirst = skipTemplateParams(firstIdx);
+
+  // Namespace?
+  if (isText(declFirst, "namespace") || (isText(declFirst, "inline") && isText(declFirst + 1, "namespace")))
+  {
+    Scope scope;
+    scope.m_type = Scope::NAMESPACE;
+    for (int k = declFirst; k < declEndIdx; k++)
+    {
+      if (m_tokens[k].m_type == Token::WORD && !isText(k, "namespace") && !isText(k, "inline"))
+        scope.m_name = getText(k);
+    }
+    m_scopes.append(scope);
+    return braceIdx + 1;
+  }
+
+  // extern "C" { ?
+  if (isText(declFirst, "extern") && declFirst + 1 < declEndIdx && m_tokens[declFirst + 1].m_type == Token::STRING && declFirst + 2 == declEndIdx)
+  {
+    Scope scope;
+    scope.m_type = Scope::NAMESPACE;
+    m_scopes.append(scope);
+    return braceIdx + 1;
+  }
+
+  // Look for a class keyword or a parameter list
+  int parenCount = 0;
+  int classKeywordIdx = -1;
+  int funcNameIdx = -1;
+  int funcParenIdx = -1;
+  bool isEnum = false;
+  for (int k = declFirst; k < declEndIdx;)
+  {
+    if (isPunct(k, '('))
+    {
+      parenCount++;
+
+      // Operator (Eg: "operator==(" or "operator()(")?
+      int opIdx = -1;
+      for (int j = k - 1; j >= declFirst && j >= k - 4; j--)
+      {
+        if (isText(j, "operator"))
+          opIdx = j;
+      }
+      if (opIdx != -1)
+      {
+        funcNameIdx = opIdx;
+        if (opIdx == k - 1 && isPunct(k + 1, ')') && isPunct(k + 2, '('))
+          k += 2;
+        funcParenIdx = k;
+      }
+      else if (k - 1 >= declFirst && m_tokens[k - 1].m_type == Token::WORD)
+      {
+        bool isFuncName = true;
+        for (int n = 0; g_notFuncNames[n] && isFuncName; n++)
+        {
+          if (isText(k - 1, g_notFuncNames[n]))
+            isFuncName = false;
+        }
+        if (isFuncName)
+        {
+          funcNameIdx = k - 1;
+          funcParenIdx = k;
+        }
+      }
+      k = skipGroup(k);
+      continue;
+    }
+    else if (isPunct(k, '[') || isPunct(k, '{'))
+    {
+      k = skipGroup(k);
+      continue;
+    }
+    else if (parenCount == 0 && classKeywordIdx == -1 && !isEnum)
+    {
+      if (isText(k, "enum"))
+        isEnum = true;
+      else if (isText(k, "class") || isText(k, "struct") || isText(k, "union"))
+        classKeywordIdx = k;
+    }
+    k++;
+  }
+
+  // Enum?
+  if (isEnum && parenCount == 0)
+  {
+    *endsStatement = false;
+    return skipGroup(braceIdx);
+  }
+
+  // Class, struct or union?
+  if (classKeywordIdx != -1 && parenCount == 0)
+  {
+    addClass(classKeywordIdx, declEndIdx, taglist);
+    return braceIdx + 1;
+  }
+
+  // Function?
+  if (funcNameIdx != -1)
+  {
+    addFunction(funcNameIdx, funcParenIdx, taglist);
+    return skipGroup(braceIdx);
+  }
+
+  // An initializer (Eg: "int a[] = {1, 2}") or something unknown
+  *endsStatement = false;
+  return skipGroup(braceIdx);
+}
+
+/**
+ * @brief Handles a statement ending with a ';' (looks for global variables).
+ */
+void CxxTagScanner::parseStatement(int firstIdx, int endIdx, QList<Tag>* taglist)
+{
+  // Only variables outside classes and functions are of interest
+  if (!m_scopes.isEmpty() && m_scopes.last().m_type == Scope::CLASS)
+    return;
+
+  int declFirst = skipTemplateParams(firstIdx);
+  if (declFirst != firstIdx || declFirst >= endIdx)
+    return;
+  if (isText(declFirst, "typedef") || isText(declFirst, "using") || isText(declFirst, "extern") || isText(declFirst, "friend") || isText(declFirst, "static_assert")
+    || isText(declFirst, "namespace") || isText(declFirst, "return"))
+    return;
+
+  // Find the name of each declarator (the last word before a '=', '[', ',', ':' or the end)
+  int declaratorStart = declFirst;
+  int nameIdx = -1;
+  bool skipRest = false; //!< True while in an initializer.
+  for (int k = declFirst; k <= endIdx; k++)
+  {
+    bool isEnd = (k == endIdx || isPunct(k, ','));
+    if (isEnd)
+    {
+      // Is the name not just a type (Eg: "struct Foo;")?
+      if (nameIdx != -1 && (nameIdx > declFirst || declaratorStart != declFirst) && !isText(nameIdx - 1, "struct") && !isText(nameIdx - 1, "class")
+        && !isText(nameIdx - 1, "union") && !isText(nameIdx - 1, "enum"))
+      {
+        bool isName = true;
+        for (int n = 0; g_notVarNames[n] && isName; n++)
+        {
+          if (isText(nameIdx, g_notVarNames[n]))
+            isName = false;
+        }
+        if (isName)
+        {
+          Tag tag;
+          tag.setLineNo(m_tokens[nameIdx].m_lineNr);
+          tag.m_name = getText(nameIdx);
+          tag.m_filepath = m_filepath;
+          tag.m_type = Tag::TAG_VARIABLE;
+          debugMsg("found variable: '%s' at L%d", qPrintable(tag.m_name), tag.getLineNo());
+          taglist->append(tag);
+        }
+      }
+      declaratorStart = k + 1;
+      nameIdx = -1;
+      skipRest = false;
+      continue;
+    }
+
+    if (isPunct(k, '('))
+    {
+      // A function declaration or a macro (Eg: "void foo(int a);")
+      if (!skipRest)
+        return;
+      k = skipGroup(k) - 1;
+    }
+    else if (isPunct(k, '['))
+    {
+      k = skipGroup(k) - 1;
+      skipRest = true;
+    }
+    else if (isPunct(k, '{'))
+      k = skipGroup(k) - 1;
+    else if (isPunct(k, '=') || isPunct(k, ':'))
+      skipRest = true;
+    else if (!skipRest && m_tokens[k].m_type == Token::WORD)
+      nameIdx = k;
+    else if (!skipRest && isPunct(k, '<'))
+    {
+      // Skip template arguments (Eg: "QList<int> g_list;")
+      int angleDepth = 0;
+      for (; k < endIdx; k++)
+      {
+        if (isPunct(k, '<'))
+          angleDepth++;
+        else if (isPunct(k, '>') && --angleDepth == 0)
+          break;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Adds a tag for a function.
+ * @param nameIdx    The name of the function.
+ * @param parenIdx   The '(' of the parameter list.
+ */
+void CxxTagScanner::addFunction(int nameIdx, int parenIdx, QList<Tag>* taglist)
+{
+  Tag tag;
+  tag.setLineNo(m_tokens[nameIdx].m_lineNr);
+  tag.m_filepath = m_filepath;
+  tag.m_type = Tag::TAG_FUNC;
+
+  // Get the name
+  int qualifierIdx = nameIdx - 1;
+  if (isText(nameIdx, "operator"))
+  {
+    tag.m_name = "operator";
+    for (int k = nameIdx + 1; k < parenIdx; k++)
+    {
+      if (m_tokens[k].m_type == Token::WORD)
+        tag.m_name += " ";
+      tag.m_name += getText(k);
+    }
+  }
+  else if (isPunct(nameIdx - 1, '~'))
+  {
+    tag.m_name = "~" + getText(nameIdx);
+    qualifierIdx = nameIdx - 2;
+  }
+  else
+    tag.m_name = getText(nameIdx);
+
+  // Get the class (Eg: "Foo::bar()" or "Foo<T>::bar()")
+  if (isText(qualifierIdx, "::"))
+  {
+    int k = qualifierIdx - 1;
+    if (isPunct(k, '>'))
+    {
+      int angleDepth = 0;
+      for (; k >= 0; k--)
+      {
+        if (isPunct(k, '>'))
+          angleDepth++;
+        else if (isPunct(k, '<') && --angleDepth == 0)
+          break;
+      }
+      k--;
+    }
+    if (k >= 0 && m_tokens[k].m_type == Token::WORD)
+      tag.m_className = getText(k);
+  }
+  else
+    tag.m_className = getCurrentClassName();
+
+  // Get the signature
+  QString signature;
+  int endIdx = skipGroup(parenIdx);
+  for (int k = parenIdx; k < endIdx; k++)
+  {
+    const Token& tok = m_tokens[k];
+    if (k > parenIdx && tok.m_type != Token::PUNCT && (m_tokens[k - 1].m_type != Token::PUNCT || isPunct(k - 1, '*') || isPunct(k - 1, '&')))
+      signature += " ";
+    signature += getText(k);
+    if (isPunct(k, ','))
+      signature += " ";
+  }
+  tag.setSignature(signature);
+
+  debugMsg("found function: '%s::%s%s' at L%d", qPrintable(tag.m_className), qPrintable(tag.m_name), qPrintable(signature), tag.getLineNo());
+  taglist->append(tag);
+}
+
+/**
+ * @brief Adds a tag for a class, struct or union and enters its scope.
+ * @param keywordIdx   The 'class', 'struct' or 'union' keyword.
+ * @param endIdx       The '{' (or the ':' before the base classes).
+ */
+void CxxTagScanner::addClass(int keywordIdx, int endIdx, QList<Tag>* taglist)
+{
+  Scope scope;
+  scope.m_type = Scope::CLASS;
+
+  // The name is the last word before the base class list (Eg: "class EXPORT Foo final : public Bar")
+  int nameIdx = -1;
+  int angleDepth = 0;
+  for (int k = keywordIdx + 1; k < endIdx; k++)
+  {
+    if (isPunct(k, ':'))
+      break;
+    if (isPunct(k, '('))
+      k = skipGroup(k) - 1;
+    else if (isPunct(k, '<'))
+      angleDepth++;
+    else if (isPunct(k, '>'))
+      angleDepth--;
+    else if (angleDepth == 0 && m_tokens[k].m_type == Token::WORD && !isText(k, "final"))
+      nameIdx = k;
+  }
+
+  if (nameIdx != -1)
+  {
+    Tag tag;
+    tag.setLineNo(m_tokens[nameIdx].m_lineNr);
+    tag.m_name = getText(nameIdx);
+    tag.m_className = getCurrentClassName();
+    tag.m_filepath = m_filepath;
+    tag.m_type = Tag::TAG_CLASS;
+    debugMsg("found class: '%s' at L%d", qPrintable(tag.m_name), tag.getLineNo());
+    taglist->append(tag);
+
+    scope.m_name = tag.m_name;
+  }
+
+  m_scopes.append(scope);
+}
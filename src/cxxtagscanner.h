@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018-2020 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__CXXTAGSCANNER_H
+#define FILE__CXXTAGSCANNER_H
+
+#include "tagscanner.h"
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief Tag scanner for the C and C++ languages.
+ *
+ * This class scans a C/C++ file (without running any external program) and extracts
+ * the functions, methods, classes, structs and global variables from it.
+ * The file is tokenized as bytes and the tokens refer to the file content to avoid any string copies.
+ */
+class CxxTagScanner
+{
+public:
+  CxxTagScanner();
+  virtual ~CxxTagScanner();
+
+  int scan(QString filepath, QList<Tag>* taglist);
+  int scanBuffer(QString filepath, const QByteArray& content, QList<Tag>* taglist);
+
+  static bool isCxxFile(QString filepath);
+
+private:
+  class Token
+  {
+  public:
+    typedef enum
+    {
+      WORD,
+      NUMBER,
+      STRING,
+      PUNCT
+    } Type;
+
+    Type m_type;
+    int m_start; //!< Offset of the token in the file content.
+    int m_length;
+    int m_lineNr;
+  };
+
+  struct Scope
+  {
+    enum
+    {
+      NAMESPACE, //!< A namespace or an extern "C" block.
+      CLASS //!< A class, struct or union.
+    } m_type;
+    QString m_name;
+  };
+
+  void tokenize();
+  void parse(QList<Tag>* taglist);
+
+  void pushToken(Token::Type type, int start, int length, int lineNr);
+  bool isText(int tokIdx, const char* text) const;
+  bool isPunct(int tokIdx, char c) const;
+  QString getText(int tokIdx) const;
+  int skipGroup(int tokIdx) const;
+  int skipTemplateParams(int tokIdx) const;
+
+  void parseStatement(int firstIdx, int endIdx, QList<Tag>* taglist);
+  int parseBlock(int firstIdx, int declEndIdx, int braceIdx, bool* endsStatement, QList<Tag>* taglist);
+  void addFunction(int nameIdx, int parenIdx, QList<Tag>* taglist);
+  void addClass(int keywordIdx, int endIdx, QList<Tag>* taglist);
+  QString getCurrentClassName() const;
+
+private:
+  QString m_filepath;
+  QByteArray m_content;
+  QVector<Token> m_tokens;
+  QVector<Scope> m_scopes;
+};
+
+#endif // FILE__CXXTAGSCANNER_H
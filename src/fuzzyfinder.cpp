@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+//#define ENABLE_DEBUGMSG
+
+#include "fuzzyfinder.h"
+
+#include "config.h"
+#include "log.h"
+
+#include <QElapsedTimer>
+#include <string.h>
+
+// Score of each matched character and the bonuses
+#define SCORE_MATCH 16
+#define BONUS_WORD_START 8
+#define BONUS_FIRST_CHAR 8
+#define BONUS_CONSECUTIVE 8
+#define PENALTY_GAP_START 3
+#define PENALTY_GAP 1
+
+// Number of names to search before checking if the search has been replaced by a new one
+#define SEARCH_CHUNK_SIZE 4096
+
+// Min time (ms) between two handovers of the results found so far
+#define PUBLISH_INTERVAL 10
+
+FuzzyIndex::FuzzyIndex(QStringList names)
+  : m_names(names)
+  , m_isBuilt(false)
+{
+}
+
+/**
+ * @brief Creates the lowercased text searched by match() (does nothing if it already exists).
+ */
+void FuzzyIndex::build()
+{
+  QMutexLocker locker(&m_buildMutex);
+  if (m_isBuilt)
+    return;
+
+  m_offsets.reserve(m_names.size() + 1);
+  m_offsets.append(0);
+  for (int i = 0; i < m_names.size(); i++)
+    addText(m_names[i]);
+  m_isBuilt = true;
+}
+
+static inline bool isAlnum(char c)
+{
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || (c & 0x80);
+}
+
+/**
+ * @brief Appends the searched text of a name.
+ */
+void FuzzyIndex::addText(QString name)
+{
+  // Lowercased the same way as the query (see FuzzyFinder::search())
+  QByteArray text = name.toLower().toUtf8();
+  QByteArray orgText = name.toUtf8();
+  if (orgText.size() != text.size())
+    orgText = text; // A character got a longer or shorter encoding (only the word separators are used then)
+  QByteArray flags(text.size(), 0);
+
+  // Find the start of the words (Eg: "my_func", "MyFunc" or "file.cpp")
+  for (int i = 0; i < orgText.size(); i++)
+  {
+    char c = orgText[i];
+    if (i == 0)
+      flags[i] = 1;
+    else if (isAlnum(c) && !isAlnum(orgText[i - 1]))
+      flags[i] = 1;
+    else if ('A' <= c && c <= 'Z' && 'a' <= orgText[i - 1] && orgText[i - 1] <= 'z')
+      flags[i] = 1;
+  }
+
+  m_text.append(text);
+  m_flags.append(flags);
+  m_offsets.append(m_text.size());
+}
+
+/**
+ * @brief Checks if a name matches a query.
+ * Must not be called before build().
+ * @param query    The lowercased query (UTF-8).
+ * @return true if all characters in the query is found (in order) in the name.
+ */
+bool FuzzyIndex::match(const QByteArray& query, int idx, int* score) const
+{
+  int start = m_offsets[idx];
+  int len = m_offsets[idx + 1] - start;
+  return matchText(query.constData(), query.size(), m_text.constData() + start, m_flags.constData() + start, len, score);
+}
+
+/**
+ * @brief Matches a query against a text and scores the match.
+ * Matches at the start of words and consecutive matches give a higher score and gaps a lower.
+ * @param flags   Non zero for each character in text that starts a word.
+ * @return true if the query is a subsequence of the text.
+ */
+bool FuzzyIndex::matchText(const char* query, int queryLen, const char* text, const char* flags, int textLen, int* score)
+{
+  // Is the query a subsequence of the text?
+  const char* p = text;
+  const char* end = text + textLen;
+  for (int qi = 0; qi < queryLen; qi++)
+  {
+    p = (const char*) memchr(p, query[qi], end - p);
+    if (!p)
+      return false;
+    p++;
+  }
+
+  if (queryLen == 0)
+  {
+    *score = -(textLen >> 3);
+    return true;
+  }
+
+  // Find the shortest match ending at the last matched character
+  int lastIdx = (int) (p - text) - 1;
+  int firstIdx = lastIdx;
+  int qi = queryLen - 1;
+  for (int i = lastIdx; i >= 0; i--)
+  {
+    if (text[i] == query[qi])
+    {
+      firstIdx = i;
+      if (--qi < 0)
+        break;
+    }
+  }
+
+  // Score it
+  int sum = 0;
+  int prevMatchIdx = -2;
+  bool inGap = false;
+  qi = 0;
+  for (int i = firstIdx; i <= lastIdx && qi < queryLen; i++)
+  {
+    if (text[i] == query[qi])
+    {
+      sum += SCORE_MATCH;
+      if (flags[i])
+        sum += BONUS_WORD_START;
+      if (i == 0)
+        sum += BONUS_FIRST_CHAR;
+      if (prevMatchIdx == i - 1)
+        sum += BONUS_CONSECUTIVE;
+      prevMatchIdx = i;
+      inGap = false;
+      qi++;
+    }
+    else
+    {
+      sum -= inGap ? PENALTY_GAP : PENALTY_GAP_START;
+      inGap = true;
+    }
+  }
+
+  // Prefer short names
+  *score = sum - (textLen >> 3);
+  return true;
+}
+
+FuzzyFinder::FuzzyFinder(QObject* receiver)
+  : m_receiver(receiver)
+  , m_searchId(0)
+  , m_quit(false)
+  , m_resultsId(0)
+  , m_resultsDone(false)
+  , m_notifyPending(false)
+{
+}
+
+FuzzyFinder::~FuzzyFinder()
+{
+  m_mutex.lock();
+  m_quit = true;
+  m_cond.wakeAll();
+  m_mutex.unlock();
+
+  wait();
+}
+
+/**
+ * @brief Starts a new search (the previous search is aborted).
+ * @return The id of the search (see takeResults()).
+ */
+int FuzzyFinder::search(QSharedPointer<FuzzyIndex> index, QString query)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_index = index;
+  m_query = query.toLower().toUtf8();
+  int searchId = m_searchId.load() + 1;
+  m_searchId.store(searchId);
+  m_cond.wakeAll();
+
+  debugMsg("Starting search %d for '%s'", searchId, qPrintable(query));
+  return searchId;
+}
+
+/**
+ * @brief Takes the best matches found so far (sorted with the best first).
+ * @return true if the search is done.
+ */
+bool FuzzyFinder::takeResults(int* searchId, QVector<FuzzyMatch>* matchList)
+{
+  QMutexLocker locker(&m_mutex);
+
+  *searchId = m_resultsId;
+  *matchList = m_results;
+  m_notifyPending = false;
+  return m_resultsDone;
+}
+
+void FuzzyFinder::run()
+{
+  int doneId = 0;
+  for (;;)
+  {
+    m_mutex.lock();
+    while (!m_quit && m_searchId.load() == doneId)
+      m_cond.wait(&m_mutex);
+    if (m_quit)
+    {
+      m_mutex.unlock();
+      return;
+    }
+    int searchId = m_searchId.load();
+    QSharedPointer<FuzzyIndex> index = m_index;
+    QByteArray query = m_query;
+    m_mutex.unlock();
+
+    searchAll(searchId, index, query);
+    doneId = searchId;
+  }
+}
+
+void FuzzyFinder::searchAll(int searchId, QSharedPointer<FuzzyIndex> index, QByteArray query)
+{
+  QVector<FuzzyMatch> bestList;
+  bestList.reserve(GOTO_MAX_FUZZY_RESULTS + 1);
+  bool isChanged = false;
+  QElapsedTimer timer;
+  timer.start();
+
+  if (index)
+    index->build();
+  const int count = index ? index->getCount() : 0;
+  for (int idx = 0; idx < count; idx++)
+  {
+    if (idx % SEARCH_CHUNK_SIZE == 0 && idx != 0)
+    {
+      // Replaced by a new search?
+      if (m_searchId.load() != searchId)
+        return;
+
+      // Show what has been found so far
+      if (isChanged && timer.elapsed() >= PUBLISH_INTERVAL)
+      {
+        publish(searchId, bestList, false);
+        isChanged = false;
+        timer.restart();
+      }
+    }
+
+    FuzzyMatch m;
+    if (!index->match(query, idx, &m.m_score))
+      continue;
+    if (bestList.size() == GOTO_MAX_FUZZY_RESULTS && m.m_score <= bestList.last().m_score)
+      continue;
+    m.m_idx = idx;
+
+    // Insert it sorted by the score
+    int pos = bestList.size();
+    while (pos > 0 && bestList[pos - 1].m_score < m.m_score)
+      pos--;
+    bestList.insert(pos, m);
+    if (bestList.size() > GOTO_MAX_FUZZY_RESULTS)
+      bestList.removeLast();
+    isChanged = true;
+  }
+
+  debugMsg("Search %d done in %lld ms", searchId, (long long) timer.elapsed());
+  publish(searchId, bestList, true);
+}
+
+/**
+ * @brief Hands over the results to the receiver.
+ */
+void FuzzyFinder::publish(int searchId, const QVector<FuzzyMatch>& matchList, bool isDone)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_results = matchList;
+  m_resultsId = searchId;
+  m_resultsDone = isDone;
+
+  // Only one call is queued until the results has been taken
+  if (!m_notifyPending)
+  {
+    m_notifyPending = true;
+    QMetaObject::invokeMethod(m_receiver, "onFuzzyResults", Qt::QueuedConnection);
+  }
+}
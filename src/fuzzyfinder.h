@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__FUZZYFINDER_H
+#define FILE__FUZZYFINDER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+/**
+ * @brief The names (files and tags) searched by a FuzzyFinder.
+ * The lowercased names are stored one after the other in a single array to make a search a linear scan through memory.
+ * That array is built by build() in the thread of the FuzzyFinder, so creating an index only copies the name list.
+ */
+class FuzzyIndex
+{
+public:
+  FuzzyIndex(QStringList names);
+
+  void build();
+
+  int getCount() const
+  {
+    return m_names.size();
+  };
+  QString getName(int idx) const
+  {
+    return m_names[idx];
+  };
+
+  bool match(const QByteArray& query, int idx, int* score) const;
+
+  static bool matchText(const char* query, int queryLen, const char* text, const char* flags, int textLen, int* score);
+
+private:
+  void addText(QString name);
+
+private:
+  QStringList m_names; //!< The names as they are shown.
+  QMutex m_buildMutex; //!< Protects the members below.
+  bool m_isBuilt;
+  QByteArray m_text; //!< The lowercased names (UTF-8).
+  QByteArray m_flags; //!< One byte for each byte in m_text (non zero if it starts a word).
+  QVector<int> m_offsets; //!< Where each name starts in m_text (with an extra entry for the end of the last one).
+};
+
+struct FuzzyMatch
+{
+  int m_idx; //!< Index in the FuzzyIndex.
+  int m_score;
+};
+
+/**
+ * @brief Searches a FuzzyIndex in a separate thread.
+ * The best matches found so far are handed over to the receiver while the search is running.
+ */
+class FuzzyFinder : public QThread
+{
+  Q_OBJECT
+
+public:
+  FuzzyFinder(QObject* receiver);
+  virtual ~FuzzyFinder();
+
+  int search(QSharedPointer<FuzzyIndex> index, QString query);
+  bool takeResults(int* searchId, QVector<FuzzyMatch>* matchList);
+
+  void run();
+
+private:
+  void searchAll(int searchId, QSharedPointer<FuzzyIndex> index, QByteArray query);
+  void publish(int searchId, const QVector<FuzzyMatch>& matchList, bool isDone);
+
+private:
+  QObject* m_receiver; //!< Its onFuzzyResults() slot is invoked (queued) when there are results to take.
+  QAtomicInt m_searchId; //!< Id of the latest search.
+
+  QMutex m_mutex; //!< Protects the members below.
+  QWaitCondition m_cond;
+  QSharedPointer<FuzzyIndex> m_index;
+  QByteArray m_query;
+  bool m_quit;
+  QVector<FuzzyMatch> m_results; //!< The best matches of the search with id m_resultsId.
+  int m_resultsId;
+  bool m_resultsDone; //!< True if the search with id m_resultsId is done.
+  bool m_notifyPending; //!< True if onFuzzyResults() has been queued but not yet called takeResults().
+};
+
+#endif // FILE__FUZZYFINDER_H
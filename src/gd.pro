@@ -8,12 +8,10 @@ else {
 
 
 TEMPLATE = app
+CONFIG += c++14
 
 SOURCES+=gd.cpp
 
-SOURCES+=parsecharqueue.cpp
-HEADERS+=parsecharqueue.h
-
 SOURCES+=mainwindow.cpp
 HEADERS+=mainwindow.h
 
@@ -24,7 +22,7 @@ SOURCES+=gdbmiparser.cpp core.cpp
 HEADERS+=gdbmiparser.h core.h
 
 SOURCES+=com.cpp
-HEADERS+=com.h
+HEADERS+=com.h spscring.h
 
 SOURCES+=log.cpp
 HEADERS+=log.h
@@ -60,12 +58,15 @@ HEADERS+=opendialog.h
 SOURCES+=settings.cpp
 HEADERS+=settings.h
 
-SOURCES+=tagscanner.cpp tagmanager.cpp
-HEADERS+=tagscanner.h   tagmanager.h
+SOURCES+=tagscanner.cpp tagmanager.cpp tagindex.cpp symbolindex.cpp
+HEADERS+=tagscanner.h   tagmanager.h tagindex.h symbolindex.h
 
 SOURCES+=rusttagscanner.cpp
 HEADERS+=rusttagscanner.h
 
+SOURCES+=cxxtagscanner.cpp
+HEADERS+=cxxtagscanner.h
+
 HEADERS+=config.h
 
 SOURCES+=varctl.cpp watchvarctl.cpp autovarctl.cpp
@@ -83,8 +84,8 @@ SOURCES+=codeviewtab.cpp
 HEADERS+=codeviewtab.h
 FORMS += codeviewtab.ui
 
-SOURCES+=memorydialog.cpp memorywidget.cpp
-HEADERS+=memorydialog.h memorywidget.h
+SOURCES+=memorydialog.cpp memorywidget.cpp memorycache.cpp
+HEADERS+=memorydialog.h memorywidget.h memorycache.h
 FORMS += memorydialog.ui
 
 SOURCES += processlistdialog.cpp
@@ -116,6 +117,18 @@ FORMS+=gotodialog.ui
 SOURCES+=locator.cpp
 HEADERS+=locator.h
 
+SOURCES+=fuzzyfinder.cpp
+HEADERS+=fuzzyfinder.h
+
+SOURCES+=taglistmodel.cpp
+HEADERS+=taglistmodel.h
+
+SOURCES+=lazyhighlighter.cpp
+HEADERS+=lazyhighlighter.h
+
+SOURCES+=keywordset.cpp
+HEADERS+=keywordset.h
+
 RESOURCES += resource.qrc
 
 #QMAKE_CXXFLAGS += -I./  -g
@@ -20,17 +20,19 @@
 #include <QLineEdit>
 #include <QProcess>
 
-#define MAX_TAGS 2000
-
 GoToDialog::GoToDialog(QWidget* parent, Locator* locator, Settings* cfg, QString currentFilename)
   : QDialog(parent)
   , m_currentFilename(currentFilename)
   , m_locator(locator)
+  , m_finder(this)
+  , m_fuzzySearchId(-1)
 {
   Q_UNUSED(cfg);
 
   m_ui.setupUi(this);
 
+  m_finder.start();
+
   connect(m_ui.pushButton, SIGNAL(clicked()), SLOT(onGo()));
 
   connect(m_ui.comboBox, SIGNAL(editTextChanged(const QString&)), SLOT(onSearchTextEdited(const QString&)));
@@ -109,6 +111,23 @@ void GoToDialog::onComboBoxTabKey()
     lineEdit->setCursorPosition(pos);
   }
 
+  // Showing fuzzy matches? Then complete with the files and functions that start with the text instead.
+  if (m_fuzzySearchId != -1)
+  {
+    m_fuzzySearchId = -1;
+
+    QStringList fields = getTextLeftToCursor(m_ui.comboBox).split(" ");
+    QStringList nameList = m_locator->searchExpression(fields.last());
+    m_ui.listWidget->clear();
+    for (int i = 0; i < qMin(nameList.size(), GOTO_MAX_TAGS); i++)
+    {
+      QListWidgetItem* item = new QListWidgetItem(nameList[i]);
+      item->setSizeHint(QSize(GOTO_LISTWIDGET_ITEM_WIDTH, 20));
+      m_ui.listWidget->addItem(item);
+    }
+    m_ui.listWidget->sortItems(Qt::AscendingOrder);
+  }
+
   if (m_ui.listWidget->count() == 1)
   {
     // Simulate a click on the item
@@ -256,6 +275,7 @@ void GoToDialog::onSearchTextEdited(const QString& text2)
   debugMsg("%s('%s')", __func__, qPrintable(text));
 
   m_ui.listWidget->clear();
+  m_fuzzySearchId = -1;
 
   // Get the last expression
   QStringList expList = text.split(' ');
@@ -322,15 +342,22 @@ void GoToDialog::onSearchTextEdited(const QString& text2)
   }
   expr = expList.last();
 
-  // Ask the locator for files and tags that match
-  QStringList exprList;
+  // Search for files and functions in the background (see onFuzzyResults())
   if (showSuggestion == SHOW_FUNC_AND_FILE)
-    exprList = m_locator->searchExpression(expr);
-  else if (showSuggestion == SHOW_FUNC)
+  {
+    m_fuzzyIndex = m_locator->getFuzzyIndex();
+    m_fuzzySearchId = m_finder.search(m_fuzzyIndex, expr);
+    showListWidget(true);
+    return;
+  }
+
+  // Ask the locator for tags that match
+  QStringList exprList;
+  if (showSuggestion == SHOW_FUNC)
     exprList = m_locator->searchExpression(expList[0], expr);
 
   // Add the found ones to to the list
-  for (int i = 0; i < qMin(exprList.size(), MAX_TAGS); i++)
+  for (int i = 0; i < qMin(exprList.size(), GOTO_MAX_TAGS); i++)
   {
     QString fieldText = exprList[i];
     QListWidgetItem* item = new QListWidgetItem(fieldText);
@@ -345,6 +372,27 @@ void GoToDialog::onSearchTextEdited(const QString& text2)
     showListWidget(true);
 }
 
+/**
+ * @brief Called when the fuzzy search has found (more) files or functions.
+ */
+void GoToDialog::onFuzzyResults()
+{
+  int searchId;
+  QVector<FuzzyMatch> matchList;
+  m_finder.takeResults(&searchId, &matchList);
+  if (searchId != m_fuzzySearchId)
+    return;
+
+  // Show them with the best match first
+  m_ui.listWidget->clear();
+  for (int i = 0; i < matchList.size(); i++)
+  {
+    QListWidgetItem* item = new QListWidgetItem(m_fuzzyIndex->getName(matchList[i].m_idx));
+    item->setSizeHint(QSize(GOTO_LISTWIDGET_ITEM_WIDTH, 20));
+    m_ui.listWidget->addItem(item);
+  }
+}
+
 /**
  * @brief Returns the file and linenumber the user wants to go to.
  */
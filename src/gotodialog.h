@@ -9,6 +9,7 @@
 #ifndef FILE__GOTODIALOG_H
 #define FILE__GOTODIALOG_H
 
+#include "fuzzyfinder.h"
 #include "locator.h"
 #include "settings.h"
 #include "ui_gotodialog.h"
@@ -33,6 +34,9 @@ public slots:
   void onSearchTextEdited(const QString& text);
   void onItemClicked(QListWidgetItem* item);
 
+private slots:
+  void onFuzzyResults();
+
 private:
   void showListWidget(bool show);
   bool eventFilter(QObject* obj, QEvent* event);
@@ -45,6 +49,9 @@ private:
   Ui_GoToDialog m_ui;
   QString m_currentFilename;
   Locator* m_locator;
+  FuzzyFinder m_finder;
+  QSharedPointer<FuzzyIndex> m_fuzzyIndex; //!< The index searched by the current fuzzy search.
+  int m_fuzzySearchId; //!< Id of the current fuzzy search (or -1).
 };
 
 #endif // FILE__GOTODIALOG_H
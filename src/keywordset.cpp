@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#include "keywordset.h"
+
+/**
+ * @brief Returns the words in the set (in no particular order).
+ */
+QStringList KeywordSet::toStringList() const
+{
+  QStringList list;
+  for (quint32 slot = 0; slot < m_tableSize; slot++)
+  {
+    if (m_words[slot] != NULL)
+      list += QString::fromLatin1(m_words[slot], m_lengths[slot]);
+  }
+  return list;
+}
+
+// The keyword tables below are built by the compiler
+
+static constexpr const char* g_cppWordList[] = {
+  "#", "if", "else", "def", "defined", "define", "ifdef", "endif", "ifndef", "include",
+  "error", "elif", "warning"
+};
+static constexpr auto g_cppTable = makeKeywordTable(g_cppWordList);
+static_assert(g_cppTable.m_isValid, "No perfect hash found for the C preprocessor keywords");
+const KeywordSet g_cppKeywords(g_cppTable, true);
+
+static constexpr const char* g_cxxWordList[] = {
+  "if", "for", "while", "switch", "case", "else", "do", "false", "true", "default",
+  "sizeof", "typedef",
+  "enum", "unsigned", "bool", "int", "short", "long", "float", "double", "void", "char",
+  "struct",
+  "class", "static", "volatile", "new", "const",
+  "return", "break", "continue",
+  "uint32_t", "uint16_t", "uint8_t", "int32_t", "int16_t", "int8_t",
+  "quint32", "quint16", "quint8", "qint32", "qint16", "qint8"
+};
+static constexpr auto g_cxxTable = makeKeywordTable(g_cxxWordList);
+static_assert(g_cxxTable.m_isValid, "No perfect hash found for the C and C++ keywords");
+const KeywordSet g_cxxKeywords(g_cxxTable, true);
+
+static constexpr const char* g_goWordList[] = {
+  "break", "case", "chan", "const", "continue", "default", "defer", "else", "fallthrough",
+  "for", "func", "go", "goto", "if", "import", "interface", "map", "package", "range",
+  "return", "select", "struct", "switch", "type", "var"
+};
+static constexpr auto g_goTable = makeKeywordTable(g_goWordList);
+static_assert(g_goTable.m_isValid, "No perfect hash found for the Go keywords");
+const KeywordSet g_goKeywords(g_goTable, true);
+
+static constexpr const char* g_adaWordList[] = {
+  "if", "loop", "for", "begin", "end", "then", "return",
+  "with", "use", "in", "is", "of",
+  "procedure", "function",
+  "pragma", "renames", "import",
+  "integer", "array", "string", "character", "natural"
+};
+static constexpr auto g_adaTable = makeKeywordTable(g_adaWordList);
+static_assert(g_adaTable.m_isValid, "No perfect hash found for the Ada keywords");
+const KeywordSet g_adaKeywords(g_adaTable, false);
+const KeywordSet g_adaTagKeywords(g_adaTable, true);
+
+static constexpr const char* g_rustWordList[] = {
+  "as", "break", "const", "continue", "crate", "else", "enum", "extern", "false", "fn",
+  "for", "if", "impl", "in", "let", "loop", "match", "mod", "move", "mut", "pub", "ref",
+  "return", "self", "static", "struct", "super", "trait", "true", "type", "unsafe", "use",
+  "where", "while", "yield",
+  "println", "println!",
+  "i64", "i32", "i8", "i16", "u64", "u32", "u8", "u16", "f32", "f64",
+  "bool"
+};
+static constexpr auto g_rustTable = makeKeywordTable(g_rustWordList);
+static_assert(g_rustTable.m_isValid, "No perfect hash found for the Rust keywords");
+const KeywordSet g_rustKeywords(g_rustTable, true);
+
+static constexpr const char* g_basicWordList[] = {
+  "print", "input", "sleep", "return",
+  "do", "loop", "until", "declare", "select", "case",
+  "cls", "function", "sub", "as", "end", "dim",
+  "byte", "const", "double", "enum", "integer", "long", "longint", "short", "string",
+  "ubyte", "uinteger", "ulongint", "union", "unsigned", "ushort", "wstring", "zstring"
+};
+static constexpr auto g_basicTable = makeKeywordTable(g_basicWordList);
+static_assert(g_basicTable.m_isValid, "No perfect hash found for the Basic keywords");
+const KeywordSet g_basicKeywords(g_basicTable, false);
+
+static constexpr const char* g_fortranWordList[] = {
+  "print",
+  "subroutine", "program",
+  "end", "call",
+  "real"
+};
+static constexpr auto g_fortranTable = makeKeywordTable(g_fortranWordList);
+static_assert(g_fortranTable.m_isValid, "No perfect hash found for the Fortran keywords");
+const KeywordSet g_fortranKeywords(g_fortranTable, false);
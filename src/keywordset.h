@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__KEYWORDSET_H
+#define FILE__KEYWORDSET_H
+
+#include <QChar>
+#include <QString>
+#include <QStringList>
+
+// Number of seeds to try for a bucket before giving up (see makeKeywordTable())
+#define KEYWORDSET_MAX_SEED 10000
+
+/**
+ * @brief Returns the code of a character (in a QString or a Latin-1/UTF-8 string).
+ */
+inline constexpr quint32 keywordCharCode(char c)
+{
+  return (unsigned char) c;
+}
+inline constexpr quint32 keywordCharCode(QChar c)
+{
+  return c.unicode();
+}
+
+inline constexpr quint32 keywordFoldCase(quint32 c)
+{
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+/**
+ * @brief Hashes a word (the ASCII letters without case).
+ */
+template <typename CHAR>
+constexpr quint32 keywordHash(quint32 seed, const CHAR* str, int len)
+{
+  quint32 h = 2166136261u ^ (seed * 16777619u);
+  for (int i = 0; i < len; i++)
+    h = (h ^ keywordFoldCase(keywordCharCode(str[i]))) * 16777619u;
+  h ^= h >> 16;
+  h *= 0x45d9f3bu;
+  h ^= h >> 16;
+  return h;
+}
+
+inline constexpr int keywordLength(const char* word)
+{
+  int len = 0;
+  while (word[len] != '\0')
+    len++;
+  return len;
+}
+
+/**
+ * @brief A perfect hash table of words (see makeKeywordTable()).
+ */
+template <int WORD_COUNT>
+struct KeywordTable
+{
+  enum
+  {
+    TABLE_SIZE = WORD_COUNT + WORD_COUNT / 4 + 1
+  };
+
+  const char* m_words[TABLE_SIZE]; //!< The word in each slot (or NULL).
+  int m_lengths[TABLE_SIZE];
+  int m_displacements[TABLE_SIZE]; //!< Seed of the second hash of each bucket (or -slot-1 if the bucket has one word).
+  int m_maxLength; //!< Length of the longest word.
+  bool m_isValid; //!< False if all words could not get a slot of their own (eg: a duplicate).
+};
+
+/**
+ * @brief Builds a perfect hash table at compile time using "hash and displace".
+ * The words are put in buckets by a first hash. Then a seed is searched for each bucket
+ * that puts its words in free slots with a second hash (the largest buckets first).
+ * The words of a set that ignores case must be in lower case.
+ */
+template <int WORD_COUNT>
+constexpr KeywordTable<WORD_COUNT> makeKeywordTable(const char* const (&words)[WORD_COUNT])
+{
+  typedef KeywordTable<WORD_COUNT> Table;
+  const quint32 tableSize = Table::TABLE_SIZE;
+  Table table = {};
+  int bucketIdx[WORD_COUNT] = {};
+  int bucketSize[Table::TABLE_SIZE] = {};
+  bool isUsed[Table::TABLE_SIZE] = {};
+
+  table.m_isValid = true;
+  for (int i = 0; i < WORD_COUNT; i++)
+  {
+    int len = keywordLength(words[i]);
+    bucketIdx[i] = keywordHash(0, words[i], len) % tableSize;
+    bucketSize[bucketIdx[i]]++;
+    if (len > table.m_maxLength)
+      table.m_maxLength = len;
+  }
+
+  for (int n = WORD_COUNT; n >= 2; n--)
+  {
+    for (int b = 0; b < Table::TABLE_SIZE; b++)
+    {
+      if (bucketSize[b] != n)
+        continue;
+
+      bool isFound = false;
+      for (quint32 seed = 1; !isFound && seed < KEYWORDSET_MAX_SEED; seed++)
+      {
+        isFound = true;
+        for (int i = 0; isFound && i < WORD_COUNT; i++)
+        {
+          if (bucketIdx[i] != b)
+            continue;
+          quint32 slot = keywordHash(seed, words[i], keywordLength(words[i])) % tableSize;
+          if (isUsed[slot])
+            isFound = false;
+          for (int j = 0; isFound && j < i; j++)
+          {
+            if (bucketIdx[j] == b && keywordHash(seed, words[j], keywordLength(words[j])) % tableSize == slot)
+              isFound = false;
+          }
+        }
+
+        if (isFound)
+        {
+          table.m_displacements[b] = seed;
+          for (int i = 0; i < WORD_COUNT; i++)
+          {
+            if (bucketIdx[i] != b)
+              continue;
+            int len = keywordLength(words[i]);
+            quint32 slot = keywordHash(seed, words[i], len) % tableSize;
+            isUsed[slot] = true;
+            table.m_words[slot] = words[i];
+            table.m_lengths[slot] = len;
+          }
+        }
+      }
+      if (!isFound)
+        table.m_isValid = false;
+    }
+  }
+
+  // The words alone in their bucket are put directly in the free slots
+  int freeSlot = 0;
+  for (int i = 0; i < WORD_COUNT; i++)
+  {
+    if (bucketSize[bucketIdx[i]] != 1)
+      continue;
+    while (isUsed[freeSlot])
+      freeSlot++;
+    isUsed[freeSlot] = true;
+    table.m_words[freeSlot] = words[i];
+    table.m_lengths[freeSlot] = keywordLength(words[i]);
+    table.m_displacements[bucketIdx[i]] = -freeSlot - 1;
+  }
+
+  return table;
+}
+
+/**
+ * @brief A fixed set of words stored in a perfect hash table.
+ * Every word has a slot of its own so a lookup is one hash and one compare.
+ */
+class KeywordSet
+{
+public:
+  template <int WORD_COUNT>
+  constexpr KeywordSet(const KeywordTable<WORD_COUNT>& table, bool isCaseSensitive)
+    : m_words(table.m_words)
+    , m_lengths(table.m_lengths)
+    , m_displacements(table.m_displacements)
+    , m_tableSize(KeywordTable<WORD_COUNT>::TABLE_SIZE)
+    , m_maxLength(table.m_maxLength)
+    , m_isCaseSensitive(isCaseSensitive)
+  {
+  }
+
+  /**
+   * @brief Checks if a word is in the set.
+   * @param str   The word as QChar:s or as the bytes of a Latin-1 or UTF-8 string.
+   */
+  template <typename CHAR>
+  bool contains(const CHAR* str, int len) const
+  {
+    if (len == 0 || len > m_maxLength)
+      return false;
+
+    int displacement = m_displacements[keywordHash(0, str, len) % m_tableSize];
+    int slot = displacement < 0 ? -displacement - 1 : keywordHash(displacement, str, len) % m_tableSize;
+    if (m_lengths[slot] != len)
+      return false;
+
+    const char* word = m_words[slot];
+    for (int i = 0; i < len; i++)
+    {
+      quint32 c = keywordCharCode(str[i]);
+      if (!m_isCaseSensitive)
+        c = keywordFoldCase(c);
+      if (c != keywordCharCode(word[i]))
+        return false;
+    }
+    return true;
+  };
+  bool contains(QString text) const
+  {
+    return contains(text.constData(), text.size());
+  };
+
+  bool isCaseSensitive() const
+  {
+    return m_isCaseSensitive;
+  };
+  QStringList toStringList() const;
+
+private:
+  const char* const* m_words;
+  const int* m_lengths;
+  const int* m_displacements;
+  quint32 m_tableSize;
+  int m_maxLength;
+  bool m_isCaseSensitive;
+};
+
+// The keywords of each language (see keywordset.cpp)
+extern const KeywordSet g_cxxKeywords;
+extern const KeywordSet g_cppKeywords; //!< The C preprocessor.
+extern const KeywordSet g_goKeywords;
+extern const KeywordSet g_adaKeywords;
+extern const KeywordSet g_adaTagKeywords; //!< Same words as g_adaKeywords but compared with case (used by AdaTagScanner).
+extern const KeywordSet g_rustKeywords;
+extern const KeywordSet g_basicKeywords;
+extern const KeywordSet g_fortranKeywords;
+
+#endif // FILE__KEYWORDSET_H
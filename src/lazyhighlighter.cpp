@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+//#define ENABLE_DEBUGMSG
+
+#include "lazyhighlighter.h"
+
+#include "codeview.h"
+#include "config.h"
+#include "log.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+
+// Start state of a block that is not known yet
+#define STATE_UNKNOWN -1
+
+LazyHighlighter::LazyHighlighter(QObject* receiver)
+  : m_receiver(receiver)
+  , m_quit(false)
+  , m_textId(0)
+  , m_codeType(0)
+  , m_firstVisibleRowIdx(0)
+  , m_lastVisibleRowIdx(0)
+  , m_notifyPending(false)
+{
+}
+
+LazyHighlighter::~LazyHighlighter()
+{
+  m_mutex.lock();
+  m_quit = true;
+  m_cond.wakeAll();
+  m_mutex.unlock();
+
+  wait();
+
+  clearResults();
+}
+
+/**
+ * @brief Deletes the blocks that has not been taken.
+ */
+void LazyHighlighter::clearResults()
+{
+  for (int i = 0; i < m_results.size(); i++)
+    delete m_results[i].m_highlighter;
+  m_results.clear();
+}
+
+/**
+ * @brief Starts to colorize a new text (the blocks of the previous text are dropped).
+ * @param lineStarts   The index in text of the first character of each line.
+ * @param codeType     The language (see CodeView::CodeType).
+ */
+void LazyHighlighter::setText(QString text, QVector<int> lineStarts, int codeType)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_text = text;
+  m_lineStarts = lineStarts;
+  m_codeType = codeType;
+  m_textId++;
+  clearResults();
+  m_cond.wakeAll();
+}
+
+/**
+ * @brief Tells which rows that are shown (they will be colorized before the rest).
+ */
+void LazyHighlighter::setVisibleRows(int firstRowIdx, int lastRowIdx)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_firstVisibleRowIdx = firstRowIdx;
+  m_lastVisibleRowIdx = lastRowIdx;
+}
+
+/**
+ * @brief Takes the blocks colorized since the last call.
+ * A block may be returned more than once if it had to be redone.
+ */
+void LazyHighlighter::takeResults(QList<HighlightedBlock>* blockList)
+{
+  QMutexLocker locker(&m_mutex);
+
+  *blockList = m_results;
+  m_results.clear();
+  m_notifyPending = false;
+}
+
+void LazyHighlighter::run()
+{
+  int doneId = 0;
+  for (;;)
+  {
+    m_mutex.lock();
+    while (!m_quit && m_textId == doneId)
+      m_cond.wait(&m_mutex);
+    if (m_quit)
+    {
+      m_mutex.unlock();
+      return;
+    }
+    int textId = m_textId;
+    QString text = m_text;
+    QVector<int> lineStarts = m_lineStarts;
+    int codeType = m_codeType;
+    m_mutex.unlock();
+
+    highlightAll(textId, text, lineStarts, codeType);
+    doneId = textId;
+  }
+}
+
+void LazyHighlighter::highlightAll(int textId, QString text, QVector<int> lineStarts, int codeType)
+{
+  const int lineCount = lineStarts.size();
+  const int blockCount = (lineCount + HIGHLIGHT_BLOCK_SIZE - 1) / HIGHLIGHT_BLOCK_SIZE;
+  QVector<int> startState(blockCount, STATE_UNKNOWN); // The state at the start of each block (if known)
+  QVector<int> colorState(blockCount, STATE_UNKNOWN); // The start state each block was colorized with
+  QVector<int> endState(blockCount, STATE_UNKNOWN);
+  int seqBlockIdx = 0; // All blocks before this one are done
+  QElapsedTimer timer;
+  timer.start();
+
+  if (blockCount > 0)
+    startState[0] = SyntaxHighlighter::LINE_STATE_NORMAL;
+
+  for (;;)
+  {
+    // Replaced by a new text?
+    m_mutex.lock();
+    bool isAborted = m_quit || m_textId != textId;
+    int firstVisibleBlockIdx = m_firstVisibleRowIdx / HIGHLIGHT_BLOCK_SIZE - 1;
+    int lastVisibleBlockIdx = m_lastVisibleRowIdx / HIGHLIGHT_BLOCK_SIZE + 1;
+    m_mutex.unlock();
+    if (isAborted)
+      return;
+
+    // Pass on the end state of the blocks done in order
+    while (seqBlockIdx < blockCount && colorState[seqBlockIdx] != STATE_UNKNOWN && colorState[seqBlockIdx] == startState[seqBlockIdx])
+    {
+      if (seqBlockIdx + 1 < blockCount)
+        startState[seqBlockIdx + 1] = endState[seqBlockIdx];
+      seqBlockIdx++;
+    }
+
+    // Pick a block close to the visible rows that has not been done (or was done with the wrong start state)
+    int blockIdx = -1;
+    for (int b = std::max(0, firstVisibleBlockIdx); b <= std::min(blockCount - 1, lastVisibleBlockIdx) && blockIdx == -1; b++)
+    {
+      if (colorState[b] == STATE_UNKNOWN || (startState[b] != STATE_UNKNOWN && colorState[b] != startState[b]))
+        blockIdx = b;
+    }
+
+    // or the next block in order
+    if (blockIdx == -1)
+    {
+      if (seqBlockIdx == blockCount)
+        break;
+      blockIdx = seqBlockIdx;
+    }
+
+    // Colorize it (guess that it does not start in a comment if the start state is not known yet)
+    int state = startState[blockIdx];
+    if (state == STATE_UNKNOWN)
+      state = SyntaxHighlighter::LINE_STATE_NORMAL;
+    int firstLineIdx = blockIdx * HIGHLIGHT_BLOCK_SIZE;
+    int endLineIdx = firstLineIdx + HIGHLIGHT_BLOCK_SIZE;
+    int startPos = lineStarts[firstLineIdx];
+    int endPos = endLineIdx < lineCount ? lineStarts[endLineIdx] : text.size();
+
+    SyntaxHighlighter* highlighter = CodeView::createHighlighter((CodeView::CodeType) codeType);
+    endState[blockIdx] = highlighter->colorize(text.mid(startPos, endPos - startPos), state);
+    colorState[blockIdx] = state;
+
+    publish(textId, blockIdx, highlighter);
+  }
+
+  debugMsg("Colorized %d lines in %lld ms", lineCount, (long long) timer.elapsed());
+}
+
+/**
+ * @brief Hands over a colorized block to the receiver.
+ */
+void LazyHighlighter::publish(int textId, int blockIdx, SyntaxHighlighter* highlighter)
+{
+  QMutexLocker locker(&m_mutex);
+
+  // Text replaced while colorizing?
+  if (m_textId != textId)
+  {
+    delete highlighter;
+    return;
+  }
+
+  HighlightedBlock block;
+  block.m_blockIdx = blockIdx;
+  block.m_highlighter = highlighter;
+  m_results.append(block);
+
+  // Only one call is queued until the results has been taken
+  if (!m_notifyPending)
+  {
+    m_notifyPending = true;
+    QMetaObject::invokeMethod(m_receiver, "onHighlightDone", Qt::QueuedConnection);
+  }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__LAZYHIGHLIGHTER_H
+#define FILE__LAZYHIGHLIGHTER_H
+
+#include "syntaxhighlighter.h"
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+/**
+ * @brief A block of HIGHLIGHT_BLOCK_SIZE lines colorized by a LazyHighlighter.
+ */
+struct HighlightedBlock
+{
+  int m_blockIdx; //!< The first line of the block is m_blockIdx*HIGHLIGHT_BLOCK_SIZE.
+  SyntaxHighlighter* m_highlighter; //!< Owned by whoever took the block.
+};
+
+/**
+ * @brief Colorizes a text in blocks of lines in a separate thread.
+ * The blocks close to the visible rows are colorized first. The state at the end of each block
+ * is passed on to the next one and a block that was colorized with the wrong start state is redone.
+ */
+class LazyHighlighter : public QThread
+{
+  Q_OBJECT
+
+public:
+  LazyHighlighter(QObject* receiver);
+  virtual ~LazyHighlighter();
+
+  void setText(QString text, QVector<int> lineStarts, int codeType);
+  void setVisibleRows(int firstRowIdx, int lastRowIdx);
+  void takeResults(QList<HighlightedBlock>* blockList);
+
+  void run();
+
+private:
+  void highlightAll(int textId, QString text, QVector<int> lineStarts, int codeType);
+  void publish(int textId, int blockIdx, SyntaxHighlighter* highlighter);
+  void clearResults();
+
+private:
+  QObject* m_receiver; //!< Its onHighlightDone() slot is invoked (queued) when there are blocks to take.
+
+  QMutex m_mutex; //!< Protects the members below.
+  QWaitCondition m_cond;
+  bool m_quit;
+  int m_textId; //!< Id of the latest text.
+  QString m_text;
+  QVector<int> m_lineStarts;
+  int m_codeType;
+  int m_firstVisibleRowIdx;
+  int m_lastVisibleRowIdx;
+  QList<HighlightedBlock> m_results; //!< Colorized blocks of the text with id m_textId.
+  bool m_notifyPending; //!< True if onHighlightDone() has been queued but not yet called takeResults().
+};
+
+#endif // FILE__LAZYHIGHLIGHTER_H
@@ -10,6 +10,7 @@
 
 #include "locator.h"
 
+#include "config.h"
 #include "core.h"
 #include "log.h"
 #include "mainwindow.h"
@@ -31,6 +32,7 @@ void Location::dump()
 Locator::Locator(TagManager* mgr, QList<FileInfo>* sourceFiles)
   : m_mgr(mgr)
   , m_sourceFiles(sourceFiles)
+  , m_fuzzyIndex(new FuzzyIndex(QStringList()))
 {
 }
 
@@ -151,6 +153,9 @@ QStringList Locator::searchExpression(QString filename, QString expressionStart)
   return list;
 }
 
+/**
+ * @brief Finds the files and functions which name starts with a string (used for the tab completion).
+ */
 QStringList Locator::searchExpression(QString expressionStart)
 {
   QStringList list;
@@ -159,34 +164,49 @@ QStringList Locator::searchExpression(QString expressionStart)
     FileInfo& info = (*m_sourceFiles)[k];
     if (info.m_name.startsWith(expressionStart))
       list.append(info.m_name);
+  }
 
-    // Find the tag
-    QList<Tag> tagList;
-    m_mgr->getTags(info.m_fullName, &tagList);
-    for (int i = 0; i < tagList.size(); i++)
-    {
-      Tag& tag = tagList[i];
-      if (tag.m_type == Tag::TAG_FUNC)
-      {
-        QString tagName;
-        if (tag.isClassMember())
-          tagName = tag.getClassName() + "::" + tag.getName();
-        else
-          tagName = tag.getName();
-        tagName += "()";
+  // Find the tags (the "()" of the expression is not part of the tag name)
+  QString prefix = expressionStart;
+  int parenPos = prefix.indexOf('(');
+  if (parenPos != -1)
+    prefix = prefix.left(parenPos);
 
-        if (tagName.startsWith(expressionStart))
-        {
-          debugMsg("Found '%s'", qPrintable(tagName));
-          list.append(tagName);
-        }
-      }
+  QList<Tag> tagList;
+  m_mgr->findTagsByPrefix(prefix, true, GOTO_MAX_TAGS, &tagList);
+  for (int i = 0; i < tagList.size(); i++)
+  {
+    QString tagName = SymbolIndex::getLongName(tagList[i]) + "()";
+    if (tagName.startsWith(expressionStart) && (list.isEmpty() || list.last() != tagName))
+    {
+      debugMsg("Found '%s'", qPrintable(tagName));
+      list.append(tagName);
     }
   }
 
   return list;
 }
 
+/**
+ * @brief Updates the names of the source files and functions used for a fuzzy search.
+ * Called when the tags of all the source files have been scanned. The search text is
+ * built later in the thread of the FuzzyFinder (see FuzzyIndex::build()).
+ */
+void Locator::updateFuzzyIndex()
+{
+  QStringList funcNameList;
+  m_mgr->getTagNames(true, &funcNameList);
+
+  QStringList nameList;
+  nameList.reserve(m_sourceFiles->size() + funcNameList.size());
+  for (int k = 0; k < m_sourceFiles->size(); k++)
+    nameList.append((*m_sourceFiles)[k].m_name);
+  for (int i = 0; i < funcNameList.size(); i++)
+    nameList.append(funcNameList[i] + "()");
+
+  m_fuzzyIndex = QSharedPointer<FuzzyIndex>(new FuzzyIndex(nameList));
+}
+
 QVector<Location> Locator::locate(QString expr)
 {
   QVector<Location> list;
@@ -1,6 +1,7 @@
 #ifndef FILE__LOCATOR_H
 #define FILE__LOCATOR_H
 
+#include "fuzzyfinder.h"
 #include "tagmanager.h"
 
 #include <QString>
@@ -33,6 +34,12 @@ public:
 
   QStringList searchExpression(QString filename, QString expressionStart);
 
+  void updateFuzzyIndex();
+  QSharedPointer<FuzzyIndex> getFuzzyIndex() const
+  {
+    return m_fuzzyIndex;
+  };
+
 private:
   QStringList findFile(QString defFilename);
 
@@ -40,6 +47,9 @@ public:
   TagManager* m_mgr;
   QString m_currentFilename;
   QList<FileInfo>* m_sourceFiles;
+
+private:
+  QSharedPointer<FuzzyIndex> m_fuzzyIndex; //!< The files and functions (see updateFuzzyIndex()).
 };
 
 #endif // FILE__LOCATOR_H
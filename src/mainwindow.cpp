@@ -28,6 +28,8 @@
 MainWindow::MainWindow(QWidget* parent)
   : QMainWindow(parent)
   , m_tagManager(m_cfg)
+  , m_funcListModel(false)
+  , m_classListModel(true)
   , m_locator(&m_tagManager, &m_sourceFiles)
 {
   QStringList names;
@@ -143,10 +145,12 @@ MainWindow::MainWindow(QWidget* parent)
 
   connect(&m_tagManager, SIGNAL(onAllScansDone()), SLOT(onAllTagScansDone()));
 
-  // Setup the function treewidget
-  treeWidget = m_ui.treeWidget_functions;
-  treeWidget->setColumnWidth(0, 200);
-  connect(m_ui.treeWidget_functions, SIGNAL(itemClicked(QTreeWidgetItem*, int)), SLOT(onFuncWidgetItemSelected(QTreeWidgetItem*, int)));
+  // Setup the function list
+  m_funcFilterModel.setSourceModel(&m_funcListModel);
+  m_ui.treeView_functions->setModel(&m_funcFilterModel);
+  m_ui.treeView_functions->setUniformRowHeights(true);
+  m_ui.treeView_functions->setColumnWidth(0, 200);
+  connect(m_ui.treeView_functions, SIGNAL(clicked(const QModelIndex&)), SLOT(onFuncListItemClicked(const QModelIndex&)));
 
   m_ui.lineEdit_funcFilter->setPlaceholderText("Filter1;Filter2;...");
   connect(m_ui.lineEdit_funcFilter, SIGNAL(textChanged(const QString&)), SLOT(onFuncFilter_textChanged(const QString&)));
@@ -165,10 +169,12 @@ MainWindow::MainWindow(QWidget* parent)
 
   m_ui.widget_search->hide();
 
-  // Setup the class treewidget
-  treeWidget = m_ui.treeWidget_classes;
-  treeWidget->setColumnWidth(0, 200);
-  connect(m_ui.treeWidget_classes, SIGNAL(itemClicked(QTreeWidgetItem*, int)), SLOT(onFuncWidgetItemSelected(QTreeWidgetItem*, int)));
+  // Setup the class tree
+  m_classFilterModel.setSourceModel(&m_classListModel);
+  m_ui.treeView_classes->setModel(&m_classFilterModel);
+  m_ui.treeView_classes->setUniformRowHeights(true);
+  m_ui.treeView_classes->setColumnWidth(0, 200);
+  connect(m_ui.treeView_classes, SIGNAL(clicked(const QModelIndex&)), SLOT(onClassListItemClicked(const QModelIndex&)));
 
   installEventFilter(this);
 
@@ -213,10 +219,17 @@ MainWindow::~MainWindow()
  */
 void MainWindow::showWidgets()
 {
-  if (!m_cfg.m_viewFuncFilter)
+  if (!m_cfg.m_viewFuncFilter && !m_funcFilterText.isEmpty())
+  {
     m_funcFilterText.clear();
-  if (!m_cfg.m_viewClassFilter)
+    m_funcFilterModel.setFilterList(m_funcFilterText);
+  }
+  if (!m_cfg.m_viewClassFilter && !m_classFilterText.isEmpty())
+  {
     m_classFilterText.clear();
+    m_classFilterModel.setFilterList(m_classFilterText);
+    expandClassList();
+  }
 
   m_ui.actionViewFunctionFilter->setChecked(m_cfg.m_viewFuncFilter);
   m_ui.actionViewClassFilter->setChecked(m_cfg.m_viewClassFilter);
@@ -260,6 +273,16 @@ void MainWindow::showWidgets()
   m_ui.autoWidget->setVisible(m_cfg.m_viewWindowAutoVariables);
   m_ui.treeWidget_file->setVisible(m_cfg.m_viewWindowFileBrowser);
 
+  // Only fetch the data for the visible panels when the target stops
+  int refreshFlags = 0;
+  if (m_cfg.m_viewWindowThreads)
+    refreshFlags |= Core::REFRESH_THREADS;
+  if (m_cfg.m_viewWindowWatch || m_cfg.m_viewWindowAutoVariables)
+    refreshFlags |= Core::REFRESH_WATCHES;
+  if (m_cfg.m_viewWindowAutoVariables)
+    refreshFlags |= Core::REFRESH_LOCALS;
+  Core::getInstance().setVisiblePanels(refreshFlags);
+
   currentSelection = m_ui.tabWidget_2->currentWidget();
   m_ui.tabWidget_2->clear();
   if (m_cfg.m_viewWindowTargetOutput)
@@ -2008,7 +2031,7 @@ void MainWindow::onFuncFilter_textChanged(const QString& text)
     }
   }
 
-  fillInFuncList();
+  m_funcFilterModel.setFilterList(m_funcFilterText);
 }
 
 void MainWindow::onFuncFilterCheckBoxStateChanged(int state)
@@ -2050,7 +2073,8 @@ void MainWindow::onClassFilter_textChanged(const QString& text)
     }
   }
 
-  fillInClassList();
+  m_classFilterModel.setFilterList(m_classFilterText);
+  expandClassList();
 }
 
 void MainWindow::onIncSearch_textChanged(const QString& text)
@@ -2072,155 +2096,53 @@ void MainWindow::onIncSearch_textChanged(const QString& text)
  */
 void MainWindow::onAllTagScansDone()
 {
-  // Get all tags
-  m_tagList.clear();
+  // Get all tags (the lists are shared with the tag manager)
+  QVector<QList<Tag> > fileTagList;
+  fileTagList.reserve(m_sourceFiles.size());
   for (int k = 0; k < m_sourceFiles.size(); k++)
   {
     FileInfo& info = m_sourceFiles[k];
 
-    // Find the tag
     QList<Tag> thisTagList;
     m_tagManager.getTags(info.m_fullName, &thisTagList);
-    m_tagList += thisTagList;
+    if (!thisTagList.isEmpty())
+      fileTagList.append(thisTagList);
   }
 
-  fillInClassList();
-  fillInFuncList();
+  m_classListModel.setTags(fileTagList);
+  m_funcListModel.setTags(fileTagList);
+  expandClassList();
+
+  m_locator.updateFuzzyIndex();
 }
 
-void MainWindow::fillInClassList()
+/**
+ * @brief Expands all classes in the class list if there is only a few methods to show.
+ */
+void MainWindow::expandClassList()
 {
-  // Get all classes
-  QStringList classList;
-  for (int i = 0; i < m_tagList.size(); i++)
-  {
-    const Tag& tag = m_tagList[i];
-    QString className = tag.getClassName();
-    if (!className.isEmpty())
-      classList += tag.getClassName();
-  }
-  classList.removeDuplicates();
-  classList.sort();
-
-  // Insert the classes in the class widget
-  QTreeWidget* classWidget = m_ui.treeWidget_classes;
-  classWidget->clear();
   int totalClassFuncCount = 0;
-  for (int ci = 0; ci < classList.size(); ci++)
-  {
-    QString className = classList[ci];
-
-    bool isMatch = true;
-
-    // Does the filter match the name?
-    for (int j = 0; j < m_classFilterText.size() && isMatch == true; j++)
-    {
-      QRegExp& rx = m_classFilterText[j];
-      if (rx.indexIn(className) == -1)
-        isMatch = false;
-    }
-
-    if (isMatch)
-    {
-      // Insert the class
-      QTreeWidgetItem* classItem = new QTreeWidgetItem;
-      classItem->setText(0, className);
-      QBrush blueBrush(Qt::blue);
-      classItem->setForeground(0, blueBrush);
-      classWidget->addTopLevelItem(classItem);
-
-      // Add all functions to the class in the class widget
-      for (int i = 0; i < m_tagList.size(); i++)
-      {
-        const Tag& tag = m_tagList[i];
-        if (tag.isFunc() && tag.getClassName() == className)
-        {
-          QTreeWidgetItem* item = new QTreeWidgetItem;
-          item->setText(0, tag.getName() + tag.getSignature());
-          item->setData(0, Qt::UserRole, tag.getLineNo());
-          item->setText(1, getFilenamePart(tag.getFilePath()));
-          item->setData(1, Qt::UserRole, tag.getFilePath());
-          item->setText(2, QString::number(tag.getLineNo()));
-          classItem->addChild(item);
-        }
-      }
-      totalClassFuncCount += m_tagList.size();
-    }
-  }
+  for (int row = 0; row < m_classFilterModel.rowCount() && totalClassFuncCount < CLASS_LIST_AUTO_EXPAND_COUNT; row++)
+    totalClassFuncCount += m_classFilterModel.rowCount(m_classFilterModel.index(row, 0));
 
-  // Expand class treewidget?
   if (totalClassFuncCount < CLASS_LIST_AUTO_EXPAND_COUNT)
-  {
-    for (int j = classWidget->topLevelItemCount() - 1; j >= 0; --j)
-    {
-      QTreeWidgetItem* classItem = classWidget->topLevelItem(j);
-      classItem->setExpanded(true);
-    }
-  }
-}
-
-void MainWindow::fillInFuncList()
-{
-  QTreeWidget* funcWidget = m_ui.treeWidget_functions;
-  funcWidget->clear();
-
-  // Add all functions to the treewidget
-  for (int i = 0; i < m_tagList.size(); i++)
-  {
-    const Tag& tag = m_tagList[i];
-    if (tag.isFunc())
-    {
-      bool isMatch = true;
-
-      // Does the filter match the name?
-      QString name = tag.getLongName();
-      for (int j = 0; j < m_funcFilterText.size() && isMatch == true; j++)
-      {
-        QRegExp& rx = m_funcFilterText[j];
-        if (rx.indexIn(name) == -1)
-          isMatch = false;
-      }
-
-      // Add the item if it matches
-      if (isMatch)
-      {
-        QTreeWidgetItem* item = new QTreeWidgetItem;
-        if (tag.getClassName().isEmpty())
-          item->setText(0, " " + name);
-        else
-          item->setText(0, name);
-        item->setData(0, Qt::UserRole, tag.getLineNo());
-        item->setText(1, getFilenamePart(tag.getFilePath()));
-        item->setData(1, Qt::UserRole, tag.getFilePath());
-        item->setText(2, QString::number(tag.getLineNo()));
-
-        funcWidget->addTopLevelItem(item);
-      }
-    }
-  }
-  funcWidget->sortItems(0, Qt::AscendingOrder);
+    m_ui.treeView_classes->expandAll();
 }
 
-void MainWindow::onFuncWidgetItemSelected(QTreeWidgetItem* item, int column)
+void MainWindow::onFuncListItemClicked(const QModelIndex& index)
 {
-  Q_UNUSED(column);
-
   // Get the linenumber and file where the function is defined in
-  QString filePath = item->data(1, Qt::UserRole).toString();
-  int lineNo = item->data(0, Qt::UserRole).toInt();
-
-  open(filePath, lineNo);
+  const Tag* tag = m_funcListModel.getTag(m_funcFilterModel.mapToSource(index));
+  if (tag)
+    open(tag->getFilePath(), tag->getLineNo());
 }
 
-void MainWindow::onClassWidgetItemSelected(QTreeWidgetItem* item, int column)
+void MainWindow::onClassListItemClicked(const QModelIndex& index)
 {
-  Q_UNUSED(column);
-
-  debugMsg("%s(item:%p column:%d)", __func__, item, column);
-
-  // Get the linenumber and file where the function is defined in
-  QString filePath = item->data(1, Qt::UserRole).toString();
-  int lineNo = item->data(0, Qt::UserRole).toInt();
+  debugMsg("%s(row:%d)", __func__, index.row());
 
-  open(filePath, lineNo);
+  // Get the linenumber and file where the method is defined in
+  const Tag* tag = m_classListModel.getTag(m_classFilterModel.mapToSource(index));
+  if (tag)
+    open(tag->getFilePath(), tag->getLineNo());
 }
@@ -16,6 +16,7 @@
 #include "core.h"
 #include "log.h"
 #include "settings.h"
+#include "taglistmodel.h"
 #include "tagmanager.h"
 #include "tagscanner.h"
 #include "ui_mainwindow.h"
@@ -87,8 +88,7 @@ private:
   void closeEvent(QCloseEvent* e);
 
   void showWidgets();
-  void fillInFuncList();
-  void fillInClassList();
+  void expandClassList();
 
 public:
 private:
@@ -171,8 +171,8 @@ public slots:
   void onBreakpointsWidgetContextMenu(const QPoint& pt);
 
   void onAllTagScansDone();
-  void onFuncWidgetItemSelected(QTreeWidgetItem* item, int column);
-  void onClassWidgetItemSelected(QTreeWidgetItem* item, int column);
+  void onFuncListItemClicked(const QModelIndex& index);
+  void onClassListItemClicked(const QModelIndex& index);
 
   void onNewInfoMsg(QString text);
   void onNewWarnMsg(QString text);
@@ -207,7 +207,10 @@ private:
   Settings m_cfg;
   TagManager m_tagManager;
   QList<FileInfo> m_sourceFiles;
-  QList<Tag> m_tagList; // Current list of tags
+  TagListModel m_funcListModel; //!< All functions.
+  TagListModel m_classListModel; //!< All classes with their methods.
+  TagFilterProxyModel m_funcFilterModel;
+  TagFilterProxyModel m_classFilterModel;
 
   AutoVarCtl m_autoVarCtl;
   WatchVarCtl m_watchVarCtl;
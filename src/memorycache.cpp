@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2014-2017 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#include "memorycache.h"
+
+#include "config.h"
+#include "core.h"
+#include "log.h"
+
+#include <QPointer>
+#include <string.h>
+
+#define PAGE_MASK ((quint64) (MEMORY_CACHE_PAGE_SIZE - 1))
+
+static const quint64 ONES = 0x0101010101010101ULL;
+static const quint64 HIGHS = 0x8080808080808080ULL;
+
+/**
+ * @brief Returns the index of the first byte (starting at idx) that differs between a and b (or len).
+ */
+static int findNextChange(const char* a, const char* b, int idx, int len)
+{
+  // Skip equal words
+  for (; idx + 8 <= len; idx += 8)
+  {
+    quint64 wa, wb;
+    memcpy(&wa, a + idx, 8);
+    memcpy(&wb, b + idx, 8);
+    if (wa != wb)
+      break;
+  }
+  while (idx < len && a[idx] == b[idx])
+    idx++;
+  return idx;
+}
+
+/**
+ * @brief Returns the index of the first byte (starting at idx) that is equal in a and b (or len).
+ */
+static int findNextEqual(const char* a, const char* b, int idx, int len)
+{
+  // Skip words where all bytes differ (words where the xor has no zero byte)
+  for (; idx + 8 <= len; idx += 8)
+  {
+    quint64 wa, wb;
+    memcpy(&wa, a + idx, 8);
+    memcpy(&wb, b + idx, 8);
+    quint64 x = wa ^ wb;
+    if (((x - ONES) & ~x & HIGHS) != 0)
+      break;
+  }
+  while (idx < len && a[idx] != b[idx])
+    idx++;
+  return idx;
+}
+
+MemoryCache::MemoryCache(QObject* parent)
+  : QObject(parent)
+  , m_snapshotTaken(false)
+  , m_generation(0)
+{
+}
+
+MemoryCache::~MemoryCache()
+{
+}
+
+/**
+ * @brief Returns the cached content of a memory area without waiting for GDB.
+ * Pages that are missing (and the pages just before and after the area) are requested from GDB
+ * and contentChanged() is emitted when they have been received.
+ * @return The content up to the first byte that is not available yet (may be less than count bytes).
+ */
+QByteArray MemoryCache::getMemory(quint64 startAddress, int count)
+{
+  if (count <= 0)
+    return QByteArray();
+
+  quint64 firstPage = startAddress & ~PAGE_MASK;
+  quint64 lastPage = (startAddress + count - 1) & ~PAGE_MASK;
+  if (lastPage < firstPage)
+    lastPage = ~PAGE_MASK;
+
+  // Request the visible pages first
+  for (quint64 pageAddr = firstPage; pageAddr >= firstPage && pageAddr <= lastPage; pageAddr += MEMORY_CACHE_PAGE_SIZE)
+    requestPage(pageAddr);
+
+  // Prefetch the neighbouring pages to make scrolling smooth
+  if (firstPage != 0)
+    requestPage(firstPage - MEMORY_CACHE_PAGE_SIZE);
+  if (lastPage != ~PAGE_MASK)
+    requestPage(lastPage + MEMORY_CACHE_PAGE_SIZE);
+
+  return copyPages(startAddress, count);
+}
+
+/**
+ * @brief Returns the content of a memory area and reads the pages that are not cached from GDB.
+ */
+QByteArray MemoryCache::readMemory(quint64 startAddress, int count)
+{
+  if (count <= 0)
+    return QByteArray();
+
+  Core& core = Core::getInstance();
+
+  quint64 firstPage = startAddress & ~PAGE_MASK;
+  quint64 lastPage = (startAddress + count - 1) & ~PAGE_MASK;
+  if (lastPage < firstPage)
+    lastPage = ~PAGE_MASK;
+
+  for (quint64 pageAddr = firstPage; pageAddr >= firstPage && pageAddr <= lastPage; pageAddr += MEMORY_CACHE_PAGE_SIZE)
+  {
+    if (m_pages.contains(pageAddr) && !m_pages[pageAddr].isEmpty())
+      continue;
+
+    QByteArray data;
+    if (core.gdbGetMemory(pageAddr, MEMORY_CACHE_PAGE_SIZE, &data) == 0 && data.size() == MEMORY_CACHE_PAGE_SIZE)
+      m_pages[pageAddr] = data;
+    else
+      m_pages[pageAddr] = QByteArray();
+  }
+
+  return copyPages(startAddress, count);
+}
+
+/**
+ * @brief Copies the content of the cached pages.
+ * @return The content up to the first page that is not available.
+ */
+QByteArray MemoryCache::copyPages(quint64 startAddress, int count)
+{
+  QByteArray content;
+  content.reserve(count);
+
+  quint64 addr = startAddress;
+  while (content.size() < count)
+  {
+    quint64 pageAddr = addr & ~PAGE_MASK;
+    QHash<quint64, QByteArray>::const_iterator it = m_pages.constFind(pageAddr);
+    if (it == m_pages.constEnd() || it.value().isEmpty())
+      break;
+
+    int offset = (int) (addr - pageAddr);
+    int len = qMin(MEMORY_CACHE_PAGE_SIZE - offset, count - content.size());
+    content.append(it.value().constData() + offset, len);
+    addr += len;
+  }
+
+  return content;
+}
+
+/**
+ * @brief Asks GDB for a page unless it is already cached or requested.
+ */
+void MemoryCache::requestPage(quint64 pageAddr)
+{
+  if (m_pages.contains(pageAddr) || m_pendingPages.contains(pageAddr))
+    return;
+
+  Core& core = Core::getInstance();
+
+  m_pendingPages.insert(pageAddr);
+
+  // The cache may be deleted before GDB has answered
+  QPointer<MemoryCache> self(this);
+  int generation = m_generation;
+  core.gdbGetMemoryAsync(pageAddr, MEMORY_CACHE_PAGE_SIZE, [self, generation, pageAddr](int rc, QByteArray data) {
+    if (self)
+      self->onPageRead(generation, pageAddr, rc, data);
+  });
+}
+
+/**
+ * @brief Called when GDB has answered a page request.
+ */
+void MemoryCache::onPageRead(int generation, quint64 pageAddr, int rc, QByteArray data)
+{
+  // Was the cache invalidated after the page was requested?
+  if (generation != m_generation)
+    return;
+
+  m_pendingPages.remove(pageAddr);
+
+  // A page that failed is remembered so that it is not requested over and over again
+  if (rc != 0 || data.size() != MEMORY_CACHE_PAGE_SIZE)
+  {
+    debugMsg("Failed to read memory at 0x%llx", (unsigned long long) pageAddr);
+    m_pages[pageAddr] = QByteArray();
+  }
+  else
+    m_pages[pageAddr] = data;
+
+  emit contentChanged();
+}
+
+/**
+ * @brief Makes the content of a memory area (and the rest of the cached pages) the snapshot that changes are shown against.
+ * The snapshot is kept until clearSnapshot() is called.
+ */
+void MemoryCache::takeSnapshot(quint64 startAddress, int count)
+{
+  readMemory(startAddress, count);
+
+  m_snapshotPages.clear();
+  copyPagesToSnapshot();
+  m_snapshotTaken = true;
+
+  emit contentChanged();
+}
+
+/**
+ * @brief Removes the snapshot taken by the user.
+ * Changes are then shown against the content at the previous stop.
+ */
+void MemoryCache::clearSnapshot()
+{
+  m_snapshotPages.clear();
+  m_snapshotTaken = false;
+
+  emit contentChanged();
+}
+
+/**
+ * @brief Adds the pages that has been read to the snapshot (replacing the old content of those pages).
+ */
+void MemoryCache::copyPagesToSnapshot()
+{
+  for (QHash<quint64, QByteArray>::const_iterator it = m_pages.constBegin(); it != m_pages.constEnd(); ++it)
+  {
+    if (!it.value().isEmpty())
+      m_snapshotPages.insert(it.key(), it.value());
+  }
+}
+
+/**
+ * @brief Returns which bytes that differs from the snapshot.
+ * @return One byte for each address which is non zero if it has changed.
+ */
+QByteArray MemoryCache::getChangedMask(quint64 startAddress, int count)
+{
+  QByteArray mask(qMax(count, 0), '\0');
+
+  int maskIdx = 0;
+  while (maskIdx < count)
+  {
+    quint64 addr = startAddress + maskIdx;
+    quint64 pageAddr = addr & ~PAGE_MASK;
+    int offset = (int) (addr - pageAddr);
+    int len = qMin(MEMORY_CACHE_PAGE_SIZE - offset, count - maskIdx);
+
+    QByteArray page = m_pages.value(pageAddr);
+    QByteArray snapshotPage = m_snapshotPages.value(pageAddr);
+    if (!page.isEmpty() && !snapshotPage.isEmpty())
+    {
+      const char* a = page.constData() + offset;
+      const char* b = snapshotPage.constData() + offset;
+      int idx = findNextChange(a, b, 0, len);
+      while (idx < len)
+      {
+        int endIdx = findNextEqual(a, b, idx, len);
+        memset(mask.data() + maskIdx + idx, 1, endIdx - idx);
+        idx = findNextChange(a, b, endIdx, len);
+      }
+    }
+    maskIdx += len;
+  }
+
+  return mask;
+}
+
+/**
+ * @brief Returns the areas of the cached pages that differs from the snapshot (sorted by address).
+ * @param maxCount   The max number of regions to return.
+ */
+QVector<MemoryCache::Region> MemoryCache::getChangedRegions(int maxCount)
+{
+  QVector<Region> list;
+
+  QList<quint64> pageList = m_snapshotPages.keys();
+  qSort(pageList.begin(), pageList.end());
+  for (int i = 0; i < pageList.size() && list.size() <= maxCount; i++)
+  {
+    quint64 pageAddr = pageList[i];
+    QByteArray page = m_pages.value(pageAddr);
+    if (page.isEmpty())
+      continue;
+    const char* a = page.constData();
+    const char* b = m_snapshotPages[pageAddr].constData();
+
+    int idx = findNextChange(a, b, 0, MEMORY_CACHE_PAGE_SIZE);
+    while (idx < MEMORY_CACHE_PAGE_SIZE && list.size() <= maxCount)
+    {
+      int endIdx = findNextEqual(a, b, idx, MEMORY_CACHE_PAGE_SIZE);
+
+      // Continues a region from the previous page?
+      if (idx == 0 && !list.isEmpty() && list.last().m_address + list.last().m_length == pageAddr)
+        list.last().m_length += endIdx;
+      else
+      {
+        Region region;
+        region.m_address = pageAddr + idx;
+        region.m_length = endIdx - idx;
+        list.append(region);
+      }
+
+      idx = findNextChange(a, b, endIdx, MEMORY_CACHE_PAGE_SIZE);
+    }
+  }
+  if (list.size() > maxCount)
+    list.resize(maxCount);
+
+  return list;
+}
+
+/**
+ * @brief Drops all cached pages (since the memory of the target may have changed).
+ * Unless the user has taken a snapshot, the dropped pages becomes the snapshot (the content at the previous stop).
+ */
+void MemoryCache::invalidate()
+{
+  // Pages that were not read during the last stop would be compared with stale content
+  if (!m_snapshotTaken)
+  {
+    m_snapshotPages.clear();
+    copyPagesToSnapshot();
+  }
+
+  m_generation++;
+  m_pages.clear();
+  m_pendingPages.clear();
+
+  emit contentChanged();
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2014-2017 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__MEMORYCACHE_H
+#define FILE__MEMORYCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+
+/**
+ * @brief Caches the memory of the target in pages of MEMORY_CACHE_PAGE_SIZE bytes.
+ * The pages are read from GDB asynchronously so that the GUI never has to wait for GDB.
+ */
+class MemoryCache : public QObject
+{
+  Q_OBJECT
+
+public:
+  /**
+   * @brief A range of bytes that differs from the snapshot.
+   */
+  struct Region
+  {
+    quint64 m_address;
+    int m_length;
+  };
+
+  MemoryCache(QObject* parent = NULL);
+  virtual ~MemoryCache();
+
+  QByteArray getMemory(quint64 startAddress, int count);
+  QByteArray readMemory(quint64 startAddress, int count);
+
+  void takeSnapshot(quint64 startAddress, int count);
+  void clearSnapshot();
+  bool isSnapshotTaken() const
+  {
+    return m_snapshotTaken;
+  };
+  QByteArray getChangedMask(quint64 startAddress, int count);
+  QVector<Region> getChangedRegions(int maxCount);
+
+public slots:
+  void invalidate();
+
+signals:
+  /**
+   * @brief Emitted when a page has been read or when the cache has been invalidated.
+   */
+  void contentChanged();
+
+private:
+  void requestPage(quint64 pageAddr);
+  void onPageRead(int generation, quint64 pageAddr, int rc, QByteArray data);
+  QByteArray copyPages(quint64 startAddress, int count);
+  void copyPagesToSnapshot();
+
+private:
+  QHash<quint64, QByteArray> m_pages; //!< The pages read (indexed by address). A page that could not be read is empty.
+  QSet<quint64> m_pendingPages; //!< The pages that has been requested but not received yet.
+  QHash<quint64, QByteArray> m_snapshotPages; //!< The pages the cached pages are compared with.
+  bool m_snapshotTaken; //!< True if the user took the snapshot (otherwise it is the content at the previous stop).
+  int m_generation; //!< Increased when the cache is invalidated (to ignore reads that are in flight).
+};
+
+#endif // FILE__MEMORYCACHE_H
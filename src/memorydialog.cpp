@@ -8,19 +8,114 @@
 
 #include "memorydialog.h"
 
+#include "config.h"
 #include "core.h"
+#include "log.h"
 #include "util.h"
 
+#include <QFile>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QProgressDialog>
+
 #define SCROLL_ADDR_RANGE 0x10000ULL
 
 QByteArray MemoryDialog::getMemory(quint64 startAddress, int count)
+{
+  return m_cache.getMemory(startAddress, count);
+}
+
+QByteArray MemoryDialog::readMemory(quint64 startAddress, int count)
+{
+  return m_cache.readMemory(startAddress, count);
+}
+
+QByteArray MemoryDialog::getChangedMask(quint64 startAddress, int count)
+{
+  return m_cache.getChangedMask(startAddress, count);
+}
+
+/**
+ * @brief Asks the user for an address range and a filename and saves the memory to the file.
+ * The memory is read and written in chunks so that the size of the range is not limited by the available RAM.
+ */
+void MemoryDialog::saveMemory(quint64 startAddress, quint64 count)
 {
   Core& core = Core::getInstance();
 
-  QByteArray b;
-  core.gdbGetMemory(startAddress, count, &b);
+  // Ask for the range
+  bool ok = false;
+  QString rangeText = addrToString(startAddress) + "-" + addrToString(startAddress + count - 1);
+  rangeText = QInputDialog::getText(this, "Save memory", "Address range (first-last):", QLineEdit::Normal, rangeText, &ok);
+  if (!ok)
+    return;
+  QStringList rangeList = rangeText.split('-');
+  if (rangeList.size() != 2)
+  {
+    QMessageBox::warning(this, "Save memory", "Invalid address range '" + rangeText + "'");
+    return;
+  }
+  quint64 firstAddr = inputTextToAddress(rangeList[0].trimmed());
+  quint64 lastAddr = inputTextToAddress(rangeList[1].trimmed());
+  if (lastAddr < firstAddr)
+  {
+    QMessageBox::warning(this, "Save memory", "Invalid address range '" + rangeText + "'");
+    return;
+  }
+  count = lastAddr - firstAddr + 1;
+
+  QString filename = QFileDialog::getSaveFileName(this, "Save memory", "memory.bin");
+  if (filename.isEmpty())
+    return;
+
+  QFile file(filename);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    QMessageBox::warning(this, "Save memory", "Failed to open '" + filename + "'");
+    return;
+  }
+
+  QProgressDialog progress("Saving memory to " + filename, "Cancel", 0, 1000, this);
+  progress.setWindowModality(Qt::WindowModal);
+  progress.setMinimumDuration(500);
+
+  quint64 doneCount = 0;
+  bool writeFailed = false;
+  int rc = core.gdbStreamMemory(firstAddr, count, [&](quint64, const char* data, int len) {
+    if (file.write(data, len) != len)
+    {
+      writeFailed = true;
+      return false;
+    }
+    doneCount += len;
+    progress.setValue((int) ((doneCount * 1000.0) / count));
+    return !progress.wasCanceled();
+  });
+  bool canceled = progress.wasCanceled();
+  progress.reset();
+
+  if (rc != 0)
+  {
+    file.remove();
+
+    if (writeFailed)
+      QMessageBox::warning(this, "Save memory", "Failed to write to '" + filename + "'");
+    else if (!canceled)
+      QMessageBox::warning(this, "Save memory", "Failed to read the memory at " + addrToString(firstAddr + doneCount));
+  }
+  else
+    infoMsg("Saved %llu bytes to '%s'", (unsigned long long) count, stringToCStr(filename));
+}
+
+void MemoryDialog::takeSnapshot(quint64 startAddress, int count)
+{
+  m_cache.takeSnapshot(startAddress, count);
+}
 
-  return b;
+void MemoryDialog::clearSnapshot()
+{
+  m_cache.clearSnapshot();
 }
 
 MemoryDialog::MemoryDialog(QWidget* parent)
@@ -34,6 +129,12 @@ MemoryDialog::MemoryDialog(QWidget* parent)
 
   m_ui.memorywidget->setInterface(this);
 
+  // Repaint when the pages arrive from GDB
+  connect(&m_cache, SIGNAL(contentChanged()), m_ui.memorywidget, SLOT(update()));
+  connect(&m_cache, SIGNAL(contentChanged()), SLOT(onCacheChanged()));
+  connect(m_ui.listWidget_changes, SIGNAL(itemClicked(QListWidgetItem*)), SLOT(onChangeItemClicked(QListWidgetItem*)));
+  connect(&Core::getInstance(), SIGNAL(memoryChanged()), &m_cache, SLOT(invalidate()));
+
   setStartAddress(0x0);
 
   connect(m_ui.pushButton_update, SIGNAL(clicked()), SLOT(onUpdate()));
@@ -65,6 +166,43 @@ void MemoryDialog::onUpdate()
   setStartAddress(addr);
 }
 
+/**
+ * @brief Updates the list of changed areas when pages have been read from GDB.
+ */
+void MemoryDialog::onCacheChanged()
+{
+  QVector<MemoryCache::Region> regions = m_cache.getChangedRegions(MEMORY_MAX_CHANGED_REGIONS);
+
+  // Unchanged? (Avoid resetting the selection in the list)
+  bool isEqual = (regions.size() == m_changedRegions.size());
+  for (int i = 0; isEqual && i < regions.size(); i++)
+  {
+    if (regions[i].m_address != m_changedRegions[i].m_address || regions[i].m_length != m_changedRegions[i].m_length)
+      isEqual = false;
+  }
+  if (isEqual)
+    return;
+  m_changedRegions = regions;
+
+  m_ui.listWidget_changes->clear();
+  for (int i = 0; i < regions.size(); i++)
+  {
+    const MemoryCache::Region& region = regions[i];
+    QString text = QString("%1 (%2 bytes)").arg(addrToString(region.m_address)).arg(region.m_length);
+    QListWidgetItem* item = new QListWidgetItem(text, m_ui.listWidget_changes);
+    item->setData(Qt::UserRole, region.m_address);
+  }
+}
+
+/**
+ * @brief Scrolls to the changed area that the user clicked on.
+ */
+void MemoryDialog::onChangeItemClicked(QListWidgetItem* item)
+{
+  quint64 addr = item->data(Qt::UserRole).toULongLong();
+  setStartAddress(addr);
+}
+
 void MemoryDialog::setStartAddress(quint64 addr)
 {
   quint64 addrAligned = addr & ~0xfULL;
@@ -1,6 +1,7 @@
 #ifndef FILE_MEMORYDIALOG_H
 #define FILE_MEMORYDIALOG_H
 
+#include "memorycache.h"
 #include "ui_memorydialog.h"
 
 #include <QDialog>
@@ -13,6 +14,11 @@ public:
   MemoryDialog(QWidget* parent = NULL);
 
   virtual QByteArray getMemory(quint64 startAddress, int count);
+  virtual QByteArray readMemory(quint64 startAddress, int count);
+  virtual QByteArray getChangedMask(quint64 startAddress, int count);
+  virtual void saveMemory(quint64 startAddress, quint64 count);
+  virtual void takeSnapshot(quint64 startAddress, int count);
+  virtual void clearSnapshot();
   void setStartAddress(quint64 addr);
 
   void setConfig(Settings* cfg);
@@ -20,6 +26,8 @@ public:
 public slots:
   void onVertScroll(int pos);
   void onUpdate();
+  void onCacheChanged();
+  void onChangeItemClicked(QListWidgetItem* item);
 
 private:
   quint64 inputTextToAddress(QString text);
@@ -27,6 +35,8 @@ private:
 
 private:
   Ui_MemoryDialog m_ui;
+  MemoryCache m_cache;
+  QVector<MemoryCache::Region> m_changedRegions; //!< The areas listed in listWidget_changes.
   quint64 m_startScrollAddress; //!< The minimum address the user can scroll to.
 };
 
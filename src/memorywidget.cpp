@@ -8,6 +8,7 @@
 
 #include "memorywidget.h"
 
+#include "config.h"
 #include "log.h"
 #include "util.h"
 
@@ -36,6 +37,7 @@ MemoryWidget::MemoryWidget(QWidget* parent)
   m_addrCharWidth = 0;
   m_font = QFont("Monospace", 10);
   m_fontInfo = new QFontMetrics(m_font);
+  m_clrChanged = Qt::red;
 
   setFocusPolicy(Qt::StrongFocus);
 
@@ -55,6 +57,7 @@ void MemoryWidget::setConfig(Settings* cfg)
   delete m_fontInfo;
   m_font = QFont(cfg->m_memoryFontFamily, cfg->m_memoryFontSize);
   m_fontInfo = new QFontMetrics(m_font);
+  m_clrChanged = cfg->m_clrMemoryChanged;
 
   update();
 }
@@ -97,6 +100,14 @@ int MemoryWidget::getHeaderHeight()
   return getRowHeight() + 5;
 }
 
+/**
+ * @brief Returns the number of rows that are visible.
+ */
+int MemoryWidget::getRowCount()
+{
+  return ((size().height() - getHeaderHeight()) / getRowHeight()) + 1;
+}
+
 char MemoryWidget::byteToChar(quint8 d)
 {
   char c;
@@ -115,6 +126,7 @@ void MemoryWidget::paintEvent(QPaintEvent* event)
   QColor headerBgColor = palette().color(QPalette::Window);
   QColor highLightBgColor = palette().color(QPalette::Highlight);
   QColor highLightColorText = palette().color(QPalette::HighlightedText);
+  QColor changedColorText = m_clrChanged;
 
   QPainter painter(this);
   const int ascent = m_fontInfo->ascent();
@@ -123,7 +135,7 @@ void MemoryWidget::paintEvent(QPaintEvent* event)
   QString text;
   int HEADER_HEIGHT = getHeaderHeight();
   int x;
-  int rowCount = ((size().height() - HEADER_HEIGHT) / rowHeight) + 1;
+  int rowCount = getRowCount();
 
   m_addrCharWidth = addrToString(m_startAddress + (rowCount * 16ULL)).length();
 
@@ -149,8 +161,12 @@ void MemoryWidget::paintEvent(QPaintEvent* event)
   painter.setFont(m_font);
 
   QByteArray content;
+  QByteArray changedMask;
   if (m_inf)
+  {
     content = m_inf->getMemory(startAddress, rowCount * BYTES_PER_ROW);
+    changedMask = m_inf->getChangedMask(startAddress, content.size());
+  }
 
   // if((0xffffffffU-startAddress) < rowCount*16)
   //    startAddress = 0xffffffffU-((rowCount-2)*16);
@@ -224,6 +240,7 @@ void MemoryWidget::paintEvent(QPaintEvent* event)
       {
         quint8 d = content[dataIdx];
 
+        painter.setPen(changedMask.at(dataIdx) ? changedColorText : textColor);
         if (selectionFirst != 0 || selectionLast != 0)
         {
           // Paint the selection marker
@@ -244,8 +261,6 @@ void MemoryWidget::paintEvent(QPaintEvent* event)
             painter.fillRect(bgRect, QBrush(highLightBgColor));
             painter.setPen(highLightColorText);
           }
-          else
-            painter.setPen(textColor);
         }
 
         text.sprintf("%02x", d);
@@ -265,6 +280,7 @@ void MemoryWidget::paintEvent(QPaintEvent* event)
       {
         char c2 = byteToChar(content[dataIdx]);
 
+        painter.setPen(changedMask.at(dataIdx) ? changedColorText : textColor);
         if (selectionFirst != 0 || selectionLast != 0)
         {
           if (selectionFirst <= off + memoryAddr && off + memoryAddr <= selectionLast)
@@ -274,8 +290,6 @@ void MemoryWidget::paintEvent(QPaintEvent* event)
 
             painter.setPen(highLightColorText);
           }
-          else
-            painter.setPen(textColor);
         }
 
         painter.drawText(x, y, QString(c2));
@@ -364,6 +378,15 @@ void MemoryWidget::mousePressEvent(QMouseEvent* event)
     // Add 'copy'
     QAction* action = m_popupMenu.addAction("Copy");
     connect(action, SIGNAL(triggered()), this, SLOT(onCopy()));
+    action = m_popupMenu.addAction("Save to file...");
+    connect(action, SIGNAL(triggered()), this, SLOT(onSaveToFile()));
+
+    // Add snapshot actions
+    m_popupMenu.addSeparator();
+    action = m_popupMenu.addAction("Take snapshot");
+    connect(action, SIGNAL(triggered()), this, SLOT(onTakeSnapshot()));
+    action = m_popupMenu.addAction("Clear snapshot");
+    connect(action, SIGNAL(triggered()), this, SLOT(onClearSnapshot()));
 
     m_popupMenu.popup(pos);
   }
@@ -376,6 +399,47 @@ void MemoryWidget::mousePressEvent(QMouseEvent* event)
   update();
 }
 
+/**
+ * @brief Saves the selected bytes to a file.
+ */
+void MemoryWidget::onSaveToFile()
+{
+  if (!m_inf)
+    return;
+
+  quint64 selectionFirst = qMin(m_selectionStart, m_selectionEnd);
+  quint64 selectionLast = qMax(m_selectionStart, m_selectionEnd);
+  m_inf->saveMemory(selectionFirst, selectionLast - selectionFirst + 1);
+}
+
+/**
+ * @brief Takes a snapshot of the selected bytes (or the visible bytes if nothing is selected).
+ * The bytes that differs from the snapshot are highlighted.
+ */
+void MemoryWidget::onTakeSnapshot()
+{
+  if (!m_inf)
+    return;
+
+  if (m_selectionStart != m_selectionEnd)
+  {
+    quint64 selectionFirst = qMin(m_selectionStart, m_selectionEnd);
+    quint64 selectionLast = qMax(m_selectionStart, m_selectionEnd);
+    m_inf->takeSnapshot(selectionFirst, selectionLast - selectionFirst + 1);
+  }
+  else
+    m_inf->takeSnapshot(m_startAddress, getRowCount() * BYTES_PER_ROW);
+}
+
+/**
+ * @brief Removes the snapshot (the changes since the previous stop are highlighted instead).
+ */
+void MemoryWidget::onClearSnapshot()
+{
+  if (m_inf)
+    m_inf->clearSnapshot();
+}
+
 void MemoryWidget::onCopy()
 {
   quint64 selectionFirst, selectionLast;
@@ -391,10 +455,18 @@ void MemoryWidget::onCopy()
     selectionLast = m_selectionEnd;
   }
 
+  // Too large to be formatted as text?
+  if (m_inf && selectionLast - selectionFirst >= MEMORY_MAX_COPY_SIZE)
+  {
+    infoMsg("The selection is too large to be copied, saving it to a file instead");
+    m_inf->saveMemory(selectionFirst, selectionLast - selectionFirst + 1);
+    return;
+  }
+
   if (m_inf)
   {
     QByteArray content;
-    content = m_inf->getMemory(selectionFirst, selectionLast - selectionFirst + 1);
+    content = m_inf->readMemory(selectionFirst, selectionLast - selectionFirst + 1);
 
     QString contentStr;
     QString subText;
@@ -11,7 +11,28 @@
 class IMemoryWidget
 {
 public:
+  /**
+   * @brief Returns the content of a memory area without blocking (may return less than count bytes).
+   */
   virtual QByteArray getMemory(quint64 startAddress, int count) = 0;
+
+  /**
+   * @brief Returns the content of a memory area and waits for it to be read if needed.
+   */
+  virtual QByteArray readMemory(quint64 startAddress, int count) = 0;
+
+  /**
+   * @brief Returns one byte for each address which is non zero if the byte has changed.
+   */
+  virtual QByteArray getChangedMask(quint64 startAddress, int count) = 0;
+
+  /**
+   * @brief Lets the user save a memory area (by default the one given) to a file.
+   */
+  virtual void saveMemory(quint64 startAddress, quint64 count) = 0;
+
+  virtual void takeSnapshot(quint64 startAddress, int count) = 0;
+  virtual void clearSnapshot() = 0;
 };
 
 class MemoryWidget : public QWidget
@@ -31,6 +52,7 @@ private:
   int getRowHeight();
   quint64 getAddrAtPos(QPoint pos);
   int getHeaderHeight();
+  int getRowCount();
   char byteToChar(quint8 d);
 
   virtual void keyPressEvent(QKeyEvent* e);
@@ -38,6 +60,9 @@ private:
 public slots:
   void setStartAddress(quint64 addr);
   void onCopy();
+  void onSaveToFile();
+  void onTakeSnapshot();
+  void onClearSnapshot();
 
 private:
   void mousePressEvent(QMouseEvent* event);
@@ -47,6 +72,7 @@ private:
 private:
   QFont m_font;
   QFontMetrics* m_fontInfo;
+  QColor m_clrChanged; //!< The color of the bytes that has changed.
 
   bool m_selectionStartValid;
   quint64 m_startAddress;
@@ -10,6 +10,7 @@
 
 #include "rusttagscanner.h"
 
+#include "keywordset.h"
 #include "log.h"
 #include "settings.h"
 #include "util.h"
@@ -21,13 +22,7 @@
 
 RustTagScanner::RustTagScanner()
   : m_cfg(NULL)
-
 {
-  QStringList keywordList = Settings::getDefaultRustKeywordList();
-  for (int u = 0; u < keywordList.size(); u++)
-  {
-    m_keywords[keywordList[u]] = true;
-  }
 }
 
 RustTagScanner::~RustTagScanner()
@@ -37,23 +32,28 @@ RustTagScanner::~RustTagScanner()
 
 int RustTagScanner::scan(QString filepath, QList<Tag>* taglist)
 {
-  m_filepath = filepath;
-
   // Open file
   QFile file(filepath);
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  if (!file.open(QIODevice::ReadOnly))
   {
     errorMsg("Failed to open '%s'", stringToCStr(filepath));
     return -1;
   }
 
-  // Read file content
-  QString text;
-  while (!file.atEnd())
-  {
-    QByteArray line = file.readLine();
-    text += line;
-  }
+  return scanBuffer(filepath, file.readAll(), taglist);
+}
+
+/**
+ * @brief Scans the content of a file for tags.
+ * @param filepath   The file that the content was read from.
+ */
+int RustTagScanner::scanBuffer(QString filepath, const QByteArray& content, QList<Tag>* taglist)
+{
+  m_filepath = filepath;
+
+  // The line endings as if the file was read in text mode
+  QString text = QString::fromUtf8(content);
+  text.replace("\r\n", "\n");
 
   tokenize(text);
 
@@ -231,27 +231,9 @@ bool RustTagScanner::isSpecialChar(char c) const
     return false;
 }
 
-bool RustTagScanner::isSpecialChar(TextField* field) const
-{
-  if (field->m_text.size() == 1)
-  {
-    return isSpecialChar(field->m_text[0].toLatin1());
-  }
-  return false;
-}
-
 bool RustTagScanner::isKeyword(QString text) const
 {
-  if (text.size() == 0)
-    return false;
-  if (m_keywords.contains(text))
-  {
-    return true;
-  }
-  else
-  {
-    return false;
-  }
+  return g_rustKeywords.contains(text);
 }
 
 void RustTagScanner::setConfig(Settings* cfg)
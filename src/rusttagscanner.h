@@ -24,6 +24,7 @@ public:
   virtual ~RustTagScanner();
 
   int scan(QString filepath, QList<Tag>* taglist);
+  int scanBuffer(QString filepath, const QByteArray& content, QList<Tag>* taglist);
 
   void setConfig(Settings* cfg);
 
@@ -34,7 +35,6 @@ private:
 
   bool isKeyword(QString text) const;
   bool isSpecialChar(char c) const;
-  bool isSpecialChar(TextField* field) const;
 
 private:
   class Token
@@ -98,7 +98,6 @@ private:
 
 private:
   Settings* m_cfg;
-  QHash<QString, bool> m_keywords;
   QString m_filepath;
   QList<Token*> m_tokens;
 };
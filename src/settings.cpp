@@ -74,6 +74,7 @@ void Settings::loadDefaultsGui()
   m_clrNumber = Qt::magenta;
   m_clrForeground = Qt::white;
   m_clrSelection = QColor(100, 100, 100);
+  m_clrMemoryChanged = Qt::red;
 
   m_tagSortByName = false;
   m_tagShowLineNumbers = true;
@@ -229,6 +230,7 @@ void Settings::loadGlobalConfig()
   m_clrNumber = tmpIni.getColor("GuiColor/ColorNumber", Qt::magenta);
   m_clrForeground = tmpIni.getColor("GuiColor/ColorForeGround", Qt::white);
   m_clrSelection = tmpIni.getColor("GuiColor/ColorSelection", m_clrSelection);
+  m_clrMemoryChanged = tmpIni.getColor("GuiColor/ColorMemoryChanged", m_clrMemoryChanged);
 
   m_progConScrollback = std::max(1, tmpIni.getInt("ProgramConsole/Scrollback", m_progConScrollback));
   m_progConColorFg = tmpIni.getColor("ProgramConsole/ColorForeground", m_progConColorFg);
@@ -440,6 +442,7 @@ void Settings::saveGlobalConfig()
   tmpIni.setColor("GuiColor/ColorNumber", m_clrNumber);
   tmpIni.setColor("GuiColor/ColorForeGround", m_clrForeground);
   tmpIni.setColor("GuiColor/ColorSelection", m_clrSelection);
+  tmpIni.setColor("GuiColor/ColorMemoryChanged", m_clrMemoryChanged);
 
   tmpIni.setInt("ProgramConsole/Scrollback", m_progConScrollback);
 
@@ -461,270 +464,6 @@ void Settings::saveGlobalConfig()
     infoMsg("Failed to save '%s'", stringToCStr(globalConfigFilename));
 }
 
-QStringList Settings::getDefaultCppKeywordList()
-{
-  QStringList keywordList;
-  keywordList += "#";
-  keywordList += "if";
-  keywordList += "else";
-  keywordList += "def";
-  keywordList += "defined";
-  keywordList += "define";
-  keywordList += "ifdef";
-  keywordList += "endif";
-  keywordList += "ifndef";
-  keywordList += "include";
-  keywordList += "error";
-  keywordList += "elif";
-  keywordList += "warning";
-
-  return keywordList;
-}
-
-QStringList Settings::getDefaultCxxKeywordList()
-{
-  QStringList keywordList;
-  keywordList += "if";
-  keywordList += "for";
-  keywordList += "while";
-  keywordList += "switch";
-  keywordList += "case";
-  keywordList += "else";
-  keywordList += "do";
-  keywordList += "false";
-  keywordList += "true";
-  keywordList += "default";
-
-  keywordList += "sizeof";
-  keywordList += "typedef";
-
-  keywordList += "enum";
-  keywordList += "unsigned";
-  keywordList += "bool";
-  keywordList += "int";
-  keywordList += "short";
-  keywordList += "long";
-  keywordList += "float";
-  keywordList += "double";
-  keywordList += "void";
-  keywordList += "char";
-  keywordList += "struct";
-
-  keywordList += "class";
-  keywordList += "static";
-  keywordList += "volatile";
-  keywordList += "new";
-  keywordList += "const";
-
-  keywordList += "return";
-  keywordList += "break";
-  keywordList += "continue";
-
-  keywordList += "uint32_t";
-  keywordList += "uint16_t";
-  keywordList += "uint8_t";
-  keywordList += "int32_t";
-  keywordList += "int16_t";
-  keywordList += "int8_t";
-
-  keywordList += "quint32";
-  keywordList += "quint16";
-  keywordList += "quint8";
-  keywordList += "qint32";
-  keywordList += "qint16";
-  keywordList += "qint8";
-
-  return keywordList;
-}
-
-QStringList Settings::getDefaultGoKeywordList()
-{
-  QStringList keywordList;
-
-  keywordList += "break";
-  keywordList += "case";
-  keywordList += "chan";
-  keywordList += "const";
-  keywordList += "continue";
-  keywordList += "default";
-  keywordList += "defer";
-  keywordList += "else";
-  keywordList += "fallthrough";
-  keywordList += "for";
-  keywordList += "func";
-  keywordList += "go";
-  keywordList += "goto";
-  keywordList += "if";
-  keywordList += "import";
-  keywordList += "interface";
-  keywordList += "map";
-  keywordList += "package";
-  keywordList += "range";
-  keywordList += "return";
-  keywordList += "select";
-  keywordList += "struct";
-  keywordList += "switch";
-  keywordList += "type";
-  keywordList += "var";
-
-  return keywordList;
-}
-
-QStringList Settings::getDefaultAdaKeywordList()
-{
-  QStringList keywordList;
-
-  keywordList += "if";
-  keywordList += "loop";
-  keywordList += "for";
-  keywordList += "begin";
-  keywordList += "end";
-  keywordList += "then";
-  keywordList += "return";
-
-  keywordList += "with";
-  keywordList += "use";
-  keywordList += "in";
-  keywordList += "is";
-  keywordList += "of";
-
-  keywordList += "procedure";
-  keywordList += "function";
-
-  keywordList += "pragma";
-  keywordList += "renames";
-  keywordList += "import";
-
-  keywordList += "integer";
-  keywordList += "array";
-  keywordList += "string";
-  keywordList += "character";
-  keywordList += "natural";
-
-  return keywordList;
-}
-
-QStringList Settings::getDefaultRustKeywordList()
-{
-  QStringList keywordList;
-
-  //
-  keywordList += "as";
-  keywordList += "break";
-  keywordList += "const";
-  keywordList += "continue";
-  keywordList += "crate";
-  keywordList += "else";
-  keywordList += "enum";
-  keywordList += "extern";
-  keywordList += "false";
-  keywordList += "fn";
-  keywordList += "for";
-  keywordList += "if";
-  keywordList += "impl";
-  keywordList += "in";
-  keywordList += "let";
-  keywordList += "loop";
-  keywordList += "match";
-  keywordList += "mod";
-  keywordList += "move";
-  keywordList += "mut";
-  keywordList += "pub";
-  keywordList += "ref";
-  keywordList += "return";
-  keywordList += "self";
-  keywordList += "static";
-  keywordList += "struct";
-  keywordList += "super";
-  keywordList += "trait";
-  keywordList += "true";
-  keywordList += "type";
-  keywordList += "unsafe";
-  keywordList += "use";
-  keywordList += "where";
-  keywordList += "while";
-  keywordList += "yield";
-
-  keywordList += "println";
-  keywordList += "println!";
-
-  keywordList += "i64";
-  keywordList += "i32";
-  keywordList += "i8";
-  keywordList += "i16";
-  keywordList += "u64";
-  keywordList += "u32";
-  keywordList += "u8";
-  keywordList += "u16";
-  keywordList += "f32";
-  keywordList += "f64";
-
-  keywordList += "bool";
-
-  return keywordList;
-}
-
-QStringList Settings::getDefaultBasicKeywordList()
-{
-  QStringList keywordList;
-
-  keywordList += "print";
-  keywordList += "input";
-  keywordList += "sleep";
-  keywordList += "return";
-
-  keywordList += "do";
-  keywordList += "loop";
-  keywordList += "until";
-  keywordList += "declare";
-  keywordList += "select";
-  keywordList += "case";
-
-  keywordList += "cls";
-  keywordList += "function";
-  keywordList += "sub";
-  keywordList += "as";
-  keywordList += "end";
-  keywordList += "dim";
-
-  keywordList += "byte";
-  keywordList += "const";
-  keywordList += "double";
-  keywordList += "enum";
-  keywordList += "integer";
-  keywordList += "long";
-  keywordList += "longint";
-  keywordList += "short";
-  keywordList += "string";
-  keywordList += "ubyte";
-  keywordList += "uinteger";
-  keywordList += "ulongint";
-  keywordList += "union";
-  keywordList += "unsigned";
-  keywordList += "ushort";
-  keywordList += "wstring";
-  keywordList += "zstring";
-
-  return keywordList;
-}
-
-QStringList Settings::getDefaultFortranKeywordList()
-{
-  QStringList keywordList;
-
-  keywordList += "print";
-
-  keywordList += "subroutine";
-  keywordList += "program";
-
-  keywordList += "end";
-  keywordList += "call";
-
-  keywordList += "real";
-
-  return keywordList;
-}
-
 /**
  * @brief Returns the path of the program to debug
  */
@@ -11,6 +11,7 @@
 
 #include "ini.h"
 
+#include <QColor>
 #include <QString>
 #include <QStringList>
 
@@ -41,14 +42,6 @@ public:
   void loadDefaultsGui();
   void loadDefaultsAdvanced();
 
-  static QStringList getDefaultCxxKeywordList();
-  static QStringList getDefaultCppKeywordList();
-  static QStringList getDefaultBasicKeywordList();
-  static QStringList getDefaultRustKeywordList();
-  static QStringList getDefaultAdaKeywordList();
-  static QStringList getDefaultFortranKeywordList();
-  static QStringList getDefaultGoKeywordList();
-
   QString getProgramPath() const;
   void setProgramPath(QString path);
 
@@ -119,6 +112,7 @@ public:
   QColor m_clrNumber;
   QColor m_clrForeground;
   QColor m_clrSelection; // Selection in codeview
+  QColor m_clrMemoryChanged; // Changed bytes in the memory view
 
   QByteArray m_gui_mainwindowState;
   QByteArray m_gui_mainwindowGeometry;
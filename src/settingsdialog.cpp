@@ -110,6 +110,7 @@ void SettingsDialog::loadConfig()
   m_ui.pushButton_clr_number->setColor(m_cfg->m_clrNumber);
   m_ui.pushButton_clr_foreground->setColor(m_cfg->m_clrForeground);
   m_ui.pushButton_clr_selection->setColor(m_cfg->m_clrSelection);
+  m_ui.pushButton_clr_memoryChanged->setColor(m_cfg->m_clrMemoryChanged);
 
   m_ui.checkBox_showLineNo->setCheckState(m_cfg->m_showLineNo ? Qt::Checked : Qt::Unchecked);
 
@@ -213,6 +214,7 @@ void SettingsDialog::getConfig(Settings* cfg)
   cfg->m_clrNumber = m_ui.pushButton_clr_number->getColor();
   cfg->m_clrForeground = m_ui.pushButton_clr_foreground->getColor();
   cfg->m_clrSelection = m_ui.pushButton_clr_selection->getColor();
+  cfg->m_clrMemoryChanged = m_ui.pushButton_clr_memoryChanged->getColor();
 
   int comboIdx = m_ui.comboBox_sortTags->currentIndex();
   if (comboIdx == 0)
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2014-2017 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__SPSCRING_H
+#define FILE__SPSCRING_H
+
+#include <QAtomicInt>
+
+/**
+ * @brief Lock-free ring buffer for one producer thread and one consumer thread.
+ * The producer only writes m_head and the consumer only writes m_tail.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+  /**
+   * @param capacity   The max number of items (must be a power of two).
+   */
+  explicit SpscRing(int capacity)
+    : m_items(new T[capacity])
+    , m_mask(capacity - 1)
+    , m_head(0)
+    , m_tail(0)
+  {
+    Q_ASSERT((capacity & (capacity - 1)) == 0);
+  };
+  ~SpscRing()
+  {
+    delete[] m_items;
+  };
+
+  /**
+   * @brief Adds an item (may only be called by the producer).
+   * @return false if the ring is full.
+   */
+  bool push(const T& item)
+  {
+    unsigned int head = (unsigned int) m_head.loadAcquire();
+    unsigned int tail = (unsigned int) m_tail.loadAcquire();
+    if (head - tail > (unsigned int) m_mask)
+      return false;
+    m_items[head & m_mask] = item;
+    m_head.storeRelease((int) (head + 1));
+    return true;
+  };
+
+  /**
+   * @brief Removes the oldest item (may only be called by the consumer).
+   * @return false if the ring is empty.
+   */
+  bool pop(T* item)
+  {
+    unsigned int tail = (unsigned int) m_tail.loadAcquire();
+    if ((unsigned int) m_head.loadAcquire() == tail)
+      return false;
+    *item = m_items[tail & m_mask];
+    m_tail.storeRelease((int) (tail + 1));
+    return true;
+  };
+
+private:
+  SpscRing(const SpscRing&);
+
+private:
+  T* m_items;
+  int m_mask;
+  QAtomicInt m_head; //!< Number of items pushed.
+  QAtomicInt m_tail; //!< Number of items popped.
+};
+
+#endif // FILE__SPSCRING_H
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+//#define ENABLE_DEBUGMSG
+
+#include "symbolindex.h"
+
+#include "log.h"
+#include "util.h"
+
+SymbolIndex::SymbolIndex()
+{
+}
+
+SymbolIndex::~SymbolIndex()
+{
+}
+
+/**
+ * @brief Returns the name used to find a tag (Eg: "main" or "Class::myFunc").
+ */
+QString SymbolIndex::getLongName(const Tag& tag)
+{
+  if (tag.m_className.isEmpty())
+    return tag.m_name;
+  return tag.m_className + "::" + tag.m_name;
+}
+
+/**
+ * @brief Adds the tags of a file.
+ */
+void SymbolIndex::addFile(const ScannerResult* result)
+{
+  for (int i = 0; i < result->m_tagList.size(); i++)
+  {
+    SymbolRef ref;
+    ref.m_result = result;
+    ref.m_tagIdx = i;
+
+    QString longName = getLongName(result->m_tagList.at(i));
+    m_names.insert(longName, ref);
+    m_sortedNames.insert(longName, ref);
+  }
+}
+
+/**
+ * @brief Removes the tags of a file that has been added with addFile().
+ */
+void SymbolIndex::removeFile(const ScannerResult* result)
+{
+  for (int i = 0; i < result->m_tagList.size(); i++)
+  {
+    SymbolRef ref;
+    ref.m_result = result;
+    ref.m_tagIdx = i;
+
+    QString longName = getLongName(result->m_tagList.at(i));
+    m_names.remove(longName, ref);
+    m_sortedNames.remove(longName, ref);
+  }
+}
+
+void SymbolIndex::clear()
+{
+  m_names.clear();
+  m_sortedNames.clear();
+}
+
+/**
+ * @brief Finds the tags with a specific name.
+ * @param longName   The name of the tag (Eg: "main" or "Class::myFunc").
+ * @return tagList   The found tags.
+ */
+void SymbolIndex::lookup(QString longName, QList<Tag>* tagList) const
+{
+  QMultiHash<QString, SymbolRef>::const_iterator it = m_names.constFind(longName);
+  for (; it != m_names.constEnd() && it.key() == longName; ++it)
+  {
+    const SymbolRef& ref = it.value();
+    tagList->append(ref.m_result->m_tagList.at(ref.m_tagIdx));
+  }
+}
+
+/**
+ * @brief Finds the tags which long name starts with a string (sorted by the name).
+ * @param onlyFuncs   Only return functions.
+ * @param maxCount    Max number of tags to return.
+ */
+void SymbolIndex::findByPrefix(QString prefix, bool onlyFuncs, int maxCount, QList<Tag>* tagList) const
+{
+  int foundCount = 0;
+  QMultiMap<QString, SymbolRef>::const_iterator it = m_sortedNames.lowerBound(prefix);
+  for (; it != m_sortedNames.constEnd() && foundCount < maxCount; ++it)
+  {
+    if (!it.key().startsWith(prefix))
+      break;
+
+    const SymbolRef& ref = it.value();
+    const Tag& tag = ref.m_result->m_tagList.at(ref.m_tagIdx);
+    if (onlyFuncs && !tag.isFunc())
+      continue;
+
+    tagList->append(tag);
+    foundCount++;
+  }
+}
+
+/**
+ * @brief Returns the long names of all tags (sorted and without duplicates).
+ * @param onlyFuncs   Only return the names of functions.
+ */
+void SymbolIndex::getNames(bool onlyFuncs, QStringList* nameList) const
+{
+  QMultiMap<QString, SymbolRef>::const_iterator it = m_sortedNames.constBegin();
+  for (; it != m_sortedNames.constEnd(); ++it)
+  {
+    const SymbolRef& ref = it.value();
+    if (onlyFuncs && !ref.m_result->m_tagList.at(ref.m_tagIdx).isFunc())
+      continue;
+    if (!nameList->isEmpty() && nameList->last() == it.key())
+      continue;
+    nameList->append(it.key());
+  }
+}
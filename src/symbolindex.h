@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__SYMBOLINDEX_H
+#define FILE__SYMBOLINDEX_H
+
+#include "tagindex.h"
+#include "tagscanner.h"
+
+#include <QList>
+#include <QMultiHash>
+#include <QMultiMap>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Index of the tags in all scanned files.
+ *
+ * The tags are found by their long name ("Class::name" or "name") through a hash
+ * and by the start of their long name through a sorted map.
+ * The index refers to the tags of the ScannerResult objects, so a result must be removed
+ * from the index before it is deleted and its tag list must not be modified while it is in the index.
+ */
+class SymbolIndex
+{
+public:
+  SymbolIndex();
+  ~SymbolIndex();
+
+  void addFile(const ScannerResult* result);
+  void removeFile(const ScannerResult* result);
+  void clear();
+
+  void lookup(QString longName, QList<Tag>* tagList) const;
+  void findByPrefix(QString prefix, bool onlyFuncs, int maxCount, QList<Tag>* tagList) const;
+  void getNames(bool onlyFuncs, QStringList* nameList) const;
+
+  int getCount() const
+  {
+    return m_names.size();
+  };
+
+  static QString getLongName(const Tag& tag);
+
+private:
+  struct SymbolRef
+  {
+    const ScannerResult* m_result;
+    int m_tagIdx;
+
+    bool operator==(const SymbolRef& other) const
+    {
+      return m_result == other.m_result && m_tagIdx == other.m_tagIdx;
+    };
+  };
+
+private:
+  QMultiHash<QString, SymbolRef> m_names; //!< Long name -> tag.
+  QMultiMap<QString, SymbolRef> m_sortedNames; //!< Long name -> tag (sorted for prefix searches).
+};
+
+#endif // FILE__SYMBOLINDEX_H
@@ -7,3 +7,384 @@
  */
 
 #include "syntaxhighlighter.h"
+
+#include "keywordset.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <ctype.h>
+#include <string.h>
+
+// The classes of a character (see SyntaxHighlighter::getCharClass())
+enum
+{
+  CHAR_SPECIAL = 0x1, //!< Ends a word and is a field of its own.
+  CHAR_SPACE = 0x2,
+  CHAR_WORD_END = 0x4,
+  CHAR_DIGIT = 0x8
+};
+
+/**
+ * @brief Checks if a text starts with a string.
+ */
+static bool startsWith(const QChar* str, int len, const char* prefix)
+{
+  int i = 0;
+  for (; prefix[i] != '\0'; i++)
+  {
+    if (i >= len || str[i] != QLatin1Char(prefix[i]))
+      return false;
+  }
+  return i > 0;
+}
+
+/**
+ * @brief Checks if a text is a word (ignoring the case of ASCII letters).
+ */
+static bool isSameWord(const QChar* str, int len, const char* word)
+{
+  int i = 0;
+  for (; i < len && word[i] != '\0'; i++)
+  {
+    if (QChar::toLower(str[i].unicode()) != (uint) tolower(word[i]))
+      return false;
+  }
+  return i == len && word[i] == '\0';
+}
+
+/**
+ * @brief Returns the text of all fields in the row.
+ */
+QString TextRow::getText() const
+{
+  if (m_count == 0)
+    return QString();
+  const TextRun& lastRun = m_runs[m_count - 1];
+  return m_text->mid(m_runs[0].m_start, lastRun.m_start + lastRun.m_length - m_runs[0].m_start);
+}
+
+SyntaxHighlighter::SyntaxHighlighter(const SyntaxLanguage& language, const KeywordSet& keywords)
+  : m_language(language)
+  , m_keywords(keywords)
+{
+  memset(m_charClass, 0, sizeof(m_charClass));
+  for (const char* c = language.m_specialChars; *c != '\0'; c++)
+    m_charClass[(int) *c] |= CHAR_SPECIAL | CHAR_WORD_END;
+  m_charClass[(int) ' '] |= CHAR_SPACE | CHAR_WORD_END;
+  m_charClass[(int) '\t'] |= CHAR_SPACE | CHAR_WORD_END;
+  m_charClass[(int) '\n'] |= CHAR_WORD_END;
+  m_charClass[(int) '"'] |= CHAR_WORD_END;
+  for (int c = '0'; c <= '9'; c++)
+    m_charClass[c] |= CHAR_DIGIT;
+}
+
+/**
+ * @brief Checks if a string is a keyword.
+ */
+bool SyntaxHighlighter::isKeyword(QString text) const
+{
+  return m_keywords.contains(text);
+}
+
+/**
+ * @brief Checks if a character is a special character.
+ * @return Returns true if the character is a special character (Eg: '\t').
+ */
+bool SyntaxHighlighter::isSpecialChar(char c) const
+{
+  return (getCharClass(QLatin1Char(c)) & CHAR_SPECIAL) ? true : false;
+}
+
+/**
+ * @brief Creates the row for a number of lines of text.
+ * @param startState   The state at the start of the text (LINE_STATE_NORMAL for the start of a file).
+ * @return The state at the start of the line after the text.
+ */
+int SyntaxHighlighter::colorize(QString text, int startState)
+{
+  const SyntaxLanguage& lang = m_language;
+  const QChar* str = text.constData();
+  const int len = text.size();
+  bool isCppRow = false;
+  bool isInComment = false;
+
+  reset();
+
+  addRow();
+
+  // Continuing a comment from the previous lines?
+  if (startState == LINE_STATE_COMMENT && lang.m_blockCommentBegin)
+  {
+    isInComment = true;
+    addField(TextRun::COMMENT);
+  }
+
+  int i = 0;
+  while (i < len)
+  {
+    QChar c = str[i];
+    int charClass = getCharClass(c);
+    int end = i + 1;
+
+    if (c == '\n')
+    {
+      addRow();
+      isCppRow = false;
+
+      if (isInComment)
+        addField(TextRun::COMMENT);
+    }
+    else if (isInComment)
+    {
+      end = i;
+      while (end < len && str[end] != '\n' && !startsWith(str + end, len - end, lang.m_blockCommentEnd))
+        end++;
+      if (end < len && str[end] != '\n')
+      {
+        end += strlen(lang.m_blockCommentEnd);
+        isInComment = false;
+      }
+      appendText(str + i, end - i);
+    }
+    else if (lang.m_blockCommentBegin && startsWith(str + i, len - i, lang.m_blockCommentBegin))
+    {
+      end = i + strlen(lang.m_blockCommentBegin);
+      isInComment = true;
+      addField(TextRun::COMMENT);
+      appendText(str + i, end - i);
+    }
+    else if (lang.m_lineComment && startsWith(str + i, len - i, lang.m_lineComment))
+    {
+      while (end < len && str[end] != '\n')
+        end++;
+      addField(TextRun::COMMENT);
+      appendText(str + i, end - i);
+    }
+    else if (charClass & CHAR_SPACE)
+    {
+      while (end < len && (getCharClass(str[end]) & CHAR_SPACE))
+        end++;
+      addField(TextRun::SPACES);
+      appendText(str + i, end - i);
+    }
+    else if (c == '"' || (lang.m_charQuote != '\0' && c == QLatin1Char(lang.m_charQuote)))
+    {
+      end = scanString(str, len, i, c);
+      addField((isCppRow && c == '"') ? TextRun::INC_STRING : TextRun::STRING);
+      appendText(str + i, end - i);
+    }
+    // A '#include <file>'?
+    else if (c == '<' && isCppRow && isLastNonSpaceField("include"))
+    {
+      end = scanString(str, len, i, '>');
+      addField(TextRun::INC_STRING);
+      appendText(str + i, end - i);
+    }
+    else if (c == '#' && lang.m_hasPreprocessor)
+    {
+      // Only spaces before the '#' at the line?
+      bool onlySpaces = true;
+      for (int j = 0; onlySpaces == true && j < getRowFieldCount(); j++)
+      {
+        if (getRowFieldType(j) != TextRun::SPACES && getRowFieldType(j) != TextRun::COMMENT)
+        {
+          onlySpaces = false;
+        }
+      }
+      isCppRow = onlySpaces;
+
+      addField(isCppRow ? TextRun::CPP_KEYWORD : TextRun::WORD, c);
+    }
+    // An '->' token?
+    else if (c == '>' && lang.m_joinArrow && isLastField("-"))
+    {
+      appendText(str + i, 1);
+    }
+    else if (charClass & CHAR_SPECIAL)
+    {
+      addField(TextRun::WORD, c);
+    }
+    else
+    {
+      while (end < len && !(getCharClass(str[end]) & CHAR_WORD_END))
+        end++;
+
+      if (lang.m_commentWord && isSameWord(str + i, end - i, lang.m_commentWord))
+      {
+        while (end < len && str[end] != '\n')
+          end++;
+        addField(TextRun::COMMENT);
+      }
+      else if (charClass & CHAR_DIGIT)
+        addField(TextRun::NUMBER);
+      else if (isCppRow)
+        addField(g_cppKeywords.contains(str + i, end - i) ? TextRun::CPP_KEYWORD : TextRun::WORD);
+      else
+        addField(m_keywords.contains(str + i, end - i) ? TextRun::KEYWORD : TextRun::WORD);
+      appendText(str + i, end - i);
+    }
+
+    i = end;
+  }
+
+  return isInComment ? LINE_STATE_COMMENT : LINE_STATE_NORMAL;
+}
+
+/**
+ * @brief Finds the end of a string (or a character literal).
+ * The string ends at the end of the line if it is not terminated.
+ * @param startIdx   The index of the start quote.
+ * @return The index after the string.
+ */
+int SyntaxHighlighter::scanString(const QChar* str, int len, int startIdx, QChar endChar) const
+{
+  int i = startIdx + 1;
+  while (i < len && str[i] != '\n')
+  {
+    if (str[i] == '\\' && i + 1 < len && str[i + 1] != '\n')
+      i += 2;
+    else if (str[i++] == endChar)
+      return i;
+  }
+  return i;
+}
+
+/**
+ * @brief Checks if the last field in the last row has a specific text.
+ */
+bool SyntaxHighlighter::isLastField(const char* text) const
+{
+  if (getRowFieldCount() == 0)
+    return false;
+  const TextRun& run = m_runs.last();
+  return isSameWord(m_text.constData() + run.m_start, run.m_length, text);
+}
+
+/**
+ * @brief Checks if the last field in the last row that is not spaces or a comment has a specific text.
+ */
+bool SyntaxHighlighter::isLastNonSpaceField(const char* text) const
+{
+  int fieldIdx = findLastNonSpaceField();
+  if (fieldIdx == -1)
+    return false;
+  const TextRun& run = m_runs[m_rowStarts.last() + fieldIdx];
+  return isSameWord(m_text.constData() + run.m_start, run.m_length, text);
+}
+
+/**
+ * @brief Returns a text row.
+ * @param rowIdx   The row to get (0=first row).
+ */
+TextRow SyntaxHighlighter::getRow(unsigned int rowIdx) const
+{
+  assert(rowIdx < getRowCount());
+
+  int firstRunIdx = m_rowStarts[rowIdx];
+  int endRunIdx = (int) rowIdx + 1 < m_rowStarts.size() ? m_rowStarts[rowIdx + 1] : m_runs.size();
+  return TextRow(&m_text, m_runs.constData() + firstRunIdx, endRunIdx - firstRunIdx);
+}
+
+/**
+ * @brief Removes all the rows.
+ */
+void SyntaxHighlighter::reset()
+{
+  m_text.clear();
+  m_runs.clear();
+  m_rowStarts.clear();
+}
+
+/**
+ * @brief Checks if the text of a field is a special character (eg: '>').
+ */
+bool SyntaxHighlighter::isSpecialField(QString text) const
+{
+  if (text.size() == 1)
+  {
+    return isSpecialChar(text[0].toLatin1());
+  }
+  return false;
+}
+
+/**
+ * @brief Starts a new row.
+ */
+void SyntaxHighlighter::addRow()
+{
+  m_rowStarts.append(m_runs.size());
+}
+
+/**
+ * @brief Adds an empty field to the end of the last row.
+ */
+void SyntaxHighlighter::addField(int type)
+{
+  assert(!m_rowStarts.isEmpty());
+
+  TextRun run;
+  run.m_start = m_text.size();
+  run.m_length = 0;
+  run.m_type = type;
+  m_runs.append(run);
+}
+
+/**
+ * @brief Adds a field with a character to the end of the last row.
+ */
+void SyntaxHighlighter::addField(int type, QChar c)
+{
+  addField(type);
+  appendText(&c, 1);
+}
+
+/**
+ * @brief Appends characters to the last field.
+ */
+void SyntaxHighlighter::appendText(const QChar* str, int len)
+{
+  assert(!m_runs.isEmpty());
+
+  while (len > 0)
+  {
+    if (m_runs.last().m_length == TEXT_RUN_MAX_LENGTH)
+      addField(m_runs.last().m_type);
+
+    int count = std::min(len, (int) (TEXT_RUN_MAX_LENGTH - m_runs.last().m_length));
+    m_text.append(str, count);
+    m_runs.last().m_length += count;
+    str += count;
+    len -= count;
+  }
+}
+
+/**
+ * @brief Returns the number of fields in the last row.
+ */
+int SyntaxHighlighter::getRowFieldCount() const
+{
+  return m_runs.size() - m_rowStarts.last();
+}
+
+/**
+ * @brief Returns the type of a field in the last row.
+ */
+int SyntaxHighlighter::getRowFieldType(int fieldIdx) const
+{
+  return m_runs[m_rowStarts.last() + fieldIdx].m_type;
+}
+
+/**
+ * @brief Returns the last field in the last row that is not spaces or a comment.
+ * @return The index of the field in the row or -1 if there is none.
+ */
+int SyntaxHighlighter::findLastNonSpaceField() const
+{
+  for (int j = getRowFieldCount() - 1; j >= 0; j--)
+  {
+    int type = getRowFieldType(j);
+    if (type != TextRun::SPACES && type != TextRun::COMMENT)
+      return j;
+  }
+  return -1;
+}
@@ -9,18 +9,16 @@
 #ifndef FILE__SYNTAXHIGHLIGHTER
 #define FILE__SYNTAXHIGHLIGHTER
 
-#include "settings.h"
-
 #include <QColor>
-#include <QHash>
 #include <QString>
 #include <QVector>
 
-struct TextField
+/**
+ * @brief A number of characters in a row that has the same type.
+ */
+struct TextRun
 {
-  QColor m_color;
-  QString m_text;
-  enum
+  enum Type
   {
     COMMENT,
     WORD,
@@ -29,39 +27,137 @@ struct TextField
     CPP_KEYWORD,
     INC_STRING,
     STRING,
-    SPACES
-  } m_type;
+    SPACES,
+    PLAIN, //!< Text that has not been colorized yet.
+    TYPE_COUNT
+  };
+
+  quint32 m_start; //!< Index of the first character in the text of the highlighter.
+  quint32 m_length : 24;
+  quint32 m_type : 8; //!< The Type (also the index in the style palette, see CodeView::setConfig()).
+};
+
+// Max number of characters in a TextRun (longer fields are split in several runs)
+#define TEXT_RUN_MAX_LENGTH 0xffffff
+
+/**
+ * @brief The fields of a row.
+ * Only refers to the text and runs stored in the highlighter (valid until the next colorize() or reset()).
+ */
+class TextRow
+{
+public:
+  TextRow()
+    : m_text(NULL)
+    , m_runs(NULL)
+    , m_count(0){};
+  TextRow(const QString* text, const TextRun* runs, int count)
+    : m_text(text)
+    , m_runs(runs)
+    , m_count(count){};
 
-  bool isHash() const
+  int getFieldCount() const
   {
-    return m_text == "#" ? true : false;
+    return m_count;
   };
-  bool isSpaces() const
+  int getType(int fieldIdx) const
   {
-    return m_type == SPACES ? true : false;
+    return m_runs[fieldIdx].m_type;
   };
-  int getLength()
+  int getLength(int fieldIdx) const
   {
-    return m_text.length();
+    return m_runs[fieldIdx].m_length;
   };
+  QStringRef getText(int fieldIdx) const
+  {
+    return QStringRef(m_text, m_runs[fieldIdx].m_start, m_runs[fieldIdx].m_length);
+  };
+  bool isSpaces(int fieldIdx) const
+  {
+    return m_runs[fieldIdx].m_type == TextRun::SPACES ? true : false;
+  };
+
+  QString getText() const;
+
+private:
+  const QString* m_text;
+  const TextRun* m_runs;
+  int m_count;
+};
+
+class KeywordSet;
+
+/**
+ * @brief The lexical rules of a language.
+ * All languages are colorized by the same lexer in SyntaxHighlighter, driven by one of these.
+ */
+struct SyntaxLanguage
+{
+  const char* m_specialChars; //!< Characters that ends a word and are a field of their own.
+  const char* m_lineComment; //!< Starts a comment that ends at the end of the line (or NULL).
+  const char* m_blockCommentBegin; //!< Starts a comment that may span several lines (or NULL).
+  const char* m_blockCommentEnd;
+  const char* m_commentWord; //!< A word that starts a line comment, eg: "rem" (or NULL).
+  char m_charQuote; //!< Quote of character literals (or 0).
+  bool m_hasPreprocessor; //!< Lines starting with '#' are preprocessor directives.
+  bool m_joinArrow; //!< Colorize "->" as one field.
 };
 
 class SyntaxHighlighter
 {
 public:
-  SyntaxHighlighter(){};
+  /**
+   * @brief The state of the highlighter at the start of a line.
+   * Makes it possible to colorize a file in blocks of lines.
+   */
+  enum
+  {
+    LINE_STATE_NORMAL = 0,
+    LINE_STATE_COMMENT //!< Inside a multiline comment.
+  };
+
+  SyntaxHighlighter(const SyntaxLanguage& language, const KeywordSet& keywords);
   virtual ~SyntaxHighlighter(){};
 
-  virtual void colorize(QString text) = 0;
+  int colorize(QString text, int startState);
+
+  TextRow getRow(unsigned int rowIdx) const;
+  unsigned int getRowCount() const
+  {
+    return m_rowStarts.size();
+  };
+  void reset();
+
+  bool isKeyword(QString text) const;
+  bool isSpecialChar(char c) const;
+  bool isSpecialField(QString text) const;
+
+private:
+  int getCharClass(QChar c) const
+  {
+    return c.unicode() < 128 ? m_charClass[c.unicode()] : 0;
+  };
+  int scanString(const QChar* str, int len, int startIdx, QChar endChar) const;
+  bool isLastField(const char* text) const;
+  bool isLastNonSpaceField(const char* text) const;
+
+  void addRow();
+  void addField(int type);
+  void addField(int type, QChar c);
+  void appendText(const QChar* str, int len);
+
+  int getRowFieldCount() const;
+  int getRowFieldType(int fieldIdx) const;
+  int findLastNonSpaceField() const;
 
-  virtual QVector<TextField*> getRow(unsigned int rowIdx) = 0;
-  virtual unsigned int getRowCount() = 0;
-  virtual void reset() = 0;
+private:
+  const SyntaxLanguage& m_language;
+  const KeywordSet& m_keywords;
+  quint8 m_charClass[128]; //!< The class (CHAR_SPECIAL, ...) of the ASCII characters.
 
-  virtual bool isKeyword(QString text) const = 0;
-  virtual bool isSpecialChar(char c) const = 0;
-  virtual bool isSpecialChar(TextField* field) const = 0;
-  virtual void setConfig(Settings* cfg) = 0;
+  QString m_text; //!< The characters of all fields after each other.
+  QVector<TextRun> m_runs; //!< The fields of all rows.
+  QVector<int> m_rowStarts; //!< Index in m_runs of the first field of each row.
 };
 
 #endif // #ifndef FILE__SYNTAXHIGHLIGHTER
@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#include "tagindex.h"
+
+#include "config.h"
+#include "log.h"
+#include "util.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+#include <string.h>
+
+static const char TAG_INDEX_MAGIC[8] = { 'G', 'E', 'D', 'E', 'T', 'A', 'G', 'S' };
+static const int TAG_INDEX_HEADER_SIZE = 8 + 4 + 4 + 8;
+static const int TAG_INDEX_MIN_FILE_SIZE = 4 + 8 + 8 + 8 + 8 + 4; //!< A file table entry with an empty path.
+static const int TAG_INDEX_MIN_TAG_SIZE = 4 + 4 + 4 + 4 + 4; //!< A tag with empty strings.
+
+/**
+ * @brief Reads integers and strings from the mapped index with bounds checking.
+ */
+class IndexReader
+{
+public:
+  IndexReader(const uchar* data, qint64 size, qint64 offset)
+    : m_ptr(data + offset)
+    , m_end(data + size)
+    , m_ok(0 <= offset && offset <= size){};
+
+  quint32 readU32()
+  {
+    if (!m_ok || m_end - m_ptr < 4)
+    {
+      m_ok = false;
+      return 0;
+    }
+    quint32 val = qFromLittleEndian<quint32>(m_ptr);
+    m_ptr += 4;
+    return val;
+  };
+  quint64 readU64()
+  {
+    if (!m_ok || m_end - m_ptr < 8)
+    {
+      m_ok = false;
+      return 0;
+    }
+    quint64 val = qFromLittleEndian<quint64>(m_ptr);
+    m_ptr += 8;
+    return val;
+  };
+  QString readString()
+  {
+    quint32 len = readU32();
+    if (!m_ok || (quint64) (m_end - m_ptr) < len)
+    {
+      m_ok = false;
+      return QString();
+    }
+    QString str = QString::fromUtf8((const char*) m_ptr, (int) len);
+    m_ptr += len;
+    return str;
+  };
+  bool isOk() const
+  {
+    return m_ok;
+  };
+  qint64 getRemaining() const
+  {
+    return m_ok ? (qint64) (m_end - m_ptr) : 0;
+  };
+
+private:
+  const uchar* m_ptr;
+  const uchar* m_end;
+  bool m_ok;
+};
+
+static void writeU32(QByteArray* out, quint32 val)
+{
+  uchar buf[4];
+  qToLittleEndian<quint32>(val, buf);
+  out->append((const char*) buf, 4);
+}
+
+static void writeU64(QByteArray* out, quint64 val)
+{
+  uchar buf[8];
+  qToLittleEndian<quint64>(val, buf);
+  out->append((const char*) buf, 8);
+}
+
+static void writeString(QByteArray* out, QString str)
+{
+  QByteArray utf8 = str.toUtf8();
+  writeU32(out, utf8.size());
+  out->append(utf8);
+}
+
+TagIndex::TagIndex()
+  : m_data(NULL)
+  , m_dataSize(0)
+{
+}
+
+TagIndex::~TagIndex()
+{
+  close();
+}
+
+/**
+ * @brief Maps an index file and reads its file table.
+ * @return 0 on success.
+ */
+int TagIndex::open(QString filename)
+{
+  close();
+
+  m_file.setFileName(filename);
+  if (!m_file.open(QIODevice::ReadOnly))
+    return -1;
+  m_dataSize = m_file.size();
+  if (m_dataSize < TAG_INDEX_HEADER_SIZE)
+  {
+    close();
+    return -1;
+  }
+  m_data = m_file.map(0, m_dataSize);
+  if (!m_data)
+  {
+    close();
+    return -1;
+  }
+
+  // Check the header
+  if (memcmp(m_data, TAG_INDEX_MAGIC, sizeof(TAG_INDEX_MAGIC)) != 0)
+  {
+    warnMsg("%s is not a tag index", stringToCStr(filename));
+    close();
+    return -1;
+  }
+  IndexReader header(m_data, m_dataSize, sizeof(TAG_INDEX_MAGIC));
+  quint32 version = header.readU32();
+  quint32 fileCount = header.readU32();
+  quint64 fileTableOffset = header.readU64();
+  if (version != TAG_INDEX_VERSION || fileTableOffset > (quint64) m_dataSize)
+  {
+    debugMsg("Ignoring tag index %s (version %u)", stringToCStr(filename), version);
+    close();
+    return -1;
+  }
+
+  // Read the file table
+  IndexReader reader(m_data, m_dataSize, (qint64) fileTableOffset);
+  if (fileCount > reader.getRemaining() / TAG_INDEX_MIN_FILE_SIZE)
+  {
+    warnMsg("The tag index %s is corrupt", stringToCStr(filename));
+    close();
+    return -1;
+  }
+  m_entries.reserve(fileCount);
+  for (quint32 i = 0; i < fileCount && reader.isOk(); i++)
+  {
+    QString filePath = reader.readString();
+    Entry entry;
+    entry.m_fileSize = reader.readU64();
+    entry.m_lastModified = (qint64) reader.readU64();
+    entry.m_contentHash = reader.readU64();
+    entry.m_tagsOffset = reader.readU64();
+    entry.m_tagCount = reader.readU32();
+    if (reader.isOk())
+      m_entries.insert(filePath, entry);
+  }
+  if (!reader.isOk())
+  {
+    warnMsg("The tag index %s is corrupt", stringToCStr(filename));
+    close();
+    return -1;
+  }
+
+  return 0;
+}
+
+void TagIndex::close()
+{
+  if (m_data)
+    m_file.unmap((uchar*) m_data);
+  m_data = NULL;
+  m_dataSize = 0;
+  m_file.close();
+  m_entries.clear();
+}
+
+/**
+ * @brief Returns the stored info about a file (or NULL if the file is not in the index).
+ */
+const TagIndex::Entry* TagIndex::findEntry(QString filePath) const
+{
+  QHash<QString, Entry>::const_iterator it = m_entries.constFind(filePath);
+  if (it == m_entries.constEnd())
+    return NULL;
+  return &it.value();
+}
+
+/**
+ * @brief Decodes the stored tags of a file.
+ * @return 0 on success.
+ */
+int TagIndex::getTags(QString filePath, const Entry& entry, QList<Tag>* tagList) const
+{
+  if (!m_data)
+    return -1;
+
+  IndexReader reader(m_data, m_dataSize, (qint64) entry.m_tagsOffset);
+
+  // Do not trust the count of a truncated or corrupt index
+  if (entry.m_tagCount > reader.getRemaining() / TAG_INDEX_MIN_TAG_SIZE)
+    return -1;
+
+  QList<Tag> list;
+  list.reserve(entry.m_tagCount);
+  for (quint32 i = 0; i < entry.m_tagCount && reader.isOk(); i++)
+  {
+    Tag tag;
+    quint32 type = reader.readU32();
+    if (type == Tag::TAG_FUNC)
+      tag.m_type = Tag::TAG_FUNC;
+    else if (type == Tag::TAG_CLASS)
+      tag.m_type = Tag::TAG_CLASS;
+    else
+      tag.m_type = Tag::TAG_VARIABLE;
+    tag.setLineNo((int) reader.readU32());
+    tag.m_name = reader.readString();
+    tag.m_className = reader.readString();
+    tag.setSignature(reader.readString());
+    tag.m_filepath = filePath;
+    list.append(tag);
+  }
+  if (!reader.isOk())
+    return -1;
+
+  *tagList = list;
+  return 0;
+}
+
+/**
+ * @brief Writes an index with the tags of the files.
+ * The old index is replaced atomically so that a mapped index stays valid.
+ * @return 0 on success.
+ */
+int TagIndex::save(QString filename, const QList<ScannerResult*>& resultList)
+{
+  QByteArray out;
+  out.append(TAG_INDEX_MAGIC, sizeof(TAG_INDEX_MAGIC));
+  writeU32(&out, TAG_INDEX_VERSION);
+  writeU32(&out, resultList.size());
+  writeU64(&out, 0); // File table offset (written below)
+
+  // Write the tags
+  QList<quint64> tagsOffsetList;
+  for (int i = 0; i < resultList.size(); i++)
+  {
+    const ScannerResult* res = resultList[i];
+    tagsOffsetList.append(out.size());
+    for (int j = 0; j < res->m_tagList.size(); j++)
+    {
+      const Tag& tag = res->m_tagList[j];
+      writeU32(&out, (quint32) tag.m_type);
+      writeU32(&out, tag.getLineNo());
+      writeString(&out, tag.m_name);
+      writeString(&out, tag.m_className);
+      writeString(&out, tag.getSignature());
+    }
+  }
+
+  // Write the file table
+  quint64 fileTableOffset = out.size();
+  for (int i = 0; i < resultList.size(); i++)
+  {
+    const ScannerResult* res = resultList[i];
+    writeString(&out, res->m_filePath);
+    writeU64(&out, res->m_fileSize);
+    writeU64(&out, (quint64) res->m_lastModified);
+    writeU64(&out, res->m_contentHash);
+    writeU64(&out, tagsOffsetList[i]);
+    writeU32(&out, res->m_tagList.size());
+  }
+  qToLittleEndian<quint64>(fileTableOffset, (uchar*) out.data() + sizeof(TAG_INDEX_MAGIC) + 8);
+
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    warnMsg("Failed to write tag index %s", stringToCStr(filename));
+    return -1;
+  }
+  file.write(out);
+  if (!file.commit())
+  {
+    warnMsg("Failed to write tag index %s", stringToCStr(filename));
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Gets the size and modification time of a file.
+ * @return 0 on success.
+ */
+int TagIndex::getFileInfo(QString filePath, quint64* fileSize, qint64* lastModified)
+{
+  QFileInfo info(filePath);
+  if (!info.exists())
+    return -1;
+  *fileSize = (quint64) info.size();
+  *lastModified = info.lastModified().toMSecsSinceEpoch();
+  return 0;
+}
+
+/**
+ * @brief Calculates a hash (64 bit FNV-1a) of the content of a file.
+ * @return The hash or 0 if the file could not be read.
+ */
+quint64 TagIndex::hashFile(QString filePath)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    return 0;
+
+  return hashData(file.readAll());
+}
+
+/**
+ * @brief Calculates the hash of the content of a file (see hashFile()).
+ */
+quint64 TagIndex::hashData(const QByteArray& content)
+{
+  quint64 hash = 0xcbf29ce484222325ULL;
+  const uchar* data = (const uchar*) content.constData();
+  for (int i = 0; i < content.size(); i++)
+  {
+    hash ^= data[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
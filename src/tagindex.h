@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__TAGINDEX_H
+#define FILE__TAGINDEX_H
+
+#include "tagscanner.h"
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+struct ScannerResult
+{
+  ScannerResult()
+    : m_fileSize(0)
+    , m_lastModified(0)
+    , m_contentHash(0){};
+
+  QString m_filePath;
+  QList<Tag> m_tagList;
+  quint64 m_fileSize; //!< The size of the file when it was scanned.
+  qint64 m_lastModified; //!< The modification time of the file when it was scanned (ms since epoch).
+  quint64 m_contentHash; //!< Hash of the content of the file (see TagIndex::hashFile()).
+};
+
+/**
+ * @brief Tags of the source files stored on disk so that only the changed files needs to be scanned at startup.
+ * The index file is memory mapped and the tags of a file are only decoded when they are asked for.
+ *
+ * File layout (all integers are little endian):
+ *   Header:      magic[8], version (u32), file count (u32), file table offset (u64)
+ *   Tag blocks:  For each tag: type (u32), line (u32), name, class name, signature (u32 length + UTF-8 each)
+ *   File table:  For each file: path (u32 length + UTF-8), size (u64), mtime (u64), hash (u64), tag offset (u64), tag count (u32)
+ */
+class TagIndex
+{
+public:
+  struct Entry
+  {
+    quint64 m_fileSize;
+    qint64 m_lastModified;
+    quint64 m_contentHash;
+    quint64 m_tagsOffset; //!< Offset in the index file of the first tag.
+    quint32 m_tagCount;
+  };
+
+  TagIndex();
+  ~TagIndex();
+
+  int open(QString filename);
+  void close();
+
+  const Entry* findEntry(QString filePath) const;
+  QHash<QString, Entry> getEntries() const
+  {
+    return m_entries;
+  };
+  int getTags(QString filePath, const Entry& entry, QList<Tag>* tagList) const;
+
+  static int save(QString filename, const QList<ScannerResult*>& resultList);
+  static int getFileInfo(QString filePath, quint64* fileSize, qint64* lastModified);
+  static quint64 hashFile(QString filePath);
+  static quint64 hashData(const QByteArray& content);
+
+private:
+  TagIndex(const TagIndex&);
+
+private:
+  QFile m_file;
+  const uchar* m_data; //!< The mapped index file.
+  qint64 m_dataSize;
+  QHash<QString, Entry> m_entries; //!< The files in the index (indexed by the path).
+};
+
+#endif // FILE__TAGINDEX_H
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+//#define ENABLE_DEBUGMSG
+
+#include "taglistmodel.h"
+
+#include "log.h"
+#include "util.h"
+
+#include <QBrush>
+#include <QHash>
+#include <algorithm>
+
+TagListModel::TagListModel(bool groupByClass, QObject* parent)
+  : QAbstractItemModel(parent)
+  , m_groupByClass(groupByClass)
+{
+}
+
+TagListModel::~TagListModel()
+{
+}
+
+bool TagListModel::compareEntries(const Entry& a, const Entry& b)
+{
+  return a.m_text < b.m_text;
+}
+
+bool TagListModel::compareClasses(const ClassEntry& a, const ClassEntry& b)
+{
+  return a.m_name < b.m_name;
+}
+
+/**
+ * @brief Sets the tags to show.
+ * @param fileTagList   The tags of each source file.
+ */
+void TagListModel::setTags(const QVector<QList<Tag> >& fileTagList)
+{
+  beginResetModel();
+
+  m_fileTagList = fileTagList;
+  m_funcList.clear();
+  m_classList.clear();
+
+  QHash<QString, int> classIdx; //!< Class name -> index in m_classList.
+  for (int fileIdx = 0; fileIdx < m_fileTagList.size(); fileIdx++)
+  {
+    const QList<Tag>& tagList = m_fileTagList[fileIdx];
+    for (int tagIdx = 0; tagIdx < tagList.size(); tagIdx++)
+    {
+      const Tag& tag = tagList.at(tagIdx);
+      Entry entry;
+      entry.m_ref.m_fileIdx = fileIdx;
+      entry.m_ref.m_tagIdx = tagIdx;
+
+      if (!m_groupByClass)
+      {
+        if (tag.isFunc())
+        {
+          // Functions that are not members are shown first
+          entry.m_text = tag.isClassMember() ? tag.getLongName() : (" " + tag.getLongName());
+          m_funcList.append(entry);
+        }
+        continue;
+      }
+
+      // Get the class the tag belongs to (or the class the tag declares)
+      QString className = tag.isClass() ? tag.getName() : tag.getClassName();
+      if (className.isEmpty())
+        continue;
+      QHash<QString, int>::const_iterator it = classIdx.constFind(className);
+      int idx;
+      if (it == classIdx.constEnd())
+      {
+        idx = m_classList.size();
+        classIdx.insert(className, idx);
+        ClassEntry classEntry;
+        classEntry.m_name = className;
+        m_classList.append(classEntry);
+      }
+      else
+        idx = it.value();
+
+      if (tag.isFunc() && tag.getClassName() == className)
+      {
+        entry.m_text = tag.getName() + tag.getSignature();
+        m_classList[idx].m_funcList.append(entry);
+      }
+    }
+  }
+
+  std::sort(m_funcList.begin(), m_funcList.end(), compareEntries);
+  std::sort(m_classList.begin(), m_classList.end(), compareClasses);
+
+  endResetModel();
+}
+
+/**
+ * @brief Returns the tag of a row (or NULL if the row is a class).
+ */
+const Tag* TagListModel::getTag(const QModelIndex& index) const
+{
+  if (!index.isValid())
+    return NULL;
+  if (!m_groupByClass)
+    return &getTag(m_funcList[index.row()].m_ref);
+  if (index.internalId() == 0)
+    return NULL;
+  return &getTag(m_classList[(int) index.internalId() - 1].m_funcList[index.row()].m_ref);
+}
+
+/**
+ * @brief Creates an index.
+ * The internal id is 0 for the top level rows and the class row + 1 for the methods.
+ */
+QModelIndex TagListModel::index(int row, int column, const QModelIndex& parent) const
+{
+  if (!hasIndex(row, column, parent))
+    return QModelIndex();
+  if (!parent.isValid())
+    return createIndex(row, column, (quintptr) 0);
+  return createIndex(row, column, (quintptr) (parent.row() + 1));
+}
+
+QModelIndex TagListModel::parent(const QModelIndex& child) const
+{
+  if (!child.isValid() || child.internalId() == 0)
+    return QModelIndex();
+  return createIndex((int) child.internalId() - 1, 0, (quintptr) 0);
+}
+
+int TagListModel::rowCount(const QModelIndex& parent) const
+{
+  if (!parent.isValid())
+    return m_groupByClass ? m_classList.size() : m_funcList.size();
+  if (m_groupByClass && parent.internalId() == 0 && parent.column() == 0)
+    return m_classList[parent.row()].m_funcList.size();
+  return 0;
+}
+
+int TagListModel::columnCount(const QModelIndex& parent) const
+{
+  Q_UNUSED(parent);
+  return 3;
+}
+
+QVariant TagListModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid())
+    return QVariant();
+
+  // A class?
+  if (m_groupByClass && index.internalId() == 0)
+  {
+    const ClassEntry& classEntry = m_classList[index.row()];
+    if (index.column() == 0 && (role == Qt::DisplayRole || role == FilterRole))
+      return classEntry.m_name;
+    if (index.column() == 0 && role == Qt::ForegroundRole)
+      return QBrush(Qt::blue);
+    return QVariant();
+  }
+
+  const Entry& entry = m_groupByClass ? m_classList[(int) index.internalId() - 1].m_funcList[index.row()] : m_funcList[index.row()];
+  const Tag& tag = getTag(entry.m_ref);
+  if (role == FilterRole)
+    return tag.getLongName();
+  if (role != Qt::DisplayRole)
+    return QVariant();
+  switch (index.column())
+  {
+  case 0:
+    return entry.m_text;
+  case 1:
+    return getFilenamePart(tag.getFilePath());
+  case 2:
+    return QString::number(tag.getLineNo());
+  default:
+    break;
+  }
+  return QVariant();
+}
+
+QVariant TagListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+  switch (section)
+  {
+  case 0:
+    return QString("Name");
+  case 1:
+    return QString("Filename");
+  case 2:
+    return QString("Line");
+  default:
+    break;
+  }
+  return QVariant();
+}
+
+TagFilterProxyModel::TagFilterProxyModel(QObject* parent)
+  : QSortFilterProxyModel(parent)
+{
+  setDynamicSortFilter(false);
+}
+
+/**
+ * @brief Sets the patterns that must all match a row for it to be shown.
+ */
+void TagFilterProxyModel::setFilterList(QVector<QRegExp> filterList)
+{
+  m_filterList = filterList;
+  invalidateFilter();
+}
+
+bool TagFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+  // The methods are shown if their class is
+  if (sourceParent.isValid() || m_filterList.isEmpty())
+    return true;
+
+  QString name = sourceModel()->index(sourceRow, 0, sourceParent).data(TagListModel::FilterRole).toString();
+  for (int j = 0; j < m_filterList.size(); j++)
+  {
+    if (m_filterList[j].indexIn(name) == -1)
+      return false;
+  }
+  return true;
+}
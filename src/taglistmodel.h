@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 Johan Henriksson.
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef FILE__TAGLISTMODEL_H
+#define FILE__TAGLISTMODEL_H
+
+#include "tagscanner.h"
+
+#include <QAbstractItemModel>
+#include <QList>
+#include <QRegExp>
+#include <QSortFilterProxyModel>
+#include <QVector>
+
+/**
+ * @brief Model of the functions in the source files.
+ *
+ * Either a flat list of all functions (sorted by name) or a tree with the classes
+ * at the top level and the methods of each class as children.
+ * The tags are grouped once when they are set and the view only asks for the rows it shows.
+ */
+class TagListModel : public QAbstractItemModel
+{
+  Q_OBJECT
+
+public:
+  enum
+  {
+    FilterRole = Qt::UserRole //!< The text the filter is applied on.
+  };
+
+  TagListModel(bool groupByClass, QObject* parent = NULL);
+  virtual ~TagListModel();
+
+  void setTags(const QVector<QList<Tag> >& fileTagList);
+
+  const Tag* getTag(const QModelIndex& index) const;
+
+  QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+  QModelIndex parent(const QModelIndex& child) const;
+  int rowCount(const QModelIndex& parent = QModelIndex()) const;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+private:
+  struct TagRef
+  {
+    int m_fileIdx;
+    int m_tagIdx;
+  };
+
+  struct Entry
+  {
+    QString m_text; //!< The text in the name column.
+    TagRef m_ref;
+  };
+
+  struct ClassEntry
+  {
+    QString m_name;
+    QVector<Entry> m_funcList;
+  };
+
+  static bool compareEntries(const Entry& a, const Entry& b);
+  static bool compareClasses(const ClassEntry& a, const ClassEntry& b);
+
+  const Tag& getTag(const TagRef& ref) const
+  {
+    return m_fileTagList[ref.m_fileIdx].at(ref.m_tagIdx);
+  };
+
+private:
+  bool m_groupByClass;
+  QVector<QList<Tag> > m_fileTagList; //!< The tags of each file (shared with the tag manager).
+  QVector<Entry> m_funcList; //!< The functions (if not grouped by class).
+  QVector<ClassEntry> m_classList; //!< The classes (if grouped by class).
+};
+
+/**
+ * @brief Shows the top level rows of a TagListModel that matches a list of wildcard patterns.
+ */
+class TagFilterProxyModel : public QSortFilterProxyModel
+{
+  Q_OBJECT
+
+public:
+  TagFilterProxyModel(QObject* parent = NULL);
+
+  void setFilterList(QVector<QRegExp> filterList);
+
+protected:
+  bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const;
+
+private:
+  mutable QVector<QRegExp> m_filterList;
+};
+
+#endif // FILE__TAGLISTMODEL_H
@@ -10,110 +10,282 @@
 
 #include "tagmanager.h"
 
+#include "config.h"
 #include "log.h"
 #include "mainwindow.h"
 #include "tagscanner.h"
 #include "util.h"
 
-ScannerWorker::ScannerWorker()
-  : m_isIdle(true)
+#include <QFile>
+#include <QFileInfo>
+
+static QMutex g_scannerInitMutex; //!< TagScanner::init() is not thread safe.
+
+/**
+ * @brief Scans a file for tags and gets the state of the file (its content is only read once).
+ */
+static void scanFile(TagScanner* scanner, QString filePath, ScannerResult* res)
+{
+  res->m_filePath = filePath;
+
+  // Get the state of the file before scanning it (a change during the scan is detected at the next startup)
+  TagIndex::getFileInfo(filePath, &res->m_fileSize, &res->m_lastModified);
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    errorMsg("Failed to open '%s'", stringToCStr(filePath));
+    return;
+  }
+  QByteArray content = file.readAll();
+  res->m_contentHash = TagIndex::hashData(content);
+
+  scanner->scanBuffer(filePath, content, &res->m_tagList);
+}
+
+ScannerWorker::ScannerWorker(ScannerPool* pool, int workerIdx)
+  : m_pool(pool)
+  , m_workerIdx(workerIdx)
+  , m_cfgGeneration(-1)
 {
 #ifndef NDEBUG
   m_dbgMainThread = QThread::currentThreadId();
 #endif
-  m_quit = false;
 }
 
-void ScannerWorker::requestQuit()
+void ScannerWorker::run()
+{
+  assert(m_dbgMainThread != QThread::currentThreadId());
+
+  do
+  {
+    QString filePath;
+    while (m_pool->takeWork(m_workerIdx, &filePath))
+      scan(filePath);
+  } while (m_pool->waitForWork());
+}
+
+void ScannerWorker::scan(QString filePath)
+{
+  assert(m_dbgMainThread != QThread::currentThreadId());
+
+  // Has the config been changed since the last scan?
+  if (m_pool->getNewConfig(&m_cfgGeneration, &m_cfg))
+  {
+    g_scannerInitMutex.lock();
+    m_scanner.init(&m_cfg);
+    g_scannerInitMutex.unlock();
+  }
+
+  ScannerResult* res = new ScannerResult;
+  scanFile(&m_scanner, filePath, res);
+
+  m_pool->addResult(res);
+}
+
+ScannerPool::ScannerPool(QObject* receiver)
+  : m_receiver(receiver)
+  , m_nextWorkerIdx(0)
+  , m_queuedCount(0)
+  , m_pendingCount(0)
+  , m_quit(false)
+  , m_cfgGeneration(0)
+{
+  int threadCount = qMax(QThread::idealThreadCount(), 1);
+  for (int i = 0; i < threadCount; i++)
+    m_workers.append(new ScannerWorker(this, i));
+}
+
+ScannerPool::~ScannerPool()
 {
+  m_mutex.lock();
   m_quit = true;
-  m_wait.wakeAll();
+  m_workCond.wakeAll();
+  m_mutex.unlock();
+
+  for (int i = 0; i < m_workers.size(); i++)
+    m_workers[i]->wait();
+  qDeleteAll(m_workers);
+  qDeleteAll(m_results);
 }
 
-void ScannerWorker::abort()
+void ScannerPool::start()
 {
-  QMutexLocker locker(&m_mutex);
-  m_workQueue.clear();
+  for (int i = 0; i < m_workers.size(); i++)
+    m_workers[i]->start();
 }
 
-bool ScannerWorker::isIdle()
+/**
+ * @brief Sets the config used by the threads (from their next scan).
+ */
+void ScannerPool::setConfig(Settings cfg)
 {
   QMutexLocker locker(&m_mutex);
-  return m_isIdle;
+  m_cfg = cfg;
+  m_cfgGeneration++;
 }
 
-void ScannerWorker::run()
+/**
+ * @brief Gets the config if it has been changed (called by the threads).
+ * @param generation   The generation of the config the thread uses (updated).
+ * @return true if cfg was set.
+ */
+bool ScannerPool::getNewConfig(int* generation, Settings* cfg)
 {
-  assert(m_dbgMainThread != QThread::currentThreadId());
+  QMutexLocker locker(&m_mutex);
+  if (*generation == m_cfgGeneration)
+    return false;
+  *generation = m_cfgGeneration;
+  *cfg = m_cfg;
+  return true;
+}
 
-  m_scanner.init(&m_cfg);
+/**
+ * @brief Spreads the files over the queues of the threads.
+ */
+void ScannerPool::queueScan(QStringList filePathList)
+{
+  // Count the files before they are queued so that the pool can not look idle while they are added
+  m_mutex.lock();
+  m_queuedCount += filePathList.size();
+  m_pendingCount += filePathList.size();
+  m_mutex.unlock();
 
-  while (m_quit == false)
+  for (int i = 0; i < filePathList.size(); i++)
   {
-    m_mutex.lock();
-    m_wait.wait(&m_mutex);
-    while (!m_workQueue.isEmpty())
-    {
-      m_isIdle = false;
-      QString filePath = m_workQueue.takeFirst();
-      m_mutex.unlock();
+    ScannerWorker* worker = m_workers[m_nextWorkerIdx];
+    m_nextWorkerIdx = (m_nextWorkerIdx + 1) % m_workers.size();
 
-      scan(filePath);
+    QMutexLocker locker(&worker->m_dequeMutex);
+    worker->m_deque.append(filePathList[i]);
+  }
 
-      m_mutex.lock();
-    }
-    m_isIdle = true;
-    m_mutex.unlock();
+  m_mutex.lock();
+  m_workCond.wakeAll();
+  m_mutex.unlock();
+}
+
+/**
+ * @brief Removes all files that has not been scanned yet from the queues.
+ */
+void ScannerPool::abort()
+{
+  int removedCount = 0;
+  for (int i = 0; i < m_workers.size(); i++)
+  {
+    ScannerWorker* worker = m_workers[i];
+    QMutexLocker locker(&worker->m_dequeMutex);
+    removedCount += worker->m_deque.size();
+    worker->m_deque.clear();
+  }
+
+  QMutexLocker locker(&m_mutex);
+  m_queuedCount -= removedCount;
+  m_pendingCount -= removedCount;
+  if (removedCount > 0 && m_pendingCount == 0)
+  {
     m_doneCond.wakeAll();
+
+    // Let the receiver know that the pool is idle
+    QMetaObject::invokeMethod(m_receiver, "onScanDone", Qt::QueuedConnection);
   }
 }
 
-void ScannerWorker::setConfig(Settings cfg)
+/**
+ * @brief Waits until all queued files has been scanned.
+ */
+void ScannerPool::waitAll()
 {
-  QMutexLocker am(&m_mutex);
-  m_cfg = cfg;
+  QMutexLocker locker(&m_mutex);
+  while (m_pendingCount > 0)
+    m_doneCond.wait(&m_mutex);
 }
 
-void ScannerWorker::waitAll()
+/**
+ * @brief Takes the results of the scans done since the last call.
+ * @return true if all queued files has been scanned.
+ */
+bool ScannerPool::takeResults(QList<ScannerResult*>* resultList)
 {
-  m_mutex.lock();
-  while (!m_workQueue.isEmpty() || m_isIdle == false)
-  {
-    m_doneCond.wait(&m_mutex);
-  }
-  m_mutex.unlock();
+  QMutexLocker locker(&m_mutex);
+  *resultList = m_results;
+  m_results.clear();
+  return m_pendingCount == 0;
 }
 
-void ScannerWorker::queueScan(QString filePath)
+/**
+ * @brief Gets the next file to scan for a thread (from its own queue or stolen from another thread).
+ * @return false if there is nothing to scan (or the pool is being destroyed).
+ */
+bool ScannerPool::takeWork(int workerIdx, QString* filePath)
 {
   m_mutex.lock();
-  m_isIdle = false;
-  m_workQueue.append(filePath);
+  bool quit = m_quit;
   m_mutex.unlock();
-  m_wait.wakeAll();
+  if (quit)
+    return false;
+
+  bool found = false;
+  for (int i = 0; i < m_workers.size() && !found; i++)
+  {
+    ScannerWorker* worker = m_workers[(workerIdx + i) % m_workers.size()];
+    QMutexLocker locker(&worker->m_dequeMutex);
+    if (!worker->m_deque.isEmpty())
+    {
+      // Own work is taken from the back and stolen work from the front
+      *filePath = (i == 0) ? worker->m_deque.takeLast() : worker->m_deque.takeFirst();
+      found = true;
+    }
+  }
+
+  if (found)
+  {
+    QMutexLocker locker(&m_mutex);
+    m_queuedCount--;
+  }
+  return found;
 }
 
-void ScannerWorker::scan(QString filePath)
+/**
+ * @brief Blocks a thread until there are files to scan.
+ * @return false if the pool is being destroyed.
+ */
+bool ScannerPool::waitForWork()
 {
-  QList<Tag>* taglist = new QList<Tag>;
-
-  assert(m_dbgMainThread != QThread::currentThreadId());
+  QMutexLocker locker(&m_mutex);
+  while (!m_quit && m_queuedCount <= 0)
+    m_workCond.wait(&m_mutex);
+  return !m_quit;
+}
 
-  m_scanner.scan(filePath, taglist);
+/**
+ * @brief Adds the result of a scan (called by the threads).
+ */
+void ScannerPool::addResult(ScannerResult* result)
+{
+  QMutexLocker locker(&m_mutex);
+  bool wasEmpty = m_results.isEmpty();
+  m_results.append(result);
+  m_pendingCount--;
+  if (m_pendingCount == 0)
+    m_doneCond.wakeAll();
 
-  emit onScanDone(filePath, taglist);
+  // Only one call is queued for each batch of results
+  if (wasEmpty)
+    QMetaObject::invokeMethod(m_receiver, "onScanDone", Qt::QueuedConnection);
 }
 
 TagManager::TagManager(Settings& cfg)
+  : m_pool(this)
+  , m_scanInProgress(false)
+  , m_indexDirty(false)
 {
 #ifndef NDEBUG
   m_dbgMainThread = QThread::currentThreadId();
 #endif
 
-  m_worker.setConfig(cfg);
-  m_worker.start();
-
-  connect(&m_worker, SIGNAL(onScanDone(QString, QList<Tag>*)), this, SLOT(onScanDone(QString, QList<Tag>*)));
+  m_pool.setConfig(cfg);
+  m_pool.start();
 
   m_cfg = cfg;
   m_tagScanner.init(&m_cfg);
@@ -121,9 +293,7 @@ TagManager::TagManager(Settings& cfg)
 
 TagManager::~TagManager()
 {
-  m_worker.requestQuit();
-  m_worker.wait();
-
+  m_symbols.clear();
   foreach (ScannerResult* info, m_db)
   {
     delete info;
@@ -132,29 +302,135 @@ TagManager::~TagManager()
 
 void TagManager::waitAll()
 {
-  m_worker.waitAll();
+  m_pool.waitAll();
+
+  // Merge the results that has not been handed over yet
+  onScanDone();
 }
 
-void TagManager::onScanDone(QString filePath, QList<Tag>* tags)
+/**
+ * @brief Merges the results from the scanner threads into the database.
+ */
+void TagManager::onScanDone()
 {
   assert(m_dbgMainThread == QThread::currentThreadId());
 
-  ScannerResult* info = new ScannerResult;
-  info->m_filePath = filePath;
-  info->m_tagList = *tags;
+  QList<ScannerResult*> resultList;
+  bool isIdle = m_pool.takeResults(&resultList);
+  for (int i = 0; i < resultList.size(); i++)
+  {
+    setResult(resultList[i]);
+    m_indexDirty = true;
+  }
 
-  if (m_db.contains(filePath))
+  if (isIdle && m_scanInProgress)
   {
-    ScannerResult* oldInfo = m_db[filePath];
-    delete oldInfo;
+    m_scanInProgress = false;
+    saveIndex();
+    emit onAllScansDone();
   }
+}
 
-  m_db[filePath] = info;
+/**
+ * @brief Opens the tag index saved by the previous session (located next to the project config file).
+ */
+void TagManager::openIndex()
+{
+  if (!m_indexPath.isEmpty())
+    return;
 
-  if (m_worker.isIdle())
-    emit onAllScansDone();
+  m_indexPath = QFileInfo(m_cfg.getProjectConfigPath()).absolutePath() + "/" + TAG_INDEX_FILENAME;
+  if (m_index.open(m_indexPath) == 0)
+    debugMsg("Opened tag index %s", stringToCStr(m_indexPath));
+}
+
+/**
+ * @brief Writes the tags to the index file (if any file has been scanned).
+ * Files in the old index that are not used by this session are kept.
+ */
+void TagManager::saveIndex()
+{
+  if (!m_indexDirty || m_indexPath.isEmpty())
+    return;
+  m_indexDirty = false;
+
+  QList<ScannerResult*> resultList = m_db.values();
+  QList<ScannerResult*> oldResultList;
+  QHash<QString, TagIndex::Entry> oldEntries = m_index.getEntries();
+  for (QHash<QString, TagIndex::Entry>::const_iterator it = oldEntries.constBegin(); it != oldEntries.constEnd(); ++it)
+  {
+    if (m_db.contains(it.key()))
+      continue;
+
+    ScannerResult* res = new ScannerResult;
+    res->m_filePath = it.key();
+    res->m_fileSize = it.value().m_fileSize;
+    res->m_lastModified = it.value().m_lastModified;
+    res->m_contentHash = it.value().m_contentHash;
+    if (m_index.getTags(it.key(), it.value(), &res->m_tagList) == 0)
+      oldResultList.append(res);
+    else
+      delete res;
+  }
 
-  delete tags;
+  if (TagIndex::save(m_indexPath, resultList + oldResultList) == 0)
+    m_index.open(m_indexPath);
+
+  qDeleteAll(oldResultList);
+}
+
+/**
+ * @brief Adds the tags of a file from the index if the file has not changed since it was indexed.
+ * @return true if the tags was found in the index.
+ */
+bool TagManager::loadFromIndex(QString filePath)
+{
+  const TagIndex::Entry* entry = m_index.findEntry(filePath);
+  if (!entry)
+    return false;
+
+  quint64 fileSize = 0;
+  qint64 lastModified = 0;
+  if (TagIndex::getFileInfo(filePath, &fileSize, &lastModified) || fileSize != entry->m_fileSize)
+    return false;
+
+  // Touched but not modified?
+  if (lastModified != entry->m_lastModified)
+  {
+    if (TagIndex::hashFile(filePath) != entry->m_contentHash)
+      return false;
+    m_indexDirty = true;
+  }
+
+  ScannerResult* res = new ScannerResult;
+  res->m_filePath = filePath;
+  res->m_fileSize = fileSize;
+  res->m_lastModified = lastModified;
+  res->m_contentHash = entry->m_contentHash;
+  if (m_index.getTags(filePath, *entry, &res->m_tagList))
+  {
+    delete res;
+    return false;
+  }
+
+  setResult(res);
+  return true;
+}
+
+/**
+ * @brief Adds (or replaces) the tags of a file.
+ */
+void TagManager::setResult(ScannerResult* result)
+{
+  ScannerResult* oldResult = m_db.value(result->m_filePath);
+  if (oldResult)
+  {
+    m_symbols.removeFile(oldResult);
+    delete oldResult;
+  }
+
+  m_db[result->m_filePath] = result;
+  m_symbols.addFile(result);
 }
 
 /**
@@ -162,35 +438,44 @@ void TagManager::onScanDone(QString filePath, QList<Tag>* tags)
  */
 int TagManager::queueScan(QStringList filePathList)
 {
-  bool queuedAny = false;
+  QStringList scanList;
 
   assert(m_dbgMainThread == QThread::currentThreadId());
+
+  openIndex();
+
   for (int i = 0; i < filePathList.size(); i++)
   {
     QString filePath = filePathList[i];
-    if (!m_db.contains(filePath))
-    {
-      m_worker.queueScan(filePath);
-      queuedAny = true;
-    }
+    if (!m_db.contains(filePath) && !loadFromIndex(filePath))
+      scanList.append(filePath);
   }
 
-  if (!queuedAny)
+  if (!scanList.isEmpty())
+  {
+    m_scanInProgress = true;
+    m_pool.queueScan(scanList);
+  }
+  else if (!m_scanInProgress)
+  {
+    saveIndex();
     emit onAllScansDone();
+  }
 
   return 0;
 }
 
 void TagManager::scan(QString filePath, QList<Tag>* tagList)
 {
-  if (!m_db.contains(filePath))
+  openIndex();
+
+  if (!m_db.contains(filePath) && !loadFromIndex(filePath))
   {
     ScannerResult* res = new ScannerResult;
-    res->m_filePath = filePath;
-
-    m_tagScanner.scan(res->m_filePath, &res->m_tagList);
+    scanFile(&m_tagScanner, filePath, res);
 
-    m_db[filePath] = res;
+    setResult(res);
+    m_indexDirty = true;
   }
 
   *tagList = m_db[filePath]->m_tagList;
@@ -198,7 +483,7 @@ void TagManager::scan(QString filePath, QList<Tag>* tagList)
 
 void TagManager::abort()
 {
-  m_worker.abort();
+  m_pool.abort();
 }
 
 void TagManager::getTags(QString filePath, QList<Tag>* tagList)
@@ -218,32 +503,31 @@ void TagManager::lookupTag(QString name, QList<Tag>* tagList)
 {
   debugMsg("%s(name:'%s')", __func__, qPrintable(name));
 
-  QString funcName;
-  QString className;
-
-  if (name.contains("::"))
-  {
-    int divPos = name.indexOf("::");
-    funcName = name.mid(divPos + 2);
-    className = name.left(divPos);
-  }
-  else
-    funcName = name;
+  m_symbols.lookup(name, tagList);
+}
 
-  foreach (ScannerResult* info, m_db)
-  {
-    for (int j = 0; j < info->m_tagList.size(); j++)
-    {
-      Tag& tag = info->m_tagList[j];
+/**
+ * @brief Finds the tags which name starts with a string (Eg: "Cla" finds "Class::myFunc").
+ * @param onlyFuncs  Only return functions.
+ * @param maxCount   Max number of tags to return.
+ * @return tagList   The found tags (sorted by name).
+ */
+void TagManager::findTagsByPrefix(QString prefix, bool onlyFuncs, int maxCount, QList<Tag>* tagList)
+{
+  m_symbols.findByPrefix(prefix, onlyFuncs, maxCount, tagList);
+}
 
-      if (tag.getName() == funcName && className == tag.getClassName())
-        tagList->append(tag);
-    }
-  }
+/**
+ * @brief Returns the names of all tags (Eg: "main" or "Class::myFunc").
+ * @param onlyFuncs  Only return functions.
+ */
+void TagManager::getTagNames(bool onlyFuncs, QStringList* nameList)
+{
+  m_symbols.getNames(onlyFuncs, nameList);
 }
 
 void TagManager::setConfig(Settings& cfg)
 {
   m_cfg = cfg;
-  m_worker.setConfig(cfg);
+  m_pool.setConfig(cfg);
 }
@@ -1,6 +1,8 @@
 #ifndef FILE__TAGMANAGER_H
 #define FILE__TAGMANAGER_H
 
+#include "symbolindex.h"
+#include "tagindex.h"
 #include "tagscanner.h"
 
 #include <QList>
@@ -13,51 +15,81 @@
 
 class FileInfo;
 
-struct ScannerResult
-{
-  QString m_filePath;
-  QList<Tag> m_tagList;
-};
+class ScannerPool;
 
+/**
+ * @brief One of the threads in a ScannerPool.
+ */
 class ScannerWorker : public QThread
 {
   Q_OBJECT
 
 public:
-  ScannerWorker();
+  ScannerWorker(ScannerPool* pool, int workerIdx);
 
   void run();
 
-  void abort();
-  void waitAll();
-
-  void requestQuit();
-  void queueScan(QString filePath);
-
-  bool isIdle();
-
-  void setConfig(Settings cfg);
-
 private:
   void scan(QString filePath);
 
-signals:
-  void onScanDone(QString filePath, QList<Tag>* taglist);
-
 private:
+  ScannerPool* m_pool;
+  int m_workerIdx;
   TagScanner m_scanner;
+  Settings m_cfg;
+  int m_cfgGeneration; //!< The generation of m_cfg (see ScannerPool::getNewConfig()).
 
 #ifndef NDEBUG
   Qt::HANDLE m_dbgMainThread;
 #endif
 
-  QMutex m_mutex;
-  QWaitCondition m_wait;
+  QMutex m_dequeMutex;
+  QList<QString> m_deque; //!< The files queued for this thread (the other threads steal from the front).
+
+  friend class ScannerPool;
+};
+
+/**
+ * @brief Scans files with one thread for each core.
+ * Each thread has its own queue and steals work from the others when its own queue is empty.
+ * The results are collected and handed over in batches.
+ */
+class ScannerPool
+{
+public:
+  ScannerPool(QObject* receiver);
+  ~ScannerPool();
+
+  void start();
+  void queueScan(QStringList filePathList);
+  void abort();
+  void waitAll();
+  bool takeResults(QList<ScannerResult*>* resultList);
+
+  void setConfig(Settings cfg);
+
+private:
+  bool takeWork(int workerIdx, QString* filePath);
+  bool waitForWork();
+  void addResult(ScannerResult* result);
+  bool getNewConfig(int* generation, Settings* cfg);
+
+private:
+  QObject* m_receiver; //!< Its onScanDone() slot is invoked (queued) when there are results to take.
+  QList<ScannerWorker*> m_workers;
+  int m_nextWorkerIdx;
+
+  QMutex m_mutex; //!< Protects the members below.
+  QWaitCondition m_workCond;
   QWaitCondition m_doneCond;
-  QList<QString> m_workQueue;
+  int m_queuedCount; //!< Number of files in the queues of the threads.
+  int m_pendingCount; //!< Number of files queued or being scanned.
+  QList<ScannerResult*> m_results; //!< The results that has not been taken yet.
   bool m_quit;
   Settings m_cfg;
-  bool m_isIdle;
+  int m_cfgGeneration; //!< Incremented each time m_cfg is changed.
+
+  friend class ScannerWorker;
 };
 
 class TagManager : public QObject
@@ -82,22 +114,35 @@ public:
   void getTags(QString filePath, QList<Tag>* tagList);
 
   void lookupTag(QString name, QList<Tag>* tagList);
+  void findTagsByPrefix(QString prefix, bool onlyFuncs, int maxCount, QList<Tag>* tagList);
+  void getTagNames(bool onlyFuncs, QStringList* nameList);
 
   void setConfig(Settings& cfg);
 signals:
   void onAllScansDone();
 
 private slots:
-  void onScanDone(QString filePath, QList<Tag>* tags);
+  void onScanDone();
+
+private:
+  void openIndex();
+  void saveIndex();
+  bool loadFromIndex(QString filePath);
+  void setResult(ScannerResult* result);
 
 private:
-  ScannerWorker m_worker;
+  ScannerPool m_pool;
+  bool m_scanInProgress; //!< True until onAllScansDone() has been emitted for the queued files.
   TagScanner m_tagScanner;
 
 #ifndef NDEBUG
   Qt::HANDLE m_dbgMainThread;
 #endif
   QMap<QString, ScannerResult*> m_db;
+  SymbolIndex m_symbols; //!< Index of the tags in m_db.
+  TagIndex m_index; //!< The tags saved by the previous session.
+  QString m_indexPath; //!< The path of the index file (empty until the index has been opened).
+  bool m_indexDirty; //!< True if m_db has tags that are not in the index file.
 
   Settings m_cfg;
 };
@@ -10,6 +10,7 @@
 
 #include "adatagscanner.h"
 #include "config.h"
+#include "cxxtagscanner.h"
 #include "log.h"
 #include "rusttagscanner.h"
 #include "util.h"
@@ -50,6 +51,9 @@ void Tag::dump() const
   else if (TAG_FUNC == m_type)
     qDebug() << "Type: "
              << " function";
+  else if (TAG_CLASS == m_type)
+    qDebug() << "Type: "
+             << " class";
 
   qDebug() << "Sig: " << m_signature;
   qDebug() << "Line: " << m_lineNo;
@@ -169,6 +173,34 @@ void TagScanner::init(Settings* cfg)
 /**
  * @brief Scans a sourcefile for tags.
  */
+/**
+ * @brief Scans a file that has already been read.
+ * @param content   The content of the file (ctags reads the file itself).
+ */
+int TagScanner::scanBuffer(QString filepath, const QByteArray& content, QList<Tag>* taglist)
+{
+  QString extension = getExtensionPart(filepath);
+  if (extension.toLower() == RUST_FILE_EXTENSION)
+  {
+    RustTagScanner rs;
+    rs.setConfig(m_cfg);
+    return rs.scanBuffer(filepath, content, taglist);
+  }
+  if (extension.toLower() == ADA_FILE_EXTENSION)
+  {
+    AdaTagScanner rs;
+    rs.setConfig(m_cfg);
+    return rs.scanBuffer(filepath, content, taglist);
+  }
+  if (CxxTagScanner::isCxxFile(filepath))
+  {
+    CxxTagScanner cs;
+    return cs.scanBuffer(filepath, content, taglist);
+  }
+
+  return scan(filepath, taglist);
+}
+
 int TagScanner::scan(QString filepath, QList<Tag>* taglist)
 {
 
@@ -186,6 +218,11 @@ int TagScanner::scan(QString filepath, QList<Tag>* taglist)
     rs.setConfig(m_cfg);
     return rs.scan(filepath, taglist);
   }
+  if (CxxTagScanner::isCxxFile(filepath))
+  {
+    CxxTagScanner cs;
+    return cs.scan(filepath, taglist);
+  }
 
   if (!g_ctagsExist)
     return 0;
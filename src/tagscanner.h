@@ -11,6 +11,7 @@
 
 #include "settings.h"
 
+#include <QByteArray>
 #include <QList>
 #include <QString>
 
@@ -53,6 +54,10 @@ public:
   {
     return (m_type == TAG_FUNC) ? true : false;
   };
+  bool isClass() const
+  {
+    return (m_type == TAG_CLASS) ? true : false;
+  };
   bool isClassMember() const
   {
     return m_className.isEmpty() ? false : true;
@@ -64,7 +69,8 @@ public:
   enum
   {
     TAG_FUNC,
-    TAG_VARIABLE
+    TAG_VARIABLE,
+    TAG_CLASS //!< A class, struct or union.
   } m_type;
 
 private:
@@ -81,6 +87,7 @@ public:
   void init(Settings* cfg);
 
   int scan(QString filepath, QList<Tag>* taglist);
+  int scanBuffer(QString filepath, const QByteArray& content, QList<Tag>* taglist);
   void dump(const QList<Tag>& taglist);
 
 private:
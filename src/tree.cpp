@@ -12,34 +12,470 @@
 #include "util.h"
 
 #include <QList>
+#include <QMutexLocker>
 #include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
 
-TreeNode::TreeNode()
-  : m_parent(NULL)
+// Size of the first block allocated by an arena.
+#define TREE_ARENA_FIRST_BLOCK_SIZE 4096
+
+// Max size of the blocks allocated by an arena.
+#define TREE_ARENA_MAX_BLOCK_SIZE (256 * 1024)
+
+// Number of slots in the first hash table of the atom table (must be a power of two).
+#define TREE_ATOM_FIRST_TABLE_SIZE 256
+
+// Number of children a node must have before its children are hashed by name.
+#define TREE_CHILD_HASH_MIN 16
+
+TreeAtomTable::TreeAtomTable()
+  : m_count(0)
+{
+  HashTable* table = new HashTable;
+  table->m_mask = TREE_ATOM_FIRST_TABLE_SIZE - 1;
+  table->m_slots = new QAtomicInt[TREE_ATOM_FIRST_TABLE_SIZE];
+  m_table.storeRelease(table);
+}
+
+TreeAtomTable::~TreeAtomTable()
+{
+  m_oldTables.append(m_table.loadAcquire());
+  for (int i = 0; i < m_oldTables.size(); i++)
+  {
+    delete[] m_oldTables[i]->m_slots;
+    delete m_oldTables[i];
+  }
+  for (int i = 0; i < TREE_ATOM_MAX_CHUNKS; i++)
+    delete[] m_chunks[i].loadAcquire();
+}
+
+TreeAtomTable& TreeAtomTable::getInstance()
+{
+  static TreeAtomTable table;
+  return table;
+}
+
+static quint32 hashName(const char* name, int len)
 {
+  quint32 h = 2166136261u;
+  for (int i = 0; i < len; i++)
+    h = (h ^ (unsigned char) name[i]) * 16777619u;
+  return h;
+}
+
+/**
+ * @brief Checks if a name is the name of a list item ("0", "1", ... without leading zeros).
+ */
+static bool parseIndexName(const char* name, int len, int* idx)
+{
+  if (len < 1 || len > 9 || (name[0] == '0' && len > 1))
+    return false;
+
+  int val = 0;
+  for (int i = 0; i < len; i++)
+  {
+    if (name[i] < '0' || name[i] > '9')
+      return false;
+    val = val * 10 + (name[i] - '0');
+  }
+  *idx = val;
+  return true;
 }
 
-TreeNode::TreeNode(QString name)
-  : m_parent(NULL)
-  , m_name(name)
+const TreeAtomTable::Entry& TreeAtomTable::getEntry(int atom) const
 {
+  const Entry* chunk = m_chunks[atom / TREE_ATOM_CHUNK_SIZE].loadAcquire();
+  return chunk[atom % TREE_ATOM_CHUNK_SIZE];
+}
+
+/**
+ * @brief Finds a name in the hash table (without taking the lock).
+ * @return The atom or -1 if not found.
+ */
+int TreeAtomTable::find(const char* name, int len, quint32 hash) const
+{
+  const HashTable* table = m_table.loadAcquire();
+  for (int i = hash & table->m_mask;; i = (i + 1) & table->m_mask)
+  {
+    int slot = table->m_slots[i].loadAcquire();
+    if (slot == 0)
+      return -1;
+
+    const QByteArray& bytes = getEntry(slot - 1).m_bytes;
+    if (bytes.size() == len && memcmp(bytes.constData(), name, len) == 0)
+      return slot - 1;
+  }
+}
+
+void TreeAtomTable::insert(HashTable* table, quint32 hash, int atom)
+{
+  int i = hash & table->m_mask;
+  while (table->m_slots[i].loadAcquire() != 0)
+    i = (i + 1) & table->m_mask;
+  table->m_slots[i].storeRelease(atom + 1);
+}
+
+/**
+ * @brief Adds a new name (must be called with the lock taken).
+ * The name is stored before it is published in the hash table, so a thread that finds it
+ * can read it without any lock.
+ * @return The atom or -1 if the table is full.
+ */
+int TreeAtomTable::add(const char* name, int len, quint32 hash)
+{
+  int atom = m_count.loadAcquire();
+  if (atom >= TREE_ATOM_MAX_CHUNKS * TREE_ATOM_CHUNK_SIZE)
+  {
+    critMsg("Too many node names");
+    return -1;
+  }
+
+  Entry* chunk = m_chunks[atom / TREE_ATOM_CHUNK_SIZE].loadAcquire();
+  if (chunk == NULL)
+  {
+    chunk = new Entry[TREE_ATOM_CHUNK_SIZE];
+    m_chunks[atom / TREE_ATOM_CHUNK_SIZE].storeRelease(chunk);
+  }
+  Entry& entry = chunk[atom % TREE_ATOM_CHUNK_SIZE];
+  entry.m_bytes = QByteArray(name, len);
+  entry.m_name = QString::fromUtf8(entry.m_bytes);
+  m_count.storeRelease(atom + 1);
+
+  // Half full? Then move to a larger table (the old one is kept since it may be in use).
+  HashTable* table = m_table.loadAcquire();
+  if ((atom + 1) * 2 > table->m_mask + 1)
+  {
+    HashTable* newTable = new HashTable;
+    newTable->m_mask = (table->m_mask + 1) * 2 - 1;
+    newTable->m_slots = new QAtomicInt[newTable->m_mask + 1];
+    for (int a = 0; a <= atom; a++)
+    {
+      const QByteArray& bytes = getEntry(a).m_bytes;
+      insert(newTable, hashName(bytes.constData(), bytes.size()), a);
+    }
+    m_oldTables.append(table);
+    m_table.storeRelease(newTable);
+  }
+  else
+    insert(table, hash, atom);
+
+  return atom;
+}
+
+/**
+ * @brief Returns the atom for a name (the name is added if not found).
+ */
+int TreeAtomTable::intern(const char* name, int len)
+{
+  int idx;
+  if (parseIndexName(name, len, &idx))
+    return internIndex(idx);
+
+  TreeAtomTable& table = getInstance();
+  quint32 hash = hashName(name, len);
+  int atom = table.find(name, len, hash);
+  if (atom != -1)
+    return atom;
+
+  QMutexLocker locker(&table.m_mutex);
+
+  // Added by another thread meanwhile?
+  atom = table.find(name, len, hash);
+  if (atom == -1)
+    atom = table.add(name, len, hash);
+  return atom;
+}
+
+int TreeAtomTable::intern(QString name)
+{
+  QByteArray nameBytes = name.toUtf8();
+  return intern(nameBytes.constData(), nameBytes.size());
+}
+
+/**
+ * @brief Returns the atom for the name of a list item.
+ * The index is encoded in the atom so the names of list items do not take any space in the table.
+ * @param idx   The index of the item (Eg: 1 for "1").
+ */
+int TreeAtomTable::internIndex(int idx)
+{
+  assert(idx >= 0);
+  return -2 - idx;
+}
+
+/**
+ * @brief Returns the atom for a name or -1 if the name has never been interned.
+ */
+int TreeAtomTable::lookup(QString name)
+{
+  QByteArray nameBytes = name.toUtf8();
+
+  int idx;
+  if (parseIndexName(nameBytes.constData(), nameBytes.size(), &idx))
+    return internIndex(idx);
+
+  return getInstance().find(nameBytes.constData(), nameBytes.size(), hashName(nameBytes.constData(), nameBytes.size()));
+}
+
+QString TreeAtomTable::getName(int atom)
+{
+  if (isIndexAtom(atom))
+    return QString::number(-2 - atom);
+
+  TreeAtomTable& table = getInstance();
+  if (atom < 0 || atom >= table.m_count.loadAcquire())
+    return "";
+  return table.getEntry(atom).m_name;
+}
+
+TreePath::TreePath(const char* path)
+{
+  const char* name = path;
+  while (*name != '\0')
+  {
+    const char* nameEnd = name;
+    while (*nameEnd != '\0' && *nameEnd != '/')
+      nameEnd++;
+
+    // Skip empty names (Eg: leading '/')
+    if (nameEnd != name)
+    {
+      Step step;
+      if (*name == '#')
+      {
+        step.m_nameAtom = -1;
+        step.m_index = atoi(name + 1) - 1;
+      }
+      else
+      {
+        step.m_nameAtom = TreeAtomTable::intern(name, nameEnd - name);
+        step.m_index = -1;
+      }
+      m_steps.append(step);
+    }
+
+    name = *nameEnd == '/' ? nameEnd + 1 : nameEnd;
+  }
+}
+
+/**
+ * @brief Finds the node the path points to.
+ * @param node   The node the path is relative to.
+ * @return The node found or NULL if not found.
+ */
+TreeNode* TreePath::resolve(const TreeNode* node) const
+{
+  TreeNode* child = NULL;
+  for (int i = 0; i < m_steps.size(); i++)
+  {
+    const Step& step = m_steps[i];
+    if (step.m_nameAtom == -1)
+    {
+      if (step.m_index < 0 || step.m_index >= node->getChildCount())
+        return NULL;
+      child = node->getChild(step.m_index);
+    }
+    else
+    {
+      child = node->findChildByAtom(step.m_nameAtom);
+      if (child == NULL)
+        return NULL;
+    }
+    node = child;
+  }
+  return child;
+}
+
+TreeArena::TreeArena()
+  : m_blockPtr(NULL)
+  , m_blockLeft(0)
+  , m_nextBlockSize(TREE_ARENA_FIRST_BLOCK_SIZE)
+  , m_isShared(false)
+  , m_root(this, TreeAtomTable::intern("", 0))
+{
+}
+
+TreeArena::~TreeArena()
+{
+  for (int i = 0; i < m_blocks.size(); i++)
+    free(m_blocks[i]);
+}
+
+/**
+ * @brief Allocates memory that is freed when the arena is destroyed.
+ */
+void* TreeArena::alloc(int size)
+{
+  // Keep everything 8 byte aligned
+  size = (size + 7) & ~7;
+
+  if (size > m_blockLeft)
+  {
+    int blockSize = qMax(m_nextBlockSize, size);
+    char* block = (char*) malloc(blockSize);
+    assert(block != NULL);
+    m_blocks.append(block);
+    m_blockPtr = block;
+    m_blockLeft = blockSize;
+
+    if (m_nextBlockSize < TREE_ARENA_MAX_BLOCK_SIZE)
+      m_nextBlockSize *= 2;
+  }
+
+  void* ptr = m_blockPtr;
+  m_blockPtr += size;
+  m_blockLeft -= size;
+  return ptr;
+}
+
+/**
+ * @brief Copies a string into the arena.
+ * @return The null terminated copy.
+ */
+const char* TreeArena::allocString(const char* str, int len)
+{
+  char* copy = (char*) alloc(len + 1);
+  memcpy(copy, str, len);
+  copy[len] = '\0';
+  return copy;
+}
+
+TreeNode* TreeArena::allocNode(int nameAtom)
+{
+  void* mem = alloc(sizeof(TreeNode));
+  return new (mem) TreeNode(this, nameAtom);
+}
+
+TreeNode::TreeNode(TreeArena* arena, int nameAtom)
+  : m_arena(arena)
+  , m_parent(NULL)
+  , m_nameAtom(nameAtom)
+  , m_data("")
+  , m_dataLen(0)
+  , m_children(NULL)
+  , m_childCount(0)
+  , m_childCapacity(0)
+  , m_childHash(NULL)
+  , m_childHashMask(0)
+{
+}
+
+/**
+ * @brief Converts a null terminated string to a number (in the same way as QString::toLongLong()).
+ * @return true if the whole string was a valid number.
+ */
+static bool parseNumber(const char* str, long long* value)
+{
+  char* endPtr = NULL;
+
+  while (isspace((unsigned char) *str))
+    str++;
+  if (*str == '\0')
+    return false;
+
+  errno = 0;
+  long long val = strtoll(str, &endPtr, 0);
+  if (errno != 0)
+    return false;
+
+  while (isspace((unsigned char) *endPtr))
+    endPtr++;
+  if (*endPtr != '\0')
+    return false;
+
+  *value = val;
+  return true;
 }
 
 int TreeNode::getDataInt(int defaultValue) const
 {
-  bool ok = false;
-  int val = m_data.toInt(&ok, 0);
-  if (ok)
-    return val;
+  long long val = 0;
+  if (parseNumber(m_data, &val) && INT_MIN <= val && val <= INT_MAX)
+    return (int) val;
   return defaultValue;
 }
 
-void TreeNode::addChild(TreeNode* child)
+void TreeNode::setData(QString data)
 {
+  QByteArray dataBytes = data.toUtf8();
+  setData(dataBytes.constData(), dataBytes.size());
+}
+
+void TreeNode::setData(const char* data, int len)
+{
+  m_data = m_arena->allocString(data, len);
+  m_dataLen = len;
+}
+
+TreeNode* TreeNode::addChild(QString name)
+{
+  return addChild(TreeAtomTable::intern(name));
+}
+
+/**
+ * @brief Creates a new child node (owned by the same arena as this node).
+ */
+TreeNode* TreeNode::addChild(int nameAtom)
+{
+  TreeNode* child = m_arena->allocNode(nameAtom);
   child->m_parent = this;
 
-  m_children.push_back(child);
-  m_childMap[child->m_name] = child;
+  if (m_childCount == m_childCapacity)
+  {
+    int newCapacity = m_childCapacity == 0 ? 4 : m_childCapacity * 2;
+    TreeNode** children = (TreeNode**) m_arena->alloc(newCapacity * sizeof(TreeNode*));
+    if (m_childCount > 0)
+      memcpy(children, m_children, m_childCount * sizeof(TreeNode*));
+    m_children = children;
+    m_childCapacity = newCapacity;
+  }
+  m_children[m_childCount++] = child;
+
+  // Many children? Then they are also hashed by name (see findChildByAtom()).
+  if (m_childHash != NULL && m_childCount * 2 <= m_childHashMask + 1)
+    insertChildHash(m_childCount - 1);
+  else if (m_childCount >= TREE_CHILD_HASH_MIN)
+    rebuildChildHash();
+
+  return child;
+}
+
+static inline quint32 hashAtom(int atom)
+{
+  return (quint32) atom * 2654435761u;
+}
+
+/**
+ * @brief Hashes all children in a new table (the old one is released with the arena).
+ */
+void TreeNode::rebuildChildHash()
+{
+  int size = TREE_CHILD_HASH_MIN * 2;
+  while (size < m_childCount * 4)
+    size *= 2;
+
+  m_childHash = (int*) m_arena->alloc(size * sizeof(int));
+  memset(m_childHash, 0, size * sizeof(int));
+  m_childHashMask = size - 1;
+  for (int i = 0; i < m_childCount; i++)
+    insertChildHash(i);
+}
+
+/**
+ * @brief Adds a child to the hash (replaces an earlier child with the same name).
+ */
+void TreeNode::insertChildHash(int childIdx)
+{
+  int nameAtom = m_children[childIdx]->m_nameAtom;
+  int i = hashAtom(nameAtom) & m_childHashMask;
+  while (m_childHash[i] != 0 && m_children[m_childHash[i] - 1]->m_nameAtom != nameAtom)
+    i = (i + 1) & m_childHashMask;
+  m_childHash[i] = childIdx + 1;
 }
 
 void TreeNode::copy(const TreeNode& other)
@@ -49,48 +485,37 @@ void TreeNode::copy(const TreeNode& other)
   removeAll();
 
   // Set name and data
-  m_name = other.m_name;
-  m_data = other.m_data;
+  m_nameAtom = other.m_nameAtom;
+  setData(other.m_data, other.m_dataLen);
 
   // Copy all children
-  for (int i = 0; i < other.m_children.size(); i++)
+  for (int i = 0; i < other.m_childCount; i++)
   {
     const TreeNode* otherNode = other.m_children[i];
-    TreeNode* thisNode = new TreeNode;
+    TreeNode* thisNode = addChild(otherNode->m_nameAtom);
     thisNode->copy(*otherNode);
-
-    addChild(thisNode);
-  }
-}
-
-TreeNode::~TreeNode()
-{
-  for (int i = 0; i < m_children.size(); i++)
-  {
-    TreeNode* node = m_children[i];
-    delete node;
   }
 }
 
+/**
+ * @brief Removes all children (the memory is released together with the arena).
+ */
 void TreeNode::removeAll()
 {
-  for (int i = 0; i < m_children.size(); i++)
-  {
-    TreeNode* node = m_children[i];
-    delete node;
-  }
-  m_children.clear();
+  m_childCount = 0;
+  m_childHash = NULL;
+  m_childHashMask = 0;
 }
 
 void TreeNode::dump(int parentCnt)
 {
   QString text;
-  text.sprintf("+- %s='%s'", stringToCStr(m_name), stringToCStr(m_data));
+  text.sprintf("+- %s='%s'", stringToCStr(getName()), m_data);
 
   for (int i = 0; i < parentCnt; i++)
     text = "    " + text;
   debugMsg("%s", stringToCStr(text));
-  for (int i = 0; i < (int) m_children.size(); i++)
+  for (int i = 0; i < m_childCount; i++)
   {
     TreeNode* node = m_children[i];
     node->dump(parentCnt + 1);
@@ -104,6 +529,7 @@ void TreeNode::dump()
 }
 
 Tree::Tree()
+  : m_arena(new TreeArena)
 {
 }
 
@@ -119,7 +545,7 @@ QString TreeNode::getChildDataString(QString childName) const
 {
   TreeNode* child = findChild(childName);
   if (child)
-    return child->m_data;
+    return child->getData();
   return "";
 }
 
@@ -127,10 +553,61 @@ long long TreeNode::getChildDataLongLong(QString childPath, long long defaultVal
 {
   TreeNode* child = findChild(childPath);
   if (child)
-    return stringToLongLong(stringToCStr(child->m_data));
+    return stringToLongLong(child->m_data);
+  return defaultValue;
+}
+
+QString TreeNode::getChildDataString(const TreePath& path) const
+{
+  TreeNode* child = path.resolve(this);
+  if (child)
+    return child->getData();
+  return "";
+}
+
+int TreeNode::getChildDataInt(const TreePath& path, int defaultValue) const
+{
+  TreeNode* child = path.resolve(this);
+  if (child)
+    return child->getDataInt(defaultValue);
+  return defaultValue;
+}
+
+long long TreeNode::getChildDataLongLong(const TreePath& path, long long defaultValue) const
+{
+  TreeNode* child = path.resolve(this);
+  if (child)
+    return stringToLongLong(child->m_data);
   return defaultValue;
 }
 
+/**
+ * @brief Finds a direct child by its name.
+ * @return The last child with the name or NULL if not found.
+ */
+TreeNode* TreeNode::findChildByAtom(int nameAtom) const
+{
+  if (m_childHash != NULL)
+  {
+    for (int i = hashAtom(nameAtom) & m_childHashMask;; i = (i + 1) & m_childHashMask)
+    {
+      int childIdx = m_childHash[i] - 1;
+      if (childIdx < 0)
+        return NULL;
+      if (m_children[childIdx]->m_nameAtom == nameAtom)
+        return m_children[childIdx];
+    }
+  }
+
+  for (int i = m_childCount - 1; i >= 0; i--)
+  {
+    TreeNode* child = m_children[i];
+    if (child->m_nameAtom == nameAtom)
+      return child;
+  }
+  return NULL;
+}
+
 TreeNode* TreeNode::findChild(QString path) const
 {
   QString childName;
@@ -151,80 +628,84 @@ TreeNode* TreeNode::findChild(QString path) const
     restPath = path.mid(indexPos + 1);
   }
 
+  TreeNode* child = NULL;
   if (childName.startsWith('#'))
   {
     QString numStr = childName.mid(1);
     int idx = atoi(stringToCStr(numStr)) - 1;
     if (0 <= idx && idx < getChildCount())
-    {
-      TreeNode* child = getChild(idx);
-      if (restPath.isEmpty())
-        return child;
-      else
-        return child->findChild(restPath);
-    }
+      child = getChild(idx);
   }
   else
   {
-
-    TreeNode* child;
-
-    if (m_childMap.contains(childName))
-    {
-      child = m_childMap[childName];
-      assert(child->m_name == childName);
-      if (restPath.isEmpty())
-        return child;
-      else
-        return child->findChild(restPath);
-    }
-    else
-    {
-      // Look for the child
-      for (int u = 0; u < getChildCount(); u++)
-      {
-        child = getChild(u);
-
-        if (child->getName() == childName)
-        {
-          if (restPath.isEmpty())
-            return child;
-          else
-            return child->findChild(restPath);
-        }
-      }
-    }
+    // A name that has never been interned can not be in the tree
+    int nameAtom = TreeAtomTable::lookup(childName);
+    if (nameAtom != -1)
+      child = findChildByAtom(nameAtom);
   }
 
-  return NULL;
+  if (child == NULL || restPath.isEmpty())
+    return child;
+  return child->findChild(restPath);
 }
 
 QString Tree::getString(QString path) const
 {
-  return m_root.getChildDataString(path);
+  return m_arena->getRoot()->getChildDataString(path);
 }
 
 int Tree::getInt(QString path, int defaultValue) const
 {
-  return m_root.getChildDataInt(path, defaultValue);
+  return m_arena->getRoot()->getChildDataInt(path, defaultValue);
 }
 
 long long Tree::getLongLong(QString path) const
 {
-  return m_root.getChildDataLongLong(path);
+  return m_arena->getRoot()->getChildDataLongLong(path);
 }
 
 TreeNode* Tree::findChild(QString path) const
 {
-  return m_root.findChild(path);
+  return m_arena->getRoot()->findChild(path);
+}
+
+QString Tree::getString(const TreePath& path) const
+{
+  return m_arena->getRoot()->getChildDataString(path);
+}
+
+int Tree::getInt(const TreePath& path, int defaultValue) const
+{
+  return m_arena->getRoot()->getChildDataInt(path, defaultValue);
+}
+
+TreeNode* Tree::findChild(const TreePath& path) const
+{
+  return path.resolve(m_arena->getRoot());
 }
 
 void Tree::removeAll()
 {
-  m_root.removeAll();
+  // Start over with a new arena (a shared arena must never be written to again)
+  if (m_arena->isShared() || m_arena->getRoot()->getChildCount() > 0)
+    m_arena = QSharedPointer<TreeArena>(new TreeArena);
 }
 
+/**
+ * @brief Makes a deep copy of another tree.
+ */
 void Tree::copy(const Tree& other)
 {
-  m_root.copy(other.m_root);
+  m_arena = QSharedPointer<TreeArena>(new TreeArena);
+  m_arena->getRoot()->copy(*other.m_arena->getRoot());
+}
+
+/**
+ * @brief Makes this tree refer to the nodes of another tree without copying them.
+ * The nodes are released when the last tree referring to them is destroyed.
+ */
+void Tree::share(const Tree& other)
+{
+  m_arena = other.m_arena;
+  m_arena->setShared();
 }
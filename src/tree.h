@@ -9,49 +9,148 @@
 #ifndef FILE__TREE_H
 #define FILE__TREE_H
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QByteArray>
 #include <QHash>
 #include <QList>
+#include <QMutex>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringList>
 #include <QVector>
 
-class TreeNode
+// Number of names in each chunk of the atom table
+#define TREE_ATOM_CHUNK_SIZE 1024
+
+// Max number of chunks in the atom table
+#define TREE_ATOM_MAX_CHUNKS 1024
+
+/**
+ * @brief Interns node names so that they can be compared as integers.
+ * The table is shared by all trees and may be accessed from any thread. The names are never
+ * removed or moved, so finding a name that has been interned before and getName() do not take
+ * any lock (only adding a new name does).
+ * The names of list items ("1", "2", ...) are not stored in the table but encoded in the atom.
+ */
+class TreeAtomTable
 {
 public:
-  TreeNode();
-  TreeNode(QString name);
-  virtual ~TreeNode();
+  static int intern(const char* name, int len);
+  static int intern(QString name);
+  static int internIndex(int idx);
+  static int lookup(QString name);
+  static QString getName(int atom);
+
+  static bool isIndexAtom(int atom)
+  {
+    return atom <= -2;
+  };
+
+private:
+  struct Entry
+  {
+    QByteArray m_bytes; //!< The name as UTF-8.
+    QString m_name;
+  };
+  struct HashTable
+  {
+    int m_mask; //!< Number of slots - 1.
+    QAtomicInt* m_slots; //!< The atom+1 of the name in each slot (or 0 if free).
+  };
+
+  TreeAtomTable();
+  ~TreeAtomTable();
+  static TreeAtomTable& getInstance();
+  int find(const char* name, int len, quint32 hash) const;
+  int add(const char* name, int len, quint32 hash);
+  const Entry& getEntry(int atom) const;
+  static void insert(HashTable* table, quint32 hash, int atom);
+
+private:
+  QMutex m_mutex; //!< Taken when a name is added.
+  QAtomicInt m_count; //!< Number of names.
+  QAtomicPointer<Entry> m_chunks[TREE_ATOM_MAX_CHUNKS];
+  QAtomicPointer<HashTable> m_table; //!< Open addressing hash of the names (never more than half full).
+  QList<HashTable*> m_oldTables; //!< Tables that has been replaced by a larger one (another thread may still be reading them).
+};
 
+class TreeArena;
+class TreeNode;
+
+/**
+ * @brief A path to a node (Eg: "frame/func" or "memory/#1/contents").
+ * The path is split and its names are interned once when the path is created so
+ * that it can be resolved many times without any string handling.
+ */
+class TreePath
+{
+public:
+  explicit TreePath(const char* path);
+
+  TreeNode* resolve(const TreeNode* node) const;
+
+private:
+  struct Step
+  {
+    int m_nameAtom; //!< The name of the child or -1 if the child is selected by index.
+    int m_index; //!< The index of the child (for "#N").
+  };
+  QVector<Step> m_steps;
+};
+
+class TreeNode
+{
+public:
   TreeNode* findChild(QString path) const;
+  TreeNode* findChild(const TreePath& path) const
+  {
+    return path.resolve(this);
+  };
+  TreeNode* findChildByAtom(int nameAtom) const;
 
-  void addChild(TreeNode* child);
+  TreeNode* addChild(QString name);
+  TreeNode* addChild(int nameAtom);
   TreeNode* getChild(int i) const
   {
     return m_children[i];
   };
   int getChildCount() const
   {
-    return m_children.size();
+    return m_childCount;
   };
   QString getData() const
+  {
+    return QString::fromUtf8(m_data, m_dataLen);
+  };
+  const char* getDataPtr() const
   {
     return m_data;
   };
+  int getDataLength() const
+  {
+    return m_dataLen;
+  };
   int getDataInt(int defaultValue = 0) const;
 
   QString getChildDataString(QString childName) const;
   int getChildDataInt(QString path, int defaultValue = 0) const;
   long long getChildDataLongLong(QString path, long long defaultValue = 0) const;
+  QString getChildDataString(const TreePath& path) const;
+  int getChildDataInt(const TreePath& path, int defaultValue = 0) const;
+  long long getChildDataLongLong(const TreePath& path, long long defaultValue = 0) const;
 
-  void setData(QString data)
-  {
-    m_data = data;
-  };
+  void setData(QString data);
+  void setData(const char* data, int len);
   void dump();
 
   QString getName() const
   {
-    return m_name;
+    return TreeAtomTable::getName(m_nameAtom);
+  };
+  int getNameAtom() const
+  {
+    return m_nameAtom;
   };
 
   void removeAll();
@@ -59,20 +158,64 @@ public:
   void copy(const TreeNode& other);
 
 private:
+  TreeNode(TreeArena* arena, int nameAtom);
   void dump(int parentCnt);
+  void rebuildChildHash();
+  void insertChildHash(int childIdx);
 
 private:
+  TreeArena* m_arena; //!< The arena that owns the node.
   TreeNode* m_parent;
-  QString m_name;
-  QString m_data;
-  QVector<TreeNode*> m_children;
-  QHash<QString, TreeNode*> m_childMap;
+  int m_nameAtom;
+  const char* m_data; //!< Null terminated UTF-8 data (owned by the arena).
+  int m_dataLen;
+  TreeNode** m_children;
+  int m_childCount;
+  int m_childCapacity;
+  int* m_childHash; //!< The index+1 of the children hashed by their name atom (or NULL if the node has few children).
+  int m_childHashMask; //!< Number of slots in m_childHash - 1.
 
-private:
-  TreeNode(const TreeNode&){};
+  friend class TreeArena;
 };
 
-class Token;
+/**
+ * @brief Bump allocator that owns all the nodes (and their data) of a tree.
+ * Everything is freed at once when the arena is destroyed.
+ */
+class TreeArena
+{
+public:
+  TreeArena();
+  ~TreeArena();
+
+  void* alloc(int size);
+  const char* allocString(const char* str, int len);
+  TreeNode* allocNode(int nameAtom);
+
+  TreeNode* getRoot()
+  {
+    return &m_root;
+  };
+  void setShared()
+  {
+    m_isShared = true;
+  };
+  bool isShared() const
+  {
+    return m_isShared;
+  };
+
+private:
+  TreeArena(const TreeArena&);
+
+private:
+  QList<char*> m_blocks;
+  char* m_blockPtr; //!< Next free byte in the current block.
+  int m_blockLeft; //!< Number of free bytes in the current block.
+  int m_nextBlockSize;
+  bool m_isShared; //!< True if the arena has been shared by more than one tree.
+  TreeNode m_root;
+};
 
 class Tree
 {
@@ -81,49 +224,41 @@ public:
 
   void dump()
   {
-    m_root.dump();
+    getRoot()->dump();
   };
 
   QString getString(QString path) const;
   int getInt(QString path, int defaultValue = 0) const;
   long long getLongLong(QString path) const;
+  QString getString(const TreePath& path) const;
+  int getInt(const TreePath& path, int defaultValue = 0) const;
 
   TreeNode* getChildAt(int idx)
   {
-    return m_root.getChild(idx);
+    return getRoot()->getChild(idx);
   };
   int getRootChildCount() const
   {
-    return m_root.getChildCount();
+    return m_arena->getRoot()->getChildCount();
   };
 
   TreeNode* findChild(QString path) const;
+  TreeNode* findChild(const TreePath& path) const;
 
   TreeNode* getRoot()
   {
-    return &m_root;
+    return m_arena->getRoot();
   };
   void copy(const Tree& other);
+  void share(const Tree& other);
 
   void removeAll();
 
-private:
-  TreeNode fromStringToTree(QString str);
-  QList<Token*> tokenize(QString str);
-  Token* pop_token();
-  Token* peek_token();
-
-  void parseGroup(TreeNode* parentNode);
-  void parseVar(TreeNode* parentNode);
-  void parseVarList(TreeNode* parentNode);
-  void parseData(TreeNode* ownerNode);
-  void parseDataList(TreeNode* ownerNode);
-
 private:
   Tree(const Tree&){};
 
 private:
-  TreeNode m_root;
+  QSharedPointer<TreeArena> m_arena;
 };
 
 #endif // FILE__TREE_H
@@ -17,6 +17,10 @@
 #include <assert.h>
 #include <stdio.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /**
  * @brief Divides a path into a filename and a path.
  *
@@ -182,6 +186,93 @@ quint8 hexStringToU8(const char* str)
   return d;
 }
 
+/**
+ * @brief Value of each hex digit (or -1 for characters that are not hex digits).
+ */
+static const signed char g_hexDigitValue[256] = {
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+#if defined(__SSE2__)
+/**
+ * @brief Converts 16 hex digits to 16-bit lanes holding one decoded byte each.
+ * @param valid   Set to false if any of the characters is not a hex digit.
+ */
+static inline __m128i hexDecode16(__m128i v, bool* valid)
+{
+  // '0'-'9'
+  __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+  __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(d, _mm_set1_epi8(-1)), _mm_cmplt_epi8(d, _mm_set1_epi8(10)));
+
+  // 'a'-'f' and 'A'-'F'
+  __m128i l = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  __m128i isAlpha = _mm_and_si128(_mm_cmpgt_epi8(l, _mm_set1_epi8(-1)), _mm_cmplt_epi8(l, _mm_set1_epi8(6)));
+  l = _mm_add_epi8(l, _mm_set1_epi8(10));
+
+  if (_mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) != 0xffff)
+    *valid = false;
+
+  __m128i nibbles = _mm_or_si128(_mm_and_si128(d, isDigit), _mm_and_si128(l, isAlpha));
+
+  // Each 16-bit lane holds the high nibble in its low byte and the low nibble in its high byte
+  __m128i hi = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4);
+  __m128i lo = _mm_srli_epi16(nibbles, 8);
+  return _mm_or_si128(hi, lo);
+}
+#endif
+
+/**
+ * @brief Converts a hex string (Eg: "00ff1a") to bytes.
+ * @param hexLen   The number of characters in hexStr (an odd last character is ignored).
+ * @param data     Receives hexLen/2 bytes.
+ * @return The number of bytes decoded or -1 if the string contains a character that is not a hex digit.
+ */
+int hexDecode(const char* hexStr, int hexLen, quint8* data)
+{
+  int byteCount = hexLen / 2;
+  int i = 0;
+
+#if defined(__SSE2__)
+  // 32 hex digits per iteration
+  bool valid = true;
+  for (; i + 16 <= byteCount && valid; i += 16)
+  {
+    __m128i a = hexDecode16(_mm_loadu_si128((const __m128i*) (hexStr + i * 2)), &valid);
+    __m128i b = hexDecode16(_mm_loadu_si128((const __m128i*) (hexStr + i * 2 + 16)), &valid);
+    _mm_storeu_si128((__m128i*) (data + i), _mm_packus_epi16(a, b));
+  }
+  if (!valid)
+    return -1;
+#endif
+
+  // The tail (or everything if there is no SIMD support)
+  for (; i < byteCount; i++)
+  {
+    int hi = g_hexDigitValue[(unsigned char) hexStr[i * 2]];
+    int lo = g_hexDigitValue[(unsigned char) hexStr[i * 2 + 1]];
+    if (hi < 0 || lo < 0)
+      return -1;
+    data[i] = (quint8) ((hi << 4) | lo);
+  }
+
+  return byteCount;
+}
+
 long long stringToLongLong(QString str)
 {
   return stringToLongLong(stringToCStr(str));
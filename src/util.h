@@ -23,6 +23,7 @@ void dividePath(QString fullPath, QString* filename, QString* folderPath);
 QString getExtensionPart(QString filename);
 
 quint8 hexStringToU8(const char* str);
+int hexDecode(const char* hexStr, int hexLen, quint8* data);
 long long stringToLongLong(const char* str);
 long long stringToLongLong(QString str);
 QString longLongToHexString(long long num);
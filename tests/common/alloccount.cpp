@@ -0,0 +1,34 @@
+/*
+ * Replaces malloc, calloc and realloc with versions that count the number of
+ * allocations in g_allocCount.
+ */
+
+#include "alloccount.h"
+
+#include <stddef.h>
+
+long g_allocCount = 0;
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t nmemb, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    __sync_fetch_and_add(&g_allocCount, 1);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size)
+{
+    __sync_fetch_and_add(&g_allocCount, 1);
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    __sync_fetch_and_add(&g_allocCount, 1);
+    return __libc_realloc(ptr, size);
+}
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Counts the heap allocations made by a test program. Link alloccount.cpp
+ * into the program to install the hooks.
+ */
+
+#ifndef FILE__ALLOCCOUNT_H
+#define FILE__ALLOCCOUNT_H
+
+// All heap allocations (operator new, QByteArray, QString, QVector, ...) are counted in g_allocCount.
+// The counter is only updated with glibc (where malloc can be replaced).
+extern long g_allocCount;
+
+#endif // FILE__ALLOCCOUNT_H
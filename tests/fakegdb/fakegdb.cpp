@@ -0,0 +1,402 @@
+/*
+ * A stand-in for GDB that speaks enough GDB/MI for gede to start a session
+ * and to step in it. The responses are either generated (with a configurable
+ * size) or played back from a script. Useful to measure the responsiveness
+ * of gede without a real debugger.
+ */
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QStringList>
+#include <QThread>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct Config
+{
+    int m_threadCount;
+    int m_localCount;
+    int m_stackDepth;
+    int m_payloadSize; //!< Size of the value of each variable.
+    int m_latency; //!< Delay (ms) before each response.
+    QMap<QByteArray, int> m_cmdLatency; //!< Delay (ms) for specific commands.
+    QByteArray m_sourcePath;
+    QList<QPair<QByteArray, QList<QByteArray> > > m_script; //!< Command prefix => response rows.
+};
+
+struct State
+{
+    int m_stopCount;
+    int m_lineNo;
+    int m_bkptCount;
+    int m_currentThreadId;
+    QList<QByteArray> m_varList; //!< Names of the variable objects created.
+};
+
+static Config g_cfg;
+static State g_state;
+
+
+int dumpUsage()
+{
+    printf("Usage: ./fakegdb [OPTIONS] [--interpreter=mi2]\n");
+    printf("Description:\n");
+    printf("  Acts like 'gdb --interpreter=mi2' for a program that is never run.\n");
+    printf("  Start gede with this program as the gdb path (Eg: \"/path/to/fakegdb -t 10000\").\n");
+    printf("Options:\n");
+    printf("  -t THREADS      Number of threads in the program (default 4).\n");
+    printf("  -v LOCALS       Number of local variables in each frame (default 8).\n");
+    printf("  -d DEPTH        Number of frames in the stack (default 8).\n");
+    printf("  -p BYTES        Size of the value of each variable (default 8).\n");
+    printf("  -l MS           Delay before each response (default 0).\n");
+    printf("  -L CMD=MS       Delay before the response to a specific command (Eg: -L -thread-info=200).\n");
+    printf("  -f PATH         The source file that the program is stopped in.\n");
+    printf("  -s SCRIPT       Responses to play back (see example.script).\n");
+    return 1;
+}
+
+void writeRow(QByteArray row)
+{
+    row += "\n";
+    fwrite(row.constData(), 1, row.size(), stdout);
+}
+
+void flushRows()
+{
+    fflush(stdout);
+}
+
+QByteArray quote(QByteArray str)
+{
+    str.replace('\\', "\\\\");
+    str.replace('"', "\\\"");
+    return "\"" + str + "\"";
+}
+
+QByteArray frameTuple(int level, int lineNo)
+{
+    return "{level=\"" + QByteArray::number(level) + "\",addr=\"0x00005555555551" + QByteArray::number(0xa0 + level, 16) + "\","
+           "func=\"" + (level == 0 ? QByteArray("main") : "func" + QByteArray::number(level)) + "\",args=[],"
+           "file=" + quote(QFileInfo(g_cfg.m_sourcePath).fileName().toUtf8()) + ",fullname=" + quote(g_cfg.m_sourcePath) + ","
+           "line=\"" + QByteArray::number(lineNo) + "\"}";
+}
+
+/**
+ * @brief Returns the value that all variables has at the current stop.
+ */
+QByteArray varValue()
+{
+    if(g_cfg.m_payloadSize <= 8)
+        return QByteArray::number(g_state.m_stopCount).right(g_cfg.m_payloadSize);
+    return QByteArray(g_cfg.m_payloadSize, 'a' + g_state.m_stopCount % 26);
+}
+
+/**
+ * @brief Writes the rows for a command that resumes the target and the following stop.
+ */
+void respondExec(QByteArray tokenStr, const char *reason)
+{
+    writeRow(tokenStr + "^running");
+    writeRow("*running,thread-id=\"all\"");
+    writeRow("(gdb)");
+    flushRows();
+
+    g_state.m_stopCount++;
+    g_state.m_lineNo = 10 + g_state.m_stopCount % 100;
+
+    writeRow("*stopped,reason=\"" + QByteArray(reason) + "\",frame=" + frameTuple(0, g_state.m_lineNo) + ","
+             "thread-id=\"" + QByteArray::number(g_state.m_currentThreadId) + "\",stopped-threads=\"all\",core=\"0\"");
+}
+
+/**
+ * @brief Writes a generated response to a command.
+ * @return false if GDB should exit.
+ */
+bool respondGenerated(QByteArray tokenStr, QByteArray cmd, QList<QByteArray> args)
+{
+    QByteArray resp = tokenStr + "^done";
+
+    if(cmd == "-gdb-exit")
+    {
+        writeRow(tokenStr + "^exit");
+        return false;
+    }
+    else if(cmd == "-exec-run")
+        respondExec(tokenStr, "breakpoint-hit");
+    else if(cmd == "-exec-next" || cmd == "-exec-step" || cmd == "-exec-step-instruction" || cmd == "-exec-jump")
+        respondExec(tokenStr, "end-stepping-range");
+    else if(cmd == "-exec-finish")
+        respondExec(tokenStr, "function-finished");
+    else if(cmd == "-exec-continue")
+        respondExec(tokenStr, "breakpoint-hit");
+    else if(cmd == "-data-evaluate-expression")
+    {
+        if(args.join(' ') == "\"sizeof(void *)\"")
+            resp += ",value=\"8\"";
+        else
+            resp += ",value=" + quote(varValue());
+        writeRow(resp);
+    }
+    else if(cmd == "-break-insert")
+    {
+        g_state.m_bkptCount++;
+        resp += ",bkpt={number=\"" + QByteArray::number(g_state.m_bkptCount) + "\",type=\"breakpoint\",disp=\"keep\",enabled=\"y\","
+                "addr=\"0x00005555555551a0\",func=\"main\",file=" + quote(QFileInfo(g_cfg.m_sourcePath).fileName().toUtf8()) + ","
+                "fullname=" + quote(g_cfg.m_sourcePath) + ",line=\"10\",thread-groups=[\"i1\"],times=\"0\",original-location=\"main\"}";
+        writeRow(resp);
+    }
+    else if(cmd == "-file-list-exec-source-files")
+    {
+        resp += ",files=[{file=" + quote(QFileInfo(g_cfg.m_sourcePath).fileName().toUtf8()) + ",fullname=" + quote(g_cfg.m_sourcePath) + "}]";
+        writeRow(resp);
+    }
+    else if(cmd == "-list-thread-groups")
+    {
+        resp += ",groups=[{id=\"i1\",type=\"process\",pid=\"4242\",executable=\"/tmp/fakeprogram\",cores=[\"0\"]}]";
+        writeRow(resp);
+    }
+    else if(cmd == "-thread-info")
+    {
+        resp += ",threads=[";
+        for(int t = 0;t < g_cfg.m_threadCount;t++)
+        {
+            if(t != 0)
+                resp += ",";
+            resp += "{id=\"" + QByteArray::number(t+1) + "\",target-id=\"Thread 0x7ffff7d8" + QByteArray::number(t, 16) + " (LWP " + QByteArray::number(4242+t) + ")\","
+                    "name=\"thread" + QByteArray::number(t+1) + "\",frame=" + frameTuple(0, g_state.m_lineNo) + ",state=\"stopped\",core=\"0\"}";
+        }
+        resp += "],current-thread-id=\"" + QByteArray::number(g_state.m_currentThreadId) + "\"";
+        writeRow(resp);
+    }
+    else if(cmd == "-thread-select")
+    {
+        if(!args.isEmpty())
+            g_state.m_currentThreadId = args[0].toInt();
+        resp += ",new-thread-id=\"" + QByteArray::number(g_state.m_currentThreadId) + "\",frame=" + frameTuple(0, g_state.m_lineNo);
+        writeRow(resp);
+    }
+    else if(cmd == "-stack-list-frames")
+    {
+        resp += ",stack=[";
+        for(int i = 0;i < g_cfg.m_stackDepth;i++)
+        {
+            if(i != 0)
+                resp += ",";
+            resp += "frame=" + frameTuple(i, i == 0 ? g_state.m_lineNo : 100 + i);
+        }
+        resp += "]";
+        writeRow(resp);
+    }
+    else if(cmd == "-stack-info-frame")
+    {
+        resp += ",frame=" + frameTuple(0, g_state.m_lineNo);
+        writeRow(resp);
+    }
+    else if(cmd == "-stack-list-variables")
+    {
+        resp += ",variables=[";
+        for(int i = 0;i < g_cfg.m_localCount;i++)
+        {
+            if(i != 0)
+                resp += ",";
+            resp += "{name=\"local" + QByteArray::number(i) + "\"}";
+        }
+        resp += "]";
+        writeRow(resp);
+    }
+    else if(cmd == "-var-create")
+    {
+        QByteArray name = args.value(0);
+        if(!g_state.m_varList.contains(name))
+            g_state.m_varList.append(name);
+        resp += ",name=" + quote(name) + ",numchild=\"0\",value=" + quote(varValue()) + ",type=\"int\",thread-id=\"1\",has_more=\"0\"";
+        writeRow(resp);
+    }
+    else if(cmd == "-var-delete")
+    {
+        g_state.m_varList.removeAll(args.value(0));
+        resp += ",ndeleted=\"1\"";
+        writeRow(resp);
+    }
+    else if(cmd == "-var-update")
+    {
+        resp += ",changelist=[";
+        for(int i = 0;i < g_state.m_varList.size();i++)
+        {
+            if(i != 0)
+                resp += ",";
+            resp += "{name=" + quote(g_state.m_varList[i]) + ",value=" + quote(varValue()) + ",in_scope=\"true\",type_changed=\"false\",has_more=\"0\"}";
+        }
+        resp += "]";
+        writeRow(resp);
+    }
+    else if(cmd == "-var-list-children")
+    {
+        resp += ",numchild=\"0\",children=[],has_more=\"0\"";
+        writeRow(resp);
+    }
+    else if(cmd == "-var-info-path-expression")
+    {
+        resp += ",path_expr=" + quote(args.value(0));
+        writeRow(resp);
+    }
+    else if(cmd == "-data-read-memory-bytes")
+    {
+        quint64 addr = args.value(0).toULongLong(NULL, 0);
+        int count = args.value(1).toInt();
+        QByteArray contents;
+        contents.reserve(count * 2);
+        for(int i = 0;i < count;i++)
+            contents += QByteArray::number((quint8)(addr + i), 16).rightJustified(2, '0');
+        resp += ",memory=[{begin=\"0x" + QByteArray::number(addr, 16) + "\",offset=\"0x0\",end=\"0x" + QByteArray::number(addr + count, 16) + "\",contents=\"" + contents + "\"}]";
+        writeRow(resp);
+    }
+    else
+        writeRow(resp);
+    writeRow("(gdb)");
+    return true;
+}
+
+/**
+ * @brief Plays back a scripted response.
+ */
+void respondScripted(QByteArray tokenStr, const QList<QByteArray> &rowList)
+{
+    for(int i = 0;i < rowList.size();i++)
+    {
+        QByteArray row = rowList[i];
+        if(row.startsWith("!sleep "))
+        {
+            flushRows();
+            QThread::msleep(row.mid(7).trimmed().toInt());
+        }
+        else if(row.startsWith('^'))
+            writeRow(tokenStr + row);
+        else
+            writeRow(row);
+    }
+}
+
+int loadScript(QString filename)
+{
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        fprintf(stderr, "Unable to open %s\n", qPrintable(filename));
+        return -1;
+    }
+    while(!file.atEnd())
+    {
+        QByteArray row = file.readLine();
+        row.chop(row.endsWith('\n') ? 1 : 0);
+        if(row.startsWith('#'))
+            continue;
+        if(row.startsWith("> "))
+            g_cfg.m_script.append(qMakePair(row.mid(2).trimmed(), QList<QByteArray>()));
+        else if(!g_cfg.m_script.isEmpty() && !row.trimmed().isEmpty())
+            g_cfg.m_script.last().second.append(row);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    g_cfg.m_threadCount = 4;
+    g_cfg.m_localCount = 8;
+    g_cfg.m_stackDepth = 8;
+    g_cfg.m_payloadSize = 8;
+    g_cfg.m_latency = 0;
+    g_cfg.m_sourcePath = QFileInfo(__FILE__).absoluteFilePath().toUtf8();
+
+    g_state.m_stopCount = 0;
+    g_state.m_lineNo = 10;
+    g_state.m_bkptCount = 0;
+    g_state.m_currentThreadId = 1;
+
+    // Parse arguments
+    for(int i = 1;i < argc;i++)
+    {
+        const char *curArg = argv[i];
+        if(strncmp(curArg, "--interpreter", 13) == 0)
+            continue;
+        else if(strcmp(curArg, "-t") == 0 && i+1 < argc)
+            g_cfg.m_threadCount = atoi(argv[++i]);
+        else if(strcmp(curArg, "-v") == 0 && i+1 < argc)
+            g_cfg.m_localCount = atoi(argv[++i]);
+        else if(strcmp(curArg, "-d") == 0 && i+1 < argc)
+            g_cfg.m_stackDepth = atoi(argv[++i]);
+        else if(strcmp(curArg, "-p") == 0 && i+1 < argc)
+            g_cfg.m_payloadSize = atoi(argv[++i]);
+        else if(strcmp(curArg, "-l") == 0 && i+1 < argc)
+            g_cfg.m_latency = atoi(argv[++i]);
+        else if(strcmp(curArg, "-L") == 0 && i+1 < argc)
+        {
+            QByteArray str = argv[++i];
+            int divPos = str.lastIndexOf('=');
+            if(divPos <= 0)
+                return dumpUsage();
+            g_cfg.m_cmdLatency[str.left(divPos)] = str.mid(divPos+1).toInt();
+        }
+        else if(strcmp(curArg, "-f") == 0 && i+1 < argc)
+            g_cfg.m_sourcePath = argv[++i];
+        else if(strcmp(curArg, "-s") == 0 && i+1 < argc)
+        {
+            if(loadScript(argv[++i]))
+                return 1;
+        }
+        else
+            return dumpUsage();
+    }
+
+    writeRow("=thread-group-added,id=\"i1\"");
+    writeRow("(gdb)");
+    flushRows();
+
+    // Handle the commands
+    char buff[4096];
+    bool running = true;
+    while(running && fgets(buff, sizeof(buff), stdin) != NULL)
+    {
+        QByteArray row = QByteArray(buff).trimmed();
+        if(row.isEmpty())
+            continue;
+
+        // Split into token, command and arguments (Eg: "12-thread-select 2")
+        int cmdStart = 0;
+        while(cmdStart < row.size() && '0' <= row[cmdStart] && row[cmdStart] <= '9')
+            cmdStart++;
+        QByteArray tokenStr = row.left(cmdStart);
+        QByteArray cmdLine = row.mid(cmdStart);
+        QList<QByteArray> args = cmdLine.split(' ');
+        QByteArray cmd = args.takeFirst();
+        while(!args.isEmpty() && args.first().startsWith("--"))
+            args.removeFirst();
+
+        int latency = g_cfg.m_cmdLatency.value(cmd, g_cfg.m_latency);
+        if(latency > 0)
+            QThread::msleep(latency);
+
+        bool scripted = false;
+        for(int i = 0;i < g_cfg.m_script.size() && !scripted;i++)
+        {
+            if(cmdLine.startsWith(g_cfg.m_script[i].first))
+            {
+                respondScripted(tokenStr, g_cfg.m_script[i].second);
+                scripted = true;
+            }
+        }
+        if(!scripted)
+            running = respondGenerated(tokenStr, cmd, args);
+        flushRows();
+    }
+
+    return 0;
+}
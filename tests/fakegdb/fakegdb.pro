@@ -0,0 +1,12 @@
+QT += core
+QT -= gui
+
+TEMPLATE = app
+CONFIG += console
+
+SOURCES+=fakegdb.cpp
+
+QMAKE_CXXFLAGS += -g
+
+
+TARGET=fakegdb
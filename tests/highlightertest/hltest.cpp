@@ -3,84 +3,579 @@
 #include "syntaxhighlightercxx.h"
 #include "syntaxhighlighterbasic.h"
 #include "syntaxhighlighterfortran.h"
+#include "syntaxhighlightergolang.h"
+#include "syntaxhighlighterada.h"
+#include "keywordset.h"
+#include "config.h"
 #include "log.h"
 #include "util.h"
+#include "alloccount.h"
 
 #include <QtGlobal>
 #if QT_VERSION < 0x050000
 #include <QtGui/QApplication>
 #endif
 #include <QApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QFile>
 
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+// Number of times the tokens are looked up in the keyword benchmark
+#define LOOKUP_ITERATIONS 50
+
+
+enum LanguageId
+{
+    LANG_CXX,
+    LANG_RUST,
+    LANG_GO,
+    LANG_ADA,
+    LANG_FORTRAN,
+    LANG_BASIC,
+    LANG_COUNT
+};
+
+struct LanguageInfo
+{
+    const char *m_name;
+    const char *m_extensions; //!< Space separated list of file name endings.
+    const KeywordSet *m_keywords;
+    const char *m_template; //!< Source used to generate a file ('@' is replaced by a number).
+};
+
+static const LanguageInfo g_languages[LANG_COUNT] =
+{
+    { "cxx", ".c .cpp .cc .h .hpp", &g_cxxKeywords,
+        "/* Block comment @\n"
+        " * spanning two lines */\n"
+        "#include <stdio.h>\n"
+        "#define VALUE_@ \"string @\"\n"
+        "\n"
+        "static int func_@(int a, const char *str)\n"
+        "{\n"
+        "    // Line comment @\n"
+        "    for(int i = 0;i < @;i++)\n"
+        "        a += str[i] * 0x@ + '\\n';\n"
+        "    if(a > @ && str->m_next != NULL)\n"
+        "        printf(\"%d: %s\\n\", a, VALUE_@);\n"
+        "    return a;\n"
+        "}\n"
+    },
+    { "rust", ".rs", &g_rustKeywords,
+        "/* Block comment @\n"
+        " * spanning two lines */\n"
+        "fn func_@(a: i32, s: &str) -> i32 {\n"
+        "    // Line comment @\n"
+        "    let mut sum: i32 = a;\n"
+        "    for i in 0..@ {\n"
+        "        sum += i * @ + s.len() as i32;\n"
+        "    }\n"
+        "    println!(\"{} {}\", sum, \"string @\");\n"
+        "    return sum;\n"
+        "}\n"
+    },
+    { "go", ".go", &g_goKeywords,
+        "/* Block comment @\n"
+        " * spanning two lines */\n"
+        "func func_@(a int, s string) int {\n"
+        "\t// Line comment @\n"
+        "\tsum := a\n"
+        "\tfor i := 0; i < @; i++ {\n"
+        "\t\tsum += i * @ + len(s)\n"
+        "\t}\n"
+        "\tfmt.Printf(\"%d %s\\n\", sum, \"string @\")\n"
+        "\treturn sum\n"
+        "}\n"
+    },
+    { "ada", ".adb .ads", &g_adaKeywords,
+        "-- Line comment @\n"
+        "procedure Proc_@ (A : in Integer; S : in String) is\n"
+        "   Sum : Integer := A;\n"
+        "begin\n"
+        "   for I in 1 .. @ loop\n"
+        "      Sum := Sum + I * @ + S'Length;\n"
+        "   end loop;\n"
+        "   Put_Line (\"string @\" & Integer'Image (Sum));\n"
+        "end Proc_@;\n"
+    },
+    { "fortran", ".f95 .f90 .f", &g_fortranKeywords,
+        "! Line comment @\n"
+        "subroutine sub_@(a, n)\n"
+        "    real :: a(n)\n"
+        "    integer :: i, n\n"
+        "    do i = 1, @\n"
+        "        a(i) = a(i) * @.0 + 1.5 ! Comment\n"
+        "    end do\n"
+        "    print *, 'string @', a(1)\n"
+        "end subroutine sub_@\n"
+    },
+    { "basic", ".bas .bi", &g_basicKeywords,
+        "/' Block comment @\n"
+        "   spanning two lines '/\n"
+        "#include \"file.bi\"\n"
+        "' Line comment @\n"
+        "function func_@(a as integer, s as string) as integer\n"
+        "    dim sum as integer = a\n"
+        "    for i as integer = 1 to @\n"
+        "        sum = sum + i * @ + len(s)\n"
+        "    next\n"
+        "    print \"string @\"; sum\n"
+        "    return sum\n"
+        "end function\n"
+    }
+};
+
+
 int dumpUsage()
 {
-    printf("Usage: ./hltest SOURCE_FILE.c\n");
+    printf("Usage: ./hltest [-k] SOURCE_FILE.c\n");
+    printf("       ./hltest -b [-n ITERATIONS] [-s MB] [-o RESULT_FILE] [TESTAPPS_DIR]\n");
     printf("Description:\n");
     printf("  Dumps syntax highlight info for a source file\n");
+    printf("  -k   Benchmarks the keyword lookup of the words in the file instead\n");
+    printf("  -b   Benchmarks the highlighters of all languages on a generated source file\n");
+    printf("       and on the sources in TESTAPPS_DIR (default: ../../testapps), both repeated to MB megabytes.\n");
+    printf("       The results are also written as CSV to RESULT_FILE.\n");
     return 1;
 }
 
+bool isSourceFile(LanguageId lang, QString filename)
+{
+    QStringList extList = QString(g_languages[lang].m_extensions).split(' ');
+    for(int i = 0;i < extList.size();i++)
+    {
+        if(filename.endsWith(extList[i]))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the language of a file based on the file name (C++ if not known).
+ */
+LanguageId findLanguage(QString filename)
+{
+    for(int lang = 0;lang < LANG_COUNT;lang++)
+    {
+        if(isSourceFile((LanguageId)lang, filename))
+            return (LanguageId)lang;
+    }
+    return LANG_CXX;
+}
+
+SyntaxHighlighter *createHighlighter(LanguageId lang)
+{
+    switch(lang)
+    {
+        case LANG_RUST: return new SyntaxHighlighterRust();
+        case LANG_GO: return new SyntaxHighlighterGo();
+        case LANG_ADA: return new SyntaxHighlighterAda();
+        case LANG_FORTRAN: return new SyntaxHighlighterFortran();
+        case LANG_BASIC: return new SyntaxHighlighterBasic();
+        default: break;
+    }
+    return new SyntaxHighlighterCxx();
+}
+
+QString readFile(QString filename)
+{
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly  | QIODevice::Text))
+    {
+        printf("Unable to open %s\n", qPrintable(filename));
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+struct TokenSpan
+{
+    int m_start;
+    int m_length;
+};
+
+/**
+ * @brief Splits a text in words (letters, digits, '_' and '!').
+ */
+template<typename CHAR>
+QVector<TokenSpan> findWords(const CHAR *str, int len)
+{
+    QVector<TokenSpan> list;
+    int start = -1;
+    for(int i = 0;i <= len;i++)
+    {
+        quint32 c = i < len ? keywordCharCode(str[i]) : ' ';
+        bool isWordChar = (c < 128 && isalnum(c)) || c == '_' || c == '!';
+        if(isWordChar && start == -1)
+            start = i;
+        else if(!isWordChar && start != -1)
+        {
+            TokenSpan span;
+            span.m_start = start;
+            span.m_length = i - start;
+            list.append(span);
+            start = -1;
+        }
+    }
+    return list;
+}
+
+void printLookupResult(const char *title, long tokenCount, long hitCount, qint64 ns)
+{
+    printf("  %-28s: %12.0f tokens/s (%ld keywords)\n", title, tokenCount / (ns / 1.0e9), hitCount);
+}
+
+/**
+ * @brief Looks up all words in a text as keywords, the way it was done before (with a QString
+ * per word in a QHash) and with the perfect hash table of a KeywordSet.
+ */
+void benchmarkKeywords(QString text, const KeywordSet &keywords)
+{
+    QVector<TokenSpan> wordList = findWords(text.constData(), text.size());
+    QByteArray utf8 = text.toUtf8();
+    QVector<TokenSpan> utf8WordList = findWords(utf8.constData(), utf8.size());
+    const long tokenCount = (long)wordList.size() * LOOKUP_ITERATIONS;
+    QElapsedTimer timer;
+    long hitCount;
+
+    printf("%d words (%d iterations)\n", wordList.size(), LOOKUP_ITERATIONS);
+
+    // Before: a QString for each word and a QHash lookup
+    QHash<QString, bool> hash;
+    QStringList keywordList = keywords.toStringList();
+    for(int i = 0;i < keywordList.size();i++)
+        hash[keywordList[i]] = true;
+    hitCount = 0;
+    timer.start();
+    for(int it = 0;it < LOOKUP_ITERATIONS;it++)
+    {
+        for(int i = 0;i < wordList.size();i++)
+        {
+            QString word = text.mid(wordList[i].m_start, wordList[i].m_length);
+            if(!keywords.isCaseSensitive())
+                word = word.toLower();
+            if(hash.contains(word))
+                hitCount++;
+        }
+    }
+    printLookupResult("QHash<QString,bool>", tokenCount, hitCount, timer.nsecsElapsed());
+
+    // After: the perfect hash table on the characters of the text
+    const QChar *str = text.constData();
+    hitCount = 0;
+    timer.start();
+    for(int it = 0;it < LOOKUP_ITERATIONS;it++)
+    {
+        for(int i = 0;i < wordList.size();i++)
+        {
+            if(keywords.contains(str + wordList[i].m_start, wordList[i].m_length))
+                hitCount++;
+        }
+    }
+    printLookupResult("KeywordSet (QChar)", tokenCount, hitCount, timer.nsecsElapsed());
+
+    const char *bytes = utf8.constData();
+    hitCount = 0;
+    timer.start();
+    for(int it = 0;it < LOOKUP_ITERATIONS;it++)
+    {
+        for(int i = 0;i < utf8WordList.size();i++)
+        {
+            if(keywords.contains(bytes + utf8WordList[i].m_start, utf8WordList[i].m_length))
+                hitCount++;
+        }
+    }
+    printLookupResult("KeywordSet (UTF-8)", (long)utf8WordList.size() * LOOKUP_ITERATIONS, hitCount, timer.nsecsElapsed());
+}
+
+
+
+/**
+ * @brief Generates a source file by repeating the template of a language.
+ */
+QString generateSource(LanguageId lang, qint64 byteCount)
+{
+    QString templ = g_languages[lang].m_template;
+    QString text;
+    for(int n = 1;text.size() < byteCount;n++)
+    {
+        QString chunk = templ;
+        chunk.replace('@', QString::number(n));
+        text += chunk;
+    }
+    return text;
+}
+
+/**
+ * @brief Concatenates the source files of a language in a directory and repeats them.
+ */
+QString loadCorpus(QString dirPath, LanguageId lang, qint64 byteCount)
+{
+    QStringList fileList;
+    QDirIterator it(dirPath, QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+    {
+        QString filePath = it.next();
+        if(isSourceFile(lang, filePath))
+            fileList.append(filePath);
+    }
+    fileList.sort();
+
+    QString sources;
+    for(int i = 0;i < fileList.size();i++)
+    {
+        sources += readFile(fileList[i]);
+        if(!sources.endsWith('\n'))
+            sources += '\n';
+    }
+    if(sources.isEmpty())
+        return QString();
+
+    QString text;
+    while(text.size() < byteCount)
+        text += sources;
+    return text;
+}
+
+/**
+ * @brief Resets the peak resident set size of the process (only on Linux).
+ */
+void resetPeakRss()
+{
+#ifdef __linux__
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if(f)
+    {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+}
+
+/**
+ * @brief Returns the peak resident set size of the process in kB.
+ */
+long getPeakRss()
+{
+#ifdef __linux__
+    FILE *f = fopen("/proc/self/status", "r");
+    if(f)
+    {
+        char line[256];
+        long peakKb = -1;
+        while(peakKb == -1 && fgets(line, sizeof(line), f))
+        {
+            if(strncmp(line, "VmHWM:", 6) == 0)
+                peakKb = atol(line + 6);
+        }
+        fclose(f);
+        if(peakKb != -1)
+            return peakKb;
+    }
+#endif
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    // ru_maxrss is in bytes on macOS
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+struct BenchResult
+{
+    int m_iterations;
+    qint64 m_byteCount; //!< Total of all iterations.
+    long m_rowCount;
+    qint64 m_ns;
+    long m_allocCount;
+    long m_peakRssKb;
+};
+
+/**
+ * @brief Colorizes a text like the code view does (in blocks of lines with one highlighter each).
+ */
+BenchResult benchmarkHighlighter(LanguageId lang, QString text, int iterations)
+{
+    BenchResult res = {iterations, 0, 0, 0, 0, 0};
+
+    // Split the text in blocks
+    QStringList blockList;
+    int blockStart = 0;
+    int lineCount = 0;
+    for(int i = 0;i < text.size();i++)
+    {
+        if(text[i] == '\n' && ++lineCount == HIGHLIGHT_BLOCK_SIZE)
+        {
+            blockList.append(text.mid(blockStart, i + 1 - blockStart));
+            blockStart = i + 1;
+            lineCount = 0;
+        }
+    }
+    if(blockStart < text.size())
+        blockList.append(text.mid(blockStart));
+    const int byteCount = text.toUtf8().size();
+
+    resetPeakRss();
+    for(int it = 0;it < iterations;it++)
+    {
+        QVector<SyntaxHighlighter*> highlighterList;
+        QElapsedTimer timer;
+        long allocStart = g_allocCount;
+        timer.start();
+
+        int state = SyntaxHighlighter::LINE_STATE_NORMAL;
+        for(int b = 0;b < blockList.size();b++)
+        {
+            SyntaxHighlighter *highlighter = createHighlighter(lang);
+            state = highlighter->colorize(blockList[b], state);
+            res.m_rowCount += highlighter->getRowCount();
+            highlighterList.append(highlighter);
+        }
+
+        res.m_ns += timer.nsecsElapsed();
+        res.m_allocCount += g_allocCount - allocStart;
+        res.m_byteCount += byteCount;
+        res.m_peakRssKb = std::max(res.m_peakRssKb, getPeakRss());
+
+        qDeleteAll(highlighterList);
+    }
+    return res;
+}
+
+void printResult(const char *langName, const char *corpusName, BenchResult res, FILE *resultFile)
+{
+    double secs = res.m_ns / 1.0e9;
+    double mbPerSec = res.m_byteCount / secs / (1024*1024);
+    double rowsPerSec = res.m_rowCount / secs;
+    printf("  %-8s %-10s: %8.2f MB/s %10.0f rows/s", langName, corpusName, mbPerSec, rowsPerSec);
+#ifdef __GLIBC__
+    printf(" %6.2f allocs/row", res.m_rowCount ? ((double)res.m_allocCount) / res.m_rowCount : 0.0);
+#endif
+    printf(" %8.1f MB peak RSS\n", res.m_peakRssKb / 1024.0);
+
+    if(resultFile)
+        fprintf(resultFile, "%s,%s,%lld,%ld,%d,%lld,%.3f,%.0f,%ld,%ld\n", langName, corpusName,
+                (long long)res.m_byteCount, res.m_rowCount, res.m_iterations, (long long)res.m_ns, mbPerSec, rowsPerSec,
+                res.m_allocCount, res.m_peakRssKb);
+}
+
+/**
+ * @brief Runs the highlighter of each language over a generated and a real corpus.
+ */
+int benchmarkAll(QString testappsDir, int iterations, int megaBytes, QString resultFilename)
+{
+    FILE *resultFile = NULL;
+    if(!resultFilename.isEmpty())
+    {
+        resultFile = fopen(qPrintable(resultFilename), "w");
+        if(!resultFile)
+        {
+            printf("Unable to create %s\n", qPrintable(resultFilename));
+            return 1;
+        }
+        fprintf(resultFile, "language,corpus,bytes,rows,iterations,ns,mb_per_s,rows_per_s,allocs,peak_rss_kb\n");
+    }
+
+    printf("%d MB per corpus, %d iterations, blocks of %d lines\n", megaBytes, iterations, HIGHLIGHT_BLOCK_SIZE);
+    for(int lang = 0;lang < LANG_COUNT;lang++)
+    {
+        const char *langName = g_languages[lang].m_name;
+        qint64 byteCount = (qint64)megaBytes * 1024 * 1024;
+
+        QString text = generateSource((LanguageId)lang, byteCount);
+        printResult(langName, "generated", benchmarkHighlighter((LanguageId)lang, text, iterations), resultFile);
+
+        text = loadCorpus(testappsDir, (LanguageId)lang, byteCount);
+        if(text.isEmpty())
+            printf("  %-8s %-10s: no sources found in %s\n", langName, "testapps", qPrintable(testappsDir));
+        else
+            printResult(langName, "testapps", benchmarkHighlighter((LanguageId)lang, text, iterations), resultFile);
+    }
+
+    if(resultFile)
+    {
+        fclose(resultFile);
+        printf("Results written to %s\n", qPrintable(resultFilename));
+    }
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc,argv);
     QString inputFilename;
-    
+    QString resultFilename;
+    bool benchmarkKeywordsMode = false;
+    bool benchmarkMode = false;
+    int iterations = 5;
+    int megaBytes = 8;
+
     // Parse arguments
     for(int i = 1;i < argc;i++)
     {
         const char *curArg = argv[i];
-        if(curArg[0] == '-')
+        if(strcmp(curArg, "-k") == 0)
+            benchmarkKeywordsMode = true;
+        else if(strcmp(curArg, "-b") == 0)
+            benchmarkMode = true;
+        else if(strcmp(curArg, "-n") == 0 && i+1 < argc)
+            iterations = atoi(argv[++i]);
+        else if(strcmp(curArg, "-s") == 0 && i+1 < argc)
+            megaBytes = atoi(argv[++i]);
+        else if(strcmp(curArg, "-o") == 0 && i+1 < argc)
+            resultFilename = argv[++i];
+        else if(curArg[0] == '-')
             return dumpUsage();
         else
         {
             inputFilename = curArg;
         }
     }
+
+    if(benchmarkMode)
+    {
+        if(iterations <= 0 || megaBytes <= 0)
+            return dumpUsage();
+        return benchmarkAll(inputFilename.isEmpty() ? "../../testapps" : inputFilename, iterations, megaBytes, resultFilename);
+    }
     if(inputFilename.isEmpty())
         return dumpUsage();
 
-    // Open file
-    QFile file(inputFilename);
-    if(!file.open(QIODevice::ReadOnly  | QIODevice::Text))
+    // Read entire content
+    if(!QFile::exists(inputFilename))
     {
         printf("Unable to open %s\n", qPrintable(inputFilename));
         return 1;
     }
+    QString text = readFile(inputFilename);
+    LanguageId lang = findLanguage(inputFilename);
 
-    // Read entire content
-    QString text;
-    while (!file.atEnd())
+    if(benchmarkKeywordsMode)
     {
-         QByteArray line = file.readLine();
-         text += line;
+        benchmarkKeywords(text, *g_languages[lang].m_keywords);
+        return 0;
     }
 
-    Settings cfg;
-    
-    SyntaxHighlighter *scanner = NULL;
-    if(inputFilename.endsWith(".rs"))
-        scanner = new SyntaxHighlighterRust();
-    else if(inputFilename.endsWith(".bas"))
-        scanner = new SyntaxHighlighterBasic();
-    else if(inputFilename.endsWith(".f95"))
-        scanner = new SyntaxHighlighterFortran();
-    else
-        scanner = new SyntaxHighlighterCxx();
-
-    scanner->setConfig(&cfg);
+    SyntaxHighlighter *scanner = createHighlighter(lang);
 
-    scanner->colorize(text);
+    scanner->colorize(text, SyntaxHighlighter::LINE_STATE_NORMAL);
 
     for(unsigned int rowIdx = 0;rowIdx < scanner->getRowCount();rowIdx++)
     {
-        QVector<TextField*> colList = scanner->getRow(rowIdx);
+        TextRow row = scanner->getRow(rowIdx);
         printf("%3d | ", rowIdx);
-        for(int colIdx = 0; colIdx < colList.size();colIdx++)
+        for(int colIdx = 0; colIdx < row.getFieldCount();colIdx++)
         {
-            TextField* field = colList[colIdx];
-            printf("'\033[1;32m%s\033[1;0m' ", stringToCStr(field->m_text));
+            printf("'\033[1;32m%s\033[1;0m' ", stringToCStr(row.getText(colIdx).toString()));
         }
         printf("\n");
     }
@@ -6,6 +6,7 @@ else {
 }
 
 TEMPLATE = app
+CONFIG += c++14
 
 SOURCES+=hltest.cpp
 
@@ -17,8 +18,11 @@ HEADERS+=../../src/syntaxhighlighterrust.h
 SOURCES+=../../src/syntaxhighlighterfortran.cpp
 HEADERS+=../../src/syntaxhighlighterfortran.h
 
-SOURCES+=../../src/parsecharqueue.cpp
-HEADERS+=../../src/parsecharqueue.h
+SOURCES+=../../src/syntaxhighlightergolang.cpp ../../src/syntaxhighlighterada.cpp
+HEADERS+=../../src/syntaxhighlightergolang.h ../../src/syntaxhighlighterada.h
+
+SOURCES+=../../src/keywordset.cpp
+HEADERS+=../../src/keywordset.h
 
 
 SOURCES+=../../src/settings.cpp ../../src/ini.cpp
@@ -26,12 +30,15 @@ HEADERS+=../../src/settings.h ../../src/ini.h
 
 SOURCES+=../../src/log.cpp
 HEADERS+=../../src/log.h
+HEADERS+=../../src/config.h
 SOURCES+=../../src/util.cpp
 HEADERS+=../../src/util.h
+SOURCES+=../common/alloccount.cpp
+HEADERS+=../common/alloccount.h
 
 
 
-QMAKE_CXXFLAGS += -I../../src  -g
+QMAKE_CXXFLAGS += -I../../src -I../common  -g
 
 
 TARGET=hltest
@@ -0,0 +1,178 @@
+#include "com.h"
+#include "tree.h"
+#include "log.h"
+#include "util.h"
+
+#include <QtGlobal>
+#if QT_VERSION < 0x050000
+#include <QtGui/QApplication>
+#endif
+#include <QApplication>
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+int dumpUsage()
+{
+    printf("Usage: ./mibench [-t THREAD_COUNT] [-n ITERATIONS]\n");
+    printf("Description:\n");
+    printf("  Measures the cost of parsing a -thread-info reply and of looking up its fields\n");
+    return 1;
+}
+
+/**
+ * @brief Creates the text of a '-thread-info' reply (as sent by GDB) with a number of threads.
+ */
+QByteArray createThreadInfo(int threadCount)
+{
+    QString text = "^done,threads=[";
+    for(int i = 0;i < threadCount;i++)
+    {
+        if(i > 0)
+            text += ",";
+        text += QString("{id=\"%1\",target-id=\"Thread 0x7ffff7d8%2 (LWP %3)\",name=\"worker%4\",")
+                    .arg(i+1).arg(i, 4, 16, QChar('0')).arg(1000+i).arg(i);
+        text += QString("frame={level=\"0\",addr=\"0x00005555555551a9\",func=\"worker_func%1\",args=[],"
+                        "file=\"worker.c\",fullname=\"/home/user/src/worker.c\",line=\"%2\"},")
+                    .arg(i%7).arg(10+i%50);
+        text += QString("state=\"stopped\",core=\"%1\"}").arg(i%8);
+    }
+    text += "],current-thread-id=\"1\"\n(gdb) \n";
+    return text.toUtf8();
+}
+
+/**
+ * @brief Parses a reply the same way as the output from GDB is parsed.
+ * @return The result record (or NULL).
+ */
+Resp *parseReply(GdbReader &reader, const QByteArray &text)
+{
+    Resp *result = NULL;
+    Resp *resp = NULL;
+
+    reader.feedOutput(text);
+    while(reader.popResp(&resp, 0))
+    {
+        if(result == NULL && resp->isResult())
+            result = resp;
+        else
+            delete resp;
+    }
+    return result;
+}
+
+/**
+ * @brief Extracts the thread info in the same way as Core::onResult() using string paths.
+ */
+int scanWithStrings(Tree &tree)
+{
+    int sum = 0;
+    TreeNode *rootNode = tree.findChild("threads");
+    for(int cIdx = 0;cIdx < rootNode->getChildCount();cIdx++)
+    {
+        TreeNode *child = rootNode->getChild(cIdx);
+        QString threadId = child->getChildDataString("id");
+        QString targetId = child->getChildDataString("target-id");
+        QString funcName = child->getChildDataString("frame/func");
+        QString lineNo = child->getChildDataString("frame/line");
+        QString details = child->getChildDataString("details");
+        sum += threadId.size() + targetId.size() + funcName.size() + lineNo.size() + details.size();
+    }
+    return sum;
+}
+
+/**
+ * @brief Extracts the thread info in the same way as Core::onResult() using precompiled paths.
+ */
+int scanWithPaths(Tree &tree)
+{
+    static const TreePath pathThreads("threads");
+    static const TreePath pathId("id");
+    static const TreePath pathTargetId("target-id");
+    static const TreePath pathFrameFunc("frame/func");
+    static const TreePath pathFrameLine("frame/line");
+    static const TreePath pathDetails("details");
+    int sum = 0;
+    TreeNode *rootNode = tree.findChild(pathThreads);
+    for(int cIdx = 0;cIdx < rootNode->getChildCount();cIdx++)
+    {
+        TreeNode *child = rootNode->getChild(cIdx);
+        QString threadId = child->getChildDataString(pathId);
+        QString targetId = child->getChildDataString(pathTargetId);
+        QString funcName = child->getChildDataString(pathFrameFunc);
+        QString lineNo = child->getChildDataString(pathFrameLine);
+        QString details = child->getChildDataString(pathDetails);
+        sum += threadId.size() + targetId.size() + funcName.size() + lineNo.size() + details.size();
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc,argv);
+    int threadCount = 1000;
+    int iterations = 200;
+
+    // Parse arguments
+    for(int i = 1;i < argc;i++)
+    {
+        const char *curArg = argv[i];
+        if(strcmp(curArg, "-t") == 0 && i+1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if(strcmp(curArg, "-n") == 0 && i+1 < argc)
+            iterations = atoi(argv[++i]);
+        else
+            return dumpUsage();
+    }
+    if(threadCount <= 0 || iterations <= 0)
+        return dumpUsage();
+
+    QElapsedTimer timer;
+    GdbReader reader;
+    QByteArray text = createThreadInfo(threadCount);
+
+    // Parse (and tear down) the reply
+    timer.start();
+    for(int i = 0;i < iterations;i++)
+        delete parseReply(reader, text);
+    qint64 parseNs = timer.nsecsElapsed();
+
+    Resp *resp = parseReply(reader, text);
+    if(resp == NULL || resp->m_result != GDB_DONE)
+    {
+        printf("Failed to parse the reply\n");
+        return 1;
+    }
+    Tree &tree = resp->tree;
+
+    int sum1 = 0;
+    timer.start();
+    for(int i = 0;i < iterations;i++)
+        sum1 += scanWithStrings(tree);
+    qint64 stringNs = timer.nsecsElapsed();
+
+    int sum2 = 0;
+    timer.start();
+    for(int i = 0;i < iterations;i++)
+        sum2 += scanWithPaths(tree);
+    qint64 pathNs = timer.nsecsElapsed();
+
+    if(sum1 != sum2)
+    {
+        printf("Mismatch between string and path lookups (%d != %d)\n", sum1, sum2);
+        delete resp;
+        return 1;
+    }
+    delete resp;
+
+    printf("-thread-info reply with %d threads, %d bytes (%d iterations)\n", threadCount, text.size(), iterations);
+    printf("  parse + teardown     : %8.1f us/stop\n", parseNs / 1000.0 / iterations);
+    printf("  lookup (string path) : %8.1f us/stop\n", stringNs / 1000.0 / iterations);
+    printf("  lookup (TreePath)    : %8.1f us/stop\n", pathNs / 1000.0 / iterations);
+
+    return 0;
+}
+
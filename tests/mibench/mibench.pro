@@ -0,0 +1,29 @@
+lessThan(QT_MAJOR_VERSION, 5) {
+    QT += gui core
+}
+else {
+    QT += gui core widgets
+}
+
+TEMPLATE = app
+CONFIG += c++14
+
+SOURCES+=mibench.cpp
+
+SOURCES+=../../src/com.cpp
+HEADERS+=../../src/com.h ../../src/spscring.h
+SOURCES+=../../src/tree.cpp
+HEADERS+=../../src/tree.h
+
+SOURCES+=../../src/log.cpp
+HEADERS+=../../src/log.h
+SOURCES+=../../src/util.cpp
+HEADERS+=../../src/util.h
+
+
+
+QMAKE_CXXFLAGS += -I../../src  -g -O2
+
+
+TARGET=mibench
+
@@ -0,0 +1,228 @@
+#include "com.h"
+#include "core.h"
+#include "config.h"
+#include "tree.h"
+#include "log.h"
+#include "util.h"
+#include "alloccount.h"
+
+#include <QtGlobal>
+#if QT_VERSION < 0x050000
+#include <QtGui/QApplication>
+#endif
+#include <QApplication>
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * @brief Receives the events from Core (and ignores them).
+ */
+class NullCoreListener : public ICore
+{
+public:
+    NullCoreListener() : m_eventCount(0) {};
+
+    void ICore_onStopped(StopReason, QString, int) { m_eventCount++; };
+    void ICore_onStateChanged(TargetState) { m_eventCount++; };
+    void ICore_onSignalReceived(QString) { m_eventCount++; };
+    void ICore_onLocalVarChanged(QStringList) { m_eventCount++; };
+    void ICore_onFrameVarReset() { m_eventCount++; };
+    void ICore_onFrameVarChanged(QString, QString) { m_eventCount++; };
+    void ICore_onWatchVarChanged(VarWatch&) { m_eventCount++; };
+    void ICore_onWatchVarDeleted(VarWatch&) { m_eventCount++; };
+    void ICore_onConsoleStream(QString) { m_eventCount++; };
+    void ICore_onBreakpointsChanged() { m_eventCount++; };
+    void ICore_onThreadListChanged() { m_eventCount++; };
+    void ICore_onCurrentThreadChanged(int) { m_eventCount++; };
+    void ICore_onStackFrameChange(QList<StackFrameEntry>) { m_eventCount++; };
+    void ICore_onMessage(QString) { m_eventCount++; };
+    void ICore_onTargetOutput(QString) { m_eventCount++; };
+    void ICore_onCurrentFrameChanged(int) { m_eventCount++; };
+    void ICore_onSourceFileListChanged() { m_eventCount++; };
+    void ICore_onSourceFileChanged(QString) { m_eventCount++; };
+    void ICore_onWatchVarChildAdded(VarWatch&) { m_eventCount++; };
+
+    long m_eventCount;
+};
+
+
+int dumpUsage()
+{
+    printf("Usage: ./mireplay [-n ITERATIONS] [-s STOPS] [-t THREADS] [CAPTURE_FILE]\n");
+    printf("Description:\n");
+    printf("  Replays the output of a GDB session through the MI tokenizer, parser and\n");
+    printf("  the Core dispatch and reports the throughput.\n");
+    printf("  CAPTURE_FILE is a %s file written by gede when the GDB log is enabled.\n", GDB_CAPTURE_FILE);
+    printf("  If no file is given a session with STOPS steps in a program with THREADS threads is generated.\n");
+    return 1;
+}
+
+/**
+ * @brief Generates the output of GDB when stepping in a program with a number of threads.
+ */
+void generateSession(QVector<QByteArray> *chunkList, int stopCount, int threadCount)
+{
+    int token = 1;
+    for(int s = 0;s < stopCount;s++)
+    {
+        QByteArray out;
+        int lineNo = 10 + s % 100;
+
+        out += "*running,thread-id=\"all\"\n(gdb)\n";
+        out += "~\"Stepping over a line\\n\"\n";
+        out += "*stopped,reason=\"end-stepping-range\",frame={addr=\"0x00005555555551a9\",func=\"main\",args=[],"
+               "file=\"main.c\",fullname=\"/home/user/src/main.c\",line=\"" + QByteArray::number(lineNo) + "\"},"
+               "thread-id=\"1\",stopped-threads=\"all\",core=\"3\"\n(gdb)\n";
+
+        // -thread-info
+        out += QByteArray::number(token++) + "^done,threads=[";
+        for(int t = 0;t < threadCount;t++)
+        {
+            if(t != 0)
+                out += ",";
+            out += "{id=\"" + QByteArray::number(t+1) + "\",target-id=\"Thread 0x7ffff7d8" + QByteArray::number(t, 16) + " (LWP " + QByteArray::number(1000+t) + ")\","
+                   "name=\"worker" + QByteArray::number(t) + "\",frame={level=\"0\",addr=\"0x00005555555551a9\",func=\"worker_func\","
+                   "args=[{name=\"arg\",value=\"0x0\"}],file=\"worker.c\",fullname=\"/home/user/src/worker.c\",line=\"" + QByteArray::number(lineNo) + "\"},"
+                   "state=\"stopped\",core=\"" + QByteArray::number(t % 8) + "\"}";
+        }
+        out += "],current-thread-id=\"1\"\n(gdb)\n";
+
+        // -var-update and -stack-list-variables
+        out += QByteArray::number(token++) + "^done,changelist=[]\n(gdb)\n";
+        out += QByteArray::number(token++) + "^done,variables=[{name=\"i\"},{name=\"buf\"},{name=\"ptr\"},{name=\"count\"}]\n(gdb)\n";
+
+        // Split it like it would have been read from a pipe
+        for(int i = 0;i < out.size();i += 4096)
+            chunkList->append(out.mid(i, 4096));
+    }
+}
+
+struct ReplayResult
+{
+    long m_recordCount;
+    qint64 m_byteCount;
+    qint64 m_ns;
+    long m_allocCount;
+};
+
+/**
+ * @brief Replays all chunks through a reader and dispatches the responses to a listener.
+ */
+ReplayResult replay(const QVector<QByteArray> &chunkList, GdbComListener *listener)
+{
+    ReplayResult res;
+    res.m_recordCount = 0;
+    res.m_byteCount = 0;
+
+    QElapsedTimer timer;
+    long allocStart = g_allocCount;
+    timer.start();
+
+    GdbReader reader;
+    for(int c = 0;c < chunkList.size();c++)
+    {
+        const QByteArray &chunk = chunkList[c];
+
+        // Feed in slices small enough to never fill the response ring
+        for(int i = 0;i < chunk.size();i += GDB_RESP_RING_SIZE)
+        {
+            reader.feedOutput(chunk.mid(i, GDB_RESP_RING_SIZE));
+
+            Resp *resp = NULL;
+            while(reader.popResp(&resp, 0))
+            {
+                GdbCom::dispatchResp(listener, resp);
+                delete resp;
+                res.m_recordCount++;
+            }
+        }
+        res.m_byteCount += chunk.size();
+    }
+
+    res.m_ns = timer.nsecsElapsed();
+    res.m_allocCount = g_allocCount - allocStart;
+    return res;
+}
+
+void printResult(const char *title, ReplayResult res)
+{
+    double secs = res.m_ns / 1.0e9;
+    printf("  %-20s: %10.0f records/s %8.2f MB/s", title, res.m_recordCount / secs, res.m_byteCount / secs / (1024*1024));
+#ifdef __GLIBC__
+    printf(" %8.1f allocs/record", res.m_recordCount ? ((double)res.m_allocCount) / res.m_recordCount : 0.0);
+#endif
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc,argv);
+    QString captureFilename;
+    int iterations = 10;
+    int stopCount = 100;
+    int threadCount = 100;
+
+    // Parse arguments
+    for(int i = 1;i < argc;i++)
+    {
+        const char *curArg = argv[i];
+        if(strcmp(curArg, "-n") == 0 && i+1 < argc)
+            iterations = atoi(argv[++i]);
+        else if(strcmp(curArg, "-s") == 0 && i+1 < argc)
+            stopCount = atoi(argv[++i]);
+        else if(strcmp(curArg, "-t") == 0 && i+1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if(curArg[0] == '-')
+            return dumpUsage();
+        else
+            captureFilename = curArg;
+    }
+    if(iterations <= 0 || stopCount <= 0 || threadCount <= 0)
+        return dumpUsage();
+
+    QVector<QByteArray> chunkList;
+    if(captureFilename.isEmpty())
+    {
+        generateSession(&chunkList, stopCount, threadCount);
+        printf("Generated session with %d stops and %d threads\n", stopCount, threadCount);
+    }
+    else
+    {
+        if(GdbReader::loadCapture(captureFilename, &chunkList))
+            return 1;
+        printf("Replaying %s\n", qPrintable(captureFilename));
+    }
+
+    NullCoreListener coreListener;
+    Core &core = Core::getInstance();
+    core.setListener(&coreListener);
+
+    ReplayResult parseTotal = {0, 0, 0, 0};
+    ReplayResult dispatchTotal = {0, 0, 0, 0};
+    for(int i = 0;i < iterations;i++)
+    {
+        ReplayResult res = replay(chunkList, NULL);
+        parseTotal.m_recordCount += res.m_recordCount;
+        parseTotal.m_byteCount += res.m_byteCount;
+        parseTotal.m_ns += res.m_ns;
+        parseTotal.m_allocCount += res.m_allocCount;
+
+        res = replay(chunkList, &core);
+        dispatchTotal.m_recordCount += res.m_recordCount;
+        dispatchTotal.m_byteCount += res.m_byteCount;
+        dispatchTotal.m_ns += res.m_ns;
+        dispatchTotal.m_allocCount += res.m_allocCount;
+    }
+
+    printf("%ld records, %lld bytes (%d iterations)\n", parseTotal.m_recordCount / iterations, (long long)parseTotal.m_byteCount / iterations, iterations);
+    printResult("tokenize + parse", parseTotal);
+    printResult("parse + Core dispatch", dispatchTotal);
+
+    core.setListener(NULL);
+
+    return 0;
+}
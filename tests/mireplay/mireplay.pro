@@ -0,0 +1,35 @@
+lessThan(QT_MAJOR_VERSION, 5) {
+    QT += gui core
+}
+else {
+    QT += gui core widgets
+}
+
+TEMPLATE = app
+CONFIG += c++14
+
+SOURCES+=mireplay.cpp
+
+SOURCES+=../../src/com.cpp
+HEADERS+=../../src/com.h ../../src/spscring.h
+SOURCES+=../../src/core.cpp
+HEADERS+=../../src/core.h
+SOURCES+=../../src/gdbmiparser.cpp
+HEADERS+=../../src/gdbmiparser.h
+SOURCES+=../../src/tree.cpp
+HEADERS+=../../src/tree.h
+
+SOURCES+=../../src/log.cpp
+HEADERS+=../../src/log.h
+SOURCES+=../../src/util.cpp
+HEADERS+=../../src/util.h
+SOURCES+=../common/alloccount.cpp
+HEADERS+=../common/alloccount.h
+
+SOURCES += ../../src/ini.cpp ../../src/settings.cpp
+HEADERS += ../../src/ini.h ../../src/settings.h
+
+QMAKE_CXXFLAGS += -I../../src -I../common  -g -O2
+
+
+TARGET=mireplay
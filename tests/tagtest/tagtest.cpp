@@ -1,5 +1,6 @@
 
 #include "tagscanner.h"
+#include "cxxtagscanner.h"
 #include "log.h"
 
 #include <QtGlobal>
@@ -8,6 +9,84 @@
 #endif
 #include <QApplication>
 
+#include <stdio.h>
+#include <stdlib.h>
+
+// C/C++ source scanned by testCxxTagScanner() (the line numbers are checked)
+static const char g_cxxSample[] = R"SAMPLE(#include <stdio.h>
+
+int g_counter = 0;
+static const char *g_rawText = R"x(
+int notAVariable = 1;
+void notAFunction() { }
+)x";
+
+extern "C"
+{
+int cFunction(int a, char *b);
+int cFunctionDef(int a)
+{
+    return a;
+}
+}
+
+namespace outer
+{
+namespace inner
+{
+
+class Shape
+{
+public:
+    Shape();
+    virtual ~Shape();
+    int area() const { return 0; }
+    bool operator==(const Shape &other) const;
+
+    struct Point
+    {
+        int x;
+    };
+};
+
+} // namespace inner
+} // namespace outer
+
+outer::inner::Shape::Shape()
+    : m_width(1)
+{
+}
+
+outer::inner::Shape::~Shape()
+{
+}
+
+bool outer::inner::Shape::operator==(const Shape &other) const
+{
+    return true;
+}
+
+template <typename T>
+class Box
+{
+public:
+    T get() { return m_value; }
+    T m_value;
+};
+
+template <typename T>
+T Box<T>::get2()
+{
+    return T();
+}
+
+template <typename T>
+T maxOf(T a, T b)
+{
+    return a > b ? a : b;
+}
+)SAMPLE";
+
 int dummy;
 
     
@@ -17,6 +96,83 @@ void dummyfunc()
 
 }
 
+void test_verify_(int lineNo, int t, const char *testStr)
+{
+    if(!t)
+    {
+        fprintf(stderr, "Test failed L%d: '%s'\n", lineNo, testStr);
+        exit(1);
+    }
+}
+#define test_verify(t)  test_verify_(__LINE__, t, #t)
+
+/**
+ * @brief Returns the tag with a specific name and class (or NULL if there is none).
+ */
+const Tag *findTag(const QList<Tag> &taglist, QString name, QString className)
+{
+    for(int i = 0;i < taglist.size();i++)
+    {
+        const Tag &tag = taglist[i];
+        if(tag.getName() == name && tag.getClassName() == className)
+            return &tag;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Checks the tags found by CxxTagScanner in g_cxxSample.
+ */
+void testCxxTagScanner()
+{
+    CxxTagScanner scanner;
+    QList<Tag> taglist;
+    test_verify(scanner.scanBuffer("sample.cpp", QByteArray(g_cxxSample), &taglist) == 0);
+
+    // Global variables
+    const Tag *tag = findTag(taglist, "g_counter", "");
+    test_verify(tag && tag->m_type == Tag::TAG_VARIABLE && tag->getLineNo() == 3);
+    tag = findTag(taglist, "g_rawText", "");
+    test_verify(tag && tag->m_type == Tag::TAG_VARIABLE && tag->getLineNo() == 4);
+
+    // Nothing inside the raw string
+    test_verify(findTag(taglist, "notAVariable", "") == NULL);
+    test_verify(findTag(taglist, "notAFunction", "") == NULL);
+
+    // extern "C" (the declaration is not a tag)
+    tag = findTag(taglist, "cFunctionDef", "");
+    test_verify(tag && tag->isFunc() && tag->getLineNo() == 12 && tag->getSignature() == "(int a)");
+    test_verify(findTag(taglist, "cFunction", "") == NULL);
+
+    // Classes in namespaces
+    tag = findTag(taglist, "Shape", "");
+    test_verify(tag && tag->isClass() && tag->getLineNo() == 23);
+    tag = findTag(taglist, "area", "Shape");
+    test_verify(tag && tag->isFunc() && tag->getLineNo() == 28);
+    tag = findTag(taglist, "Point", "Shape");
+    test_verify(tag && tag->isClass() && tag->getLineNo() == 31);
+
+    // Out-of-line members and operators
+    tag = findTag(taglist, "Shape", "Shape");
+    test_verify(tag && tag->isFunc() && tag->getLineNo() == 40);
+    tag = findTag(taglist, "~Shape", "Shape");
+    test_verify(tag && tag->isFunc() && tag->getLineNo() == 45);
+    tag = findTag(taglist, "operator==", "Shape");
+    test_verify(tag && tag->isFunc() && tag->getLineNo() == 49 && tag->getSignature() == "(const Shape& other)");
+
+    // Templates
+    tag = findTag(taglist, "Box", "");
+    test_verify(tag && tag->isClass() && tag->getLineNo() == 55);
+    tag = findTag(taglist, "get", "Box");
+    test_verify(tag && tag->isFunc() && tag->getLineNo() == 58);
+    tag = findTag(taglist, "get2", "Box");
+    test_verify(tag && tag->isFunc() && tag->getLineNo() == 63);
+    tag = findTag(taglist, "maxOf", "");
+    test_verify(tag && tag->isFunc() && tag->getLineNo() == 69 && tag->getSignature() == "(T a, T b)");
+
+    test_verify(taglist.size() == 13);
+}
+
 int main(int argc, char *argv[])
 {
     Settings cfg;
@@ -32,6 +188,9 @@ int main(int argc, char *argv[])
     }
     scanner.init(&cfg);
 
+    testCxxTagScanner();
+    printf("C/C++ tag scanner tests passed\n");
+
     
 
     QList<Tag> taglist;
@@ -6,6 +6,7 @@ else {
 }
 
 TEMPLATE = app
+CONFIG += c++14
 
 SOURCES+=tagtest.cpp
 
@@ -24,6 +25,12 @@ HEADERS += ../../src/rusttagscanner.h
 SOURCES += ../../src/adatagscanner.cpp
 HEADERS += ../../src/adatagscanner.h
 
+SOURCES += ../../src/cxxtagscanner.cpp
+HEADERS += ../../src/cxxtagscanner.h
+
+SOURCES += ../../src/keywordset.cpp
+HEADERS += ../../src/keywordset.h
+
 
 SOURCES += ../../src/ini.cpp ../../src/settings.cpp
 HEADERS += ../../src/ini.h ../../src/settings.h